@@ -0,0 +1,83 @@
+//
+// Allocation-free parser for the short text commands of the WebSocket clients
+//
+
+#include "CommandParser.h"
+
+bool command_t::argStartsWith(const char *value) const {
+    size_t length = strlen(value);
+    if (length > argLength) return false;
+    for (size_t i = 0; i < length; i++) {
+        if (toupper((unsigned char) arg[i]) != toupper((unsigned char) value[i])) return false;
+    }
+    return true;
+}
+
+bool CommandParser::parse(const char *data, size_t length, command_t &command) const {
+    command = command_t();
+    if (data == nullptr) return false;
+    for (uint8_t i = 0; i < _count; i++) {
+        size_t prefixLength = strlen(_table[i].prefix);
+        if (prefixLength > length || memcmp(data, _table[i].prefix, prefixLength) != 0) continue;
+        command.id = _table[i].id;
+        command.arg = data + prefixLength;
+        command.argLength = length - prefixLength;
+        return true;
+    }
+    return false;
+}
+
+CommandAssembler::command_slot_t *CommandAssembler::_slot(uint32_t owner, bool create) {
+    command_slot_t *free = nullptr;
+    for (auto &slot: _slots) {
+        if (slot.used && slot.owner == owner) return &slot;
+        if (!slot.used && free == nullptr) free = &slot;
+    }
+    if (!create || free == nullptr) return nullptr;
+    free->used = true;
+    free->owner = owner;
+    free->overflow = false;
+    free->length = 0;
+    return free;
+}
+
+bool CommandAssembler::feed(uint32_t owner, bool first, bool last, const char *data, size_t length,
+                            const char *&message, size_t &messageLength) {
+    if (first && last) {
+        // Whole message in one piece: no copy
+        release(owner);
+        message = data;
+        messageLength = length;
+        return true;
+    }
+
+    command_slot_t *slot = _slot(owner, first);
+    if (slot == nullptr) {
+        // No slot left, or the start of the message was missed
+        return false;
+    }
+    if (first) {
+        slot->length = 0;
+        slot->overflow = false;
+    }
+    if (slot->overflow || slot->length + length > COMMAND_MAX_LENGTH) {
+        slot->overflow = true;
+    } else {
+        memcpy(slot->data + slot->length, data, length);
+        slot->length += length;
+    }
+    if (!last) return false;
+
+    bool valid = !slot->overflow;
+    message = slot->data;
+    messageLength = slot->length;
+    slot->used = false; // the data stays readable until the next feed()
+    return valid;
+}
+
+void CommandAssembler::release(uint32_t owner) {
+    command_slot_t *slot = _slot(owner, false);
+    if (slot != nullptr) {
+        slot->used = false;
+    }
+}
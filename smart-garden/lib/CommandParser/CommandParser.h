@@ -0,0 +1,112 @@
+//
+// Allocation-free parser for the short text commands of the WebSocket clients
+//
+
+#ifndef SMART_GARDEN_COMMANDPARSER_H
+#define SMART_GARDEN_COMMANDPARSER_H
+
+#include <Arduino.h>
+
+// Longest command kept when a message arrives in several frames / packets
+#ifndef COMMAND_MAX_LENGTH
+#define COMMAND_MAX_LENGTH 32
+#endif
+
+// Clients assembling a fragmented command at the same time
+#ifndef COMMAND_ASSEMBLER_SLOTS
+#define COMMAND_ASSEMBLER_SLOTS 4
+#endif
+
+#define COMMAND_UNKNOWN 0xFF
+
+/**
+ * @brief Command table row: messages starting with `prefix` resolve to `id`
+ */
+struct command_def_t {
+    const char *prefix;
+    uint8_t id;
+};
+
+/**
+ * @brief Parsed command. `arg` points into the message, it is not '\0' terminated
+ */
+struct command_t {
+    uint8_t id = COMMAND_UNKNOWN;
+    const char *arg = nullptr;
+    size_t argLength = 0;
+
+    /**
+     * @brief Check the argument prefix, ignoring case: "on" and "ON\n" both match "ON"
+     * @param value
+     * @return
+     */
+    bool argStartsWith(const char *value) const;
+};
+
+/**
+ * @brief Resolve a message to a command id through a prefix table, without copying it.
+ *
+ * The first matching row wins, so put a longer prefix before a shorter one it starts with.
+ */
+class CommandParser {
+public:
+    CommandParser(const command_def_t *table, uint8_t count) : _table(table), _count(count) {}
+
+    /**
+     * @brief Parse a message
+     * @param data message, not '\0' terminated
+     * @param length
+     * @param command id and argument (the rest after the prefix)
+     * @return false if no prefix matches
+     */
+    bool parse(const char *data, size_t length, command_t &command) const;
+
+private:
+    const command_def_t *_table;
+    uint8_t _count;
+};
+
+/**
+ * @brief Joins a message split across WebSocket frames or TCP packets.
+ *
+ * A message arriving whole (the usual case) is returned as is. Pieces are copied into a fixed slot per
+ * client; a message longer than COMMAND_MAX_LENGTH is dropped.
+ */
+class CommandAssembler {
+public:
+    /**
+     * @brief Add a piece of a message
+     * @param owner client id
+     * @param first true if the piece starts the message (first frame, offset 0)
+     * @param last true if the piece ends the message (final frame, up to its length)
+     * @param data piece
+     * @param length piece length
+     * @param message set to the complete message
+     * @param messageLength
+     * @return true when `message` holds a complete message
+     */
+    bool feed(uint32_t owner, bool first, bool last, const char *data, size_t length,
+              const char *&message, size_t &messageLength);
+
+    /**
+     * @brief Drop the partial message of a client, e.g. on disconnect
+     * @param owner client id
+     */
+    void release(uint32_t owner);
+
+private:
+    struct command_slot_t {
+        uint32_t owner;
+        bool used;
+        bool overflow;
+        size_t length;
+        char data[COMMAND_MAX_LENGTH];
+    };
+
+    command_slot_t _slots[COMMAND_ASSEMBLER_SLOTS]{};
+
+    command_slot_t *_slot(uint32_t owner, bool create);
+};
+
+
+#endif //SMART_GARDEN_COMMANDPARSER_H
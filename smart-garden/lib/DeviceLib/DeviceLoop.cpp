@@ -0,0 +1,107 @@
+//
+// Deadline driven main loop for the DeviceLib devices
+//
+
+#include "DeviceLoop.h"
+#include "GenericInput.h"
+#include "GenericOutput.h"
+
+#if defined(ESP32) && !defined(NATIVE_HOST)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static SemaphoreHandle_t wakeSemaphore = nullptr;
+#else
+static volatile bool wakePending = false;
+#endif
+
+
+DeviceLoop::DeviceLoop() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    if (wakeSemaphore == nullptr) {
+        wakeSemaphore = xSemaphoreCreateBinary();
+    }
+#endif
+}
+
+void DeviceLoop::add(stdGenericOutput::GenericOutput &output) {
+    add([&output]() { output.loop(); }, [&output]() { return output.getNextDeadline(); });
+}
+
+void DeviceLoop::add(GenericInput &input) {
+    add([&input]() { input.loop(); }, [&input]() { return input.getNextDeadline(); });
+}
+
+void DeviceLoop::add(std::function<void()> loop, std::function<uint32_t()> next) {
+    _entries.push_back({std::move(loop), std::move(next), 0, (uint32_t) millis()});
+}
+
+void DeviceLoop::every(uint32_t period, std::function<void()> loop) {
+    _entries.push_back({std::move(loop), nullptr, period, (uint32_t) millis()});
+}
+
+uint32_t DeviceLoop::_remaining(const device_loop_entry_t &entry, uint32_t now) {
+    if (entry.next) {
+        return entry.next();
+    }
+    uint32_t elapsed = now - entry.lastRun;
+    return elapsed >= entry.period ? 0 : entry.period - elapsed;
+}
+
+uint32_t DeviceLoop::runOnce() {
+#if !defined(ESP32) || defined(NATIVE_HOST)
+    // Cleared before running so a notify() from a callback is not lost
+    wakePending = false;
+#endif
+    for (auto &entry: _entries) {
+        uint32_t now = millis();
+        if (_remaining(entry, now) == 0) {
+            entry.lastRun = now;
+            entry.loop();
+        }
+    }
+
+    uint32_t now = millis();
+    uint32_t next = maxSleep;
+    for (auto &entry: _entries) {
+        uint32_t remaining = _remaining(entry, now);
+        if (remaining < next) {
+            next = remaining;
+        }
+    }
+    return next;
+}
+
+void DeviceLoop::wait(uint32_t ms) {
+    if (ms == 0) return;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    xSemaphoreTake(wakeSemaphore, pdMS_TO_TICKS(ms) ? pdMS_TO_TICKS(ms) : 1);
+#else
+    if (wakePending) return;
+    delay(ms);
+#endif
+}
+
+void DeviceLoop::notify() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    if (wakeSemaphore != nullptr) {
+        xSemaphoreGive(wakeSemaphore);
+    }
+#else
+    wakePending = true;
+#endif
+}
+
+void IRAM_ATTR DeviceLoop::notifyFromISR() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    if (wakeSemaphore != nullptr) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(wakeSemaphore, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+#else
+    wakePending = true;
+#endif
+}
@@ -0,0 +1,109 @@
+//
+// Deadline driven main loop for the DeviceLib devices
+//
+
+#ifndef SMART_GARDEN_DEVICELOOP_H
+#define SMART_GARDEN_DEVICELOOP_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+// Returned by getNextDeadline() when a device has nothing pending
+#define DEVICE_LOOP_IDLE 0xFFFFFFFFUL
+
+// Longest time the loop blocks without any registered deadline
+#ifndef DEVICE_LOOP_MAX_SLEEP_MS
+#define DEVICE_LOOP_MAX_SLEEP_MS 60000UL
+#endif
+
+namespace stdGenericOutput {
+    class GenericOutput;
+}
+
+class GenericInput;
+
+struct device_loop_entry_t {
+    std::function<void()> loop;
+    std::function<uint32_t()> next; // ms until due, nullptr for a fixed period
+    uint32_t period;
+    uint32_t lastRun;
+};
+
+/**
+ * @brief Runs each registered device only when its next deadline is due and blocks in between.
+ *
+ * Outputs report their auto-off / power-on-delay deadline, inputs in interrupt mode wake the loop
+ * from their ISR. State changes made from other tasks (web server, database stream) call notify()
+ * so the new deadline is picked up right away. While blocked the loop task yields the CPU, so the
+ * idle task can enter light-sleep when power management is enabled.
+ */
+class DeviceLoop {
+public:
+    DeviceLoop();
+
+    /**
+     * @brief Run the output loop at its auto-off / power-on-delay deadline
+     * @param output
+     */
+    void add(stdGenericOutput::GenericOutput &output);
+
+    /**
+     * @brief Run the input loop on edges (interrupt mode) and at its debounce / hold deadlines
+     * @param input
+     */
+    void add(GenericInput &input);
+
+    /**
+     * @brief Register a custom loop with its own deadline
+     * @param loop function to run when due
+     * @param next returns milliseconds until the next run, DEVICE_LOOP_IDLE if nothing is pending
+     */
+    void add(std::function<void()> loop, std::function<uint32_t()> next);
+
+    /**
+     * @brief Register a loop that runs at a fixed period
+     * @param period milliseconds
+     * @param loop
+     */
+    void every(uint32_t period, std::function<void()> loop);
+
+    /**
+     * @brief Run all due loops
+     * @return milliseconds until the earliest deadline, capped at maxSleep
+     */
+    uint32_t runOnce();
+
+    /**
+     * @brief Block until the timeout passes or notify() is called
+     * @param ms milliseconds
+     */
+    void wait(uint32_t ms);
+
+    /**
+     * @brief runOnce() then wait() until the next deadline. Call from loop()
+     */
+    void run() {
+        wait(runOnce());
+    }
+
+    /**
+     * @brief Wake the loop to re-evaluate the deadlines. Safe to call from any task
+     */
+    static void notify();
+
+    /**
+     * @brief Wake the loop from an interrupt handler
+     */
+    static void IRAM_ATTR notifyFromISR();
+
+    uint32_t maxSleep = DEVICE_LOOP_MAX_SLEEP_MS;
+
+private:
+    std::vector<device_loop_entry_t> _entries;
+
+    static uint32_t _remaining(const device_loop_entry_t &entry, uint32_t now);
+};
+
+
+#endif //SMART_GARDEN_DEVICELOOP_H
@@ -0,0 +1,64 @@
+//
+// One-shot and periodic callbacks that report their next deadline to DeviceLoop
+//
+
+#include "DeviceTimer.h"
+
+int DeviceTimer::_add(uint32_t ms, device_timer_cb_t callback, bool repeat) {
+    if (callback == nullptr) return -1;
+    for (uint8_t i = 0; i < DEVICE_TIMER_MAX_TIMERS; i++) {
+        if (_timers[i].callback == nullptr) {
+            _timers[i] = {callback, (uint32_t) millis(), ms, repeat};
+            // The loop may be sleeping past the new deadline
+            DeviceLoop::notify();
+            return i;
+        }
+    }
+    Serial.println("DeviceTimer: no free slot");
+    return -1;
+}
+
+void DeviceTimer::deleteTimer(int id) {
+    if (id < 0 || id >= DEVICE_TIMER_MAX_TIMERS) return;
+    _timers[id].callback = nullptr;
+}
+
+uint8_t DeviceTimer::getNumTimers() const {
+    uint8_t count = 0;
+    for (auto &timer: _timers) {
+        if (timer.callback != nullptr) count++;
+    }
+    return count;
+}
+
+void DeviceTimer::run() {
+    for (uint8_t i = 0; i < DEVICE_TIMER_MAX_TIMERS; i++) {
+        device_timer_entry_t &timer = _timers[i];
+        if (timer.callback == nullptr) continue;
+        uint32_t now = millis();
+        if (now - timer.start < timer.period) continue;
+
+        device_timer_cb_t callback = timer.callback;
+        if (timer.repeat) {
+            // Keep the cadence, but don't replay periods missed while the loop was busy
+            timer.start += timer.period;
+            if (now - timer.start >= timer.period) timer.start = now;
+        } else {
+            // Freed first: the callback may set a new timeout in this slot
+            timer.callback = nullptr;
+        }
+        callback();
+    }
+}
+
+uint32_t DeviceTimer::getNextDeadline() const {
+    uint32_t now = millis();
+    uint32_t next = DEVICE_LOOP_IDLE;
+    for (auto &timer: _timers) {
+        if (timer.callback == nullptr) continue;
+        uint32_t elapsed = now - timer.start;
+        uint32_t remaining = elapsed >= timer.period ? 0 : timer.period - elapsed;
+        if (remaining < next) next = remaining;
+    }
+    return next;
+}
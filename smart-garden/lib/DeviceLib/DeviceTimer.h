@@ -0,0 +1,83 @@
+//
+// One-shot and periodic callbacks that report their next deadline to DeviceLoop
+//
+
+#ifndef SMART_GARDEN_DEVICETIMER_H
+#define SMART_GARDEN_DEVICETIMER_H
+
+#include <Arduino.h>
+#include "DeviceLoop.h"
+
+// Timers that can be pending at the same time
+#ifndef DEVICE_TIMER_MAX_TIMERS
+#define DEVICE_TIMER_MAX_TIMERS 10
+#endif
+
+typedef void (*device_timer_cb_t)();
+
+struct device_timer_entry_t {
+    device_timer_cb_t callback; // nullptr for a free slot
+    uint32_t start;             // millis() when the current period started
+    uint32_t period;
+    bool repeat;
+};
+
+/**
+ * @brief setTimeout / setInterval in fixed slots, with the SimpleTimer calling convention
+ * (ids, -1 when full, deleteTimer). Unlike a fixed-tick timer it reports the time until the earliest
+ * callback, so DeviceLoop sleeps until then instead of waking on every tick.
+ *
+ * Only call it from the task running DeviceLoop.
+ */
+class DeviceTimer {
+public:
+    /**
+     * @brief Run a callback once
+     * @param ms delay in milliseconds
+     * @param callback
+     * @return timer id, -1 if all slots are used
+     */
+    int setTimeout(uint32_t ms, device_timer_cb_t callback) {
+        return _add(ms, callback, false);
+    }
+
+    /**
+     * @brief Run a callback every `ms`
+     * @param ms period in milliseconds
+     * @param callback
+     * @return timer id, -1 if all slots are used
+     */
+    int setInterval(uint32_t ms, device_timer_cb_t callback) {
+        return _add(ms, callback, true);
+    }
+
+    /**
+     * @brief Cancel a timer, ignored for an unknown id
+     * @param id
+     */
+    void deleteTimer(int id);
+
+    /**
+     * @brief Number of pending timers
+     */
+    uint8_t getNumTimers() const;
+
+    /**
+     * @brief Run the due callbacks
+     */
+    void run();
+
+    /**
+     * @brief Time until the earliest callback
+     * @return milliseconds, 0 if due now, DEVICE_LOOP_IDLE if no timer is pending
+     */
+    uint32_t getNextDeadline() const;
+
+private:
+    device_timer_entry_t _timers[DEVICE_TIMER_MAX_TIMERS]{};
+
+    int _add(uint32_t ms, device_timer_cb_t callback, bool repeat);
+};
+
+
+#endif //SMART_GARDEN_DEVICETIMER_H
@@ -0,0 +1,122 @@
+//
+// Hall effect flow sensor (YF-S201 style) pulse counter
+//
+
+#include "FlowMeter.h"
+
+
+FlowMeter::FlowMeter(uint8_t pin, float kFactor, uint8_t mode) {
+    _pin = pin;
+    _mode = mode;
+    _kFactor = kFactor > 0 ? kFactor : FLOW_METER_DEFAULT_K_FACTOR;
+}
+
+FlowMeter::~FlowMeter() {
+    if (_attached) {
+        detachInterrupt(digitalPinToInterrupt(_pin));
+    }
+    _onTargetReached = nullptr;
+}
+
+void IRAM_ATTR FlowMeter::_onPulse(void *arg) {
+    auto *self = static_cast<FlowMeter *>(arg);
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portENTER_CRITICAL_ISR(&self->_mux);
+#endif
+    uint32_t pulses = self->_pulses + 1;
+    self->_pulses = pulses;
+    bool reached = self->_targetActive && pulses == self->_targetPulse;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portEXIT_CRITICAL_ISR(&self->_mux);
+#endif
+    // Only the pulse that reaches the target wakes the loop
+    if (reached) {
+        DeviceLoop::notifyFromISR();
+    }
+}
+
+void FlowMeter::begin() {
+    if (_attached) return;
+    pinMode(_pin, _mode);
+    _rateMillis = millis();
+    _ratePulses = _pulses;
+    attachInterruptArg(digitalPinToInterrupt(_pin), _onPulse, this, FALLING);
+    _attached = true;
+}
+
+bool FlowMeter::calibrate(float measuredLiters) {
+    uint32_t pulses = _pulses - _startPulses;
+    if (measuredLiters <= 0 || pulses < 100) return false;
+    _kFactor = (float) pulses / measuredLiters;
+    Serial.printf("FlowMeter: K-factor = %.1f pulses/L\n", _kFactor);
+    return true;
+}
+
+void FlowMeter::reset() {
+    _startPulses = _pulses;
+}
+
+void FlowMeter::startTarget(float liters, std::function<void()> onReached) {
+    uint32_t count = (uint32_t) (liters * _kFactor + 0.5f);
+    if (count == 0) count = 1;
+    _onTargetReached = std::move(onReached);
+    // Target before the flag, with no pulse in between: never compared against a stale target
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portENTER_CRITICAL(&_mux);
+#endif
+    _targetPulse = _pulses + count;
+    _targetActive = true;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portEXIT_CRITICAL(&_mux);
+#endif
+    DeviceLoop::notify();
+}
+
+void FlowMeter::cancelTarget() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portENTER_CRITICAL(&_mux);
+#endif
+    _targetActive = false;
+    _targetPulse = _pulses - 1;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portEXIT_CRITICAL(&_mux);
+#endif
+    _onTargetReached = nullptr;
+}
+
+float FlowMeter::getRemainingLiters() const {
+    if (!_targetActive) return 0;
+    int32_t left = (int32_t) (_targetPulse - _pulses);
+    return left > 0 ? (float) left / _kFactor : 0;
+}
+
+uint32_t FlowMeter::getNextDeadline() const {
+    if (_targetActive && (int32_t) (_pulses - _targetPulse) >= 0) return 0;
+    // Keep sampling the rate while water flows or a target is running
+    if (_targetActive || _flowRate > 0 || _pulses != _ratePulses) {
+        uint32_t elapsed = millis() - _rateMillis;
+        return elapsed >= FLOW_METER_RATE_PERIOD ? 0 : FLOW_METER_RATE_PERIOD - elapsed;
+    }
+    return DEVICE_LOOP_IDLE;
+}
+
+void FlowMeter::loop() {
+    uint32_t pulses = _pulses;
+
+    if (_targetActive && (int32_t) (pulses - _targetPulse) >= 0) {
+        _targetActive = false;
+        auto callback = std::move(_onTargetReached);
+        _onTargetReached = nullptr;
+        if (callback) {
+            callback();
+        }
+    }
+
+    uint32_t now = millis();
+    uint32_t elapsed = now - _rateMillis;
+    if (elapsed >= FLOW_METER_RATE_PERIOD) {
+        _flowRate = (float) (pulses - _ratePulses) * 60000.0f / ((float) elapsed * _kFactor);
+        _ratePulses = pulses;
+        _rateMillis = now;
+    }
+}
@@ -0,0 +1,140 @@
+//
+// Hall effect flow sensor (YF-S201 style) pulse counter
+//
+
+#ifndef SMART_GARDEN_FLOWMETER_H
+#define SMART_GARDEN_FLOWMETER_H
+
+#include <Arduino.h>
+#include "DeviceLoop.h"
+
+// YF-S201: F(Hz) = 7.5 * Q(L/min) -> 450 pulses per litre
+#ifndef FLOW_METER_DEFAULT_K_FACTOR
+#define FLOW_METER_DEFAULT_K_FACTOR 450.0f
+#endif
+
+// Window used to compute the flow rate
+#ifndef FLOW_METER_RATE_PERIOD
+#define FLOW_METER_RATE_PERIOD 1000UL
+#endif
+
+class FlowMeter {
+public:
+    /**
+     * @brief Construct a new FlowMeter object
+     * @param pin sensor output pin
+     * @param kFactor pulses per litre
+     * @param mode pin mode. Default is INPUT (the sensor has its own pull-up)
+     */
+    explicit FlowMeter(uint8_t pin, float kFactor = FLOW_METER_DEFAULT_K_FACTOR, uint8_t mode = INPUT);
+
+    ~FlowMeter();
+
+    /**
+     * @brief Configure the pin and start counting pulses in the interrupt handler
+     */
+    void begin();
+
+    /**
+     * @brief Set the calibration factor
+     * @param kFactor pulses per litre
+     */
+    void setKFactor(float kFactor) {
+        if (kFactor > 0) _kFactor = kFactor;
+    }
+
+    float getKFactor() const {
+        return _kFactor;
+    }
+
+    /**
+     * @brief Derive the K-factor from a measured volume.
+     * Reset, let a known amount of water through, then pass the volume that was actually collected
+     * @param measuredLiters collected volume since the last reset()
+     * @return true if enough pulses were counted to calibrate
+     */
+    bool calibrate(float measuredLiters);
+
+    /**
+     * @brief Total pulses counted since begin()
+     */
+    uint32_t getPulses() const {
+        return _pulses;
+    }
+
+    /**
+     * @brief Start a new volume measurement
+     */
+    void reset();
+
+    /**
+     * @brief Volume since the last reset() in litres
+     */
+    float getLiters() const {
+        return (float) (uint32_t) (_pulses - _startPulses) / _kFactor;
+    }
+
+    /**
+     * @brief Flow rate over the last FLOW_METER_RATE_PERIOD in litres per minute
+     */
+    float getFlowRate() const {
+        return _flowRate;
+    }
+
+    /**
+     * @brief Call onReached once the given volume has flowed, counted from now
+     * @param liters target volume
+     * @param onReached called from loop(), e.g. to close the valve
+     */
+    void startTarget(float liters, std::function<void()> onReached);
+
+    /**
+     * @brief Drop the pending target without calling its callback
+     */
+    void cancelTarget();
+
+    bool hasTarget() const {
+        return _targetActive;
+    }
+
+    /**
+     * @brief Litres left until the target is reached, 0 without a target
+     */
+    float getRemainingLiters() const;
+
+    /**
+     * @brief Time until loop() has work to do: a reached target or the next flow rate sample
+     * @return milliseconds, 0 if due now, DEVICE_LOOP_IDLE if nothing is pending
+     */
+    uint32_t getNextDeadline() const;
+
+    /**
+     * @brief Loop function to be called in the main loop
+     */
+    void loop();
+
+protected:
+    uint8_t _pin;
+    uint8_t _mode;
+    float _kFactor;
+    bool _attached = false;
+
+    volatile uint32_t _pulses = 0;
+    volatile uint32_t _targetPulse = 0;
+    uint32_t _startPulses = 0;
+
+    volatile bool _targetActive = false;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED; // _pulses / _targetPulse / _targetActive with the ISR
+#endif
+    std::function<void()> _onTargetReached = nullptr;
+
+    float _flowRate = 0;
+    uint32_t _ratePulses = 0;
+    uint32_t _rateMillis = 0;
+
+    static void IRAM_ATTR _onPulse(void *arg);
+};
+
+
+#endif //SMART_GARDEN_FLOWMETER_H
@@ -16,45 +16,136 @@ GenericInput::GenericInput(uint8_t pin, uint8_t mode, bool activeState, uint32_t
 }
 
 GenericInput::~GenericInput() {
+    useInterrupt(false);
     _onChangeCB = nullptr;
     _onActiveCB = nullptr;
     _onInactiveCB = nullptr;
 }
 
-void GenericInput::loop() {
-    bool currentState = digitalRead(_pin);
-    bool isActive = currentState == _activeState;
+void IRAM_ATTR GenericInput::_onEdge(void *arg) {
+    auto *self = static_cast<GenericInput *>(arg);
+    uint8_t head = self->_edgeHead;
+    uint8_t nextHead = (head + 1) % GENERIC_INPUT_EDGE_QUEUE_SIZE;
+    if (nextHead == self->_edgeTail) {
+        // Queue full: loop() resyncs from the pin level
+        self->_droppedEdges++;
+    } else {
+        self->_edges[head] = {(uint32_t) millis(), digitalRead(self->_pin) == HIGH};
+        self->_edgeHead = nextHead;
+    }
+    DeviceLoop::notifyFromISR();
+}
 
-    if (currentState != _lastReadState) {
-        _lastDebounceTime = millis();
+void GenericInput::useInterrupt(bool enable) {
+    if (enable == _interruptEnabled) return;
+    _interruptEnabled = enable;
+    if (enable) {
+        _edgeHead = _edgeTail = 0;
+        _droppedEdges = _handledDrops = 0;
+        attachInterruptArg(digitalPinToInterrupt(_pin), _onEdge, this, CHANGE);
+    } else {
+        detachInterrupt(digitalPinToInterrupt(_pin));
     }
-    if (millis() - _lastDebounceTime >= _debounceTime && currentState != _lastState) {
-        GI_DEBUG_PRINT("[%d] has been changed to: %d (%s)\n", _pin, _lastState, isActive ? "ACTIVE" : "INACTIVE");
-        _lastState = currentState;
-        _allHoldCBExecuted = false;
-        if (isActive) {
-            _lastActiveTime = millis();
-            if (_onActiveCB != nullptr) {
-                _onActiveCB();
-            }
-        } else {
-            _lastInactiveTime = millis();
-            if (_onInactiveCB != nullptr) {
-                _onInactiveCB();
-            }
-        }
+}
+
+uint32_t GenericInput::getNextDeadline() const {
+    if (_edgeHead != _edgeTail || _droppedEdges != _handledDrops) return 0;
+
+    uint32_t now = millis();
+    uint32_t next = _interruptEnabled ? DEVICE_LOOP_IDLE : _debounceTime;
+
+    // Debounce in progress
+    if (_lastReadState != _lastState) {
+        uint32_t elapsed = now - _lastDebounceTime;
+        return elapsed >= _debounceTime ? 0 : _debounceTime - elapsed;
+    }
+
+    if (!_allHoldCBExecuted) {
+        bool isActive = _lastState == _activeState;
+        uint32_t elapsed = now - (isActive ? _lastActiveTime : _lastInactiveTime);
+        bool pending = false;
         for (auto &cb: _holdStateCBs) {
-            if (cb.state == isActive) {
-                cb.executed = false;
-            }
+            if (cb.state != isActive || cb.executed) continue;
+            pending = true;
+            uint32_t remaining = elapsed >= cb.time ? 0 : cb.time - elapsed;
+            if (remaining < next) next = remaining;
+        }
+#ifdef USE_FIREBASE_RTDB
+        pending = true;
+        uint32_t remaining = elapsed >= _reportStateDelay ? 0 : _reportStateDelay - elapsed;
+        if (remaining < next) next = remaining;
+#endif
+        // Let loop() mark the callbacks as done
+        if (!pending) next = 0;
+    }
+    return next;
+}
+
+void GenericInput::_readEdge(bool level, uint32_t time) {
+    // The previous level was stable long enough before this edge
+    if (_lastReadState != _lastState && time - _lastDebounceTime >= _debounceTime) {
+        _setState(_lastReadState, _lastDebounceTime + _debounceTime);
+    }
+    _lastReadState = level;
+    _lastDebounceTime = time;
+}
+
+void GenericInput::_drainEdges() {
+    while (_edgeTail != _edgeHead) {
+        GI_edge_t edge = _edges[_edgeTail];
+        _edgeTail = (_edgeTail + 1) % GENERIC_INPUT_EDGE_QUEUE_SIZE;
+        _readEdge(edge.level, edge.time);
+    }
+    uint16_t dropped = _droppedEdges;
+    if (dropped != _handledDrops) {
+        GI_DEBUG_PRINT("[%d] %d edges dropped, resync from pin\n", _pin, (uint16_t) (dropped - _handledDrops));
+        _handledDrops = dropped;
+        _readEdge(digitalRead(_pin), millis());
+    }
+}
+
+void GenericInput::_setState(bool level, uint32_t time) {
+    bool isActive = level == _activeState;
+    GI_DEBUG_PRINT("[%d] has been changed to: %d (%s)\n", _pin, level, isActive ? "ACTIVE" : "INACTIVE");
+    _lastState = level;
+    _allHoldCBExecuted = false;
+    if (isActive) {
+        _lastActiveTime = time;
+        if (_onActiveCB != nullptr) {
+            _onActiveCB();
         }
-        if (_onChangeCB != nullptr) {
-            _onChangeCB();
+    } else {
+        _lastInactiveTime = time;
+        if (_onInactiveCB != nullptr) {
+            _onInactiveCB();
         }
     }
-    _lastReadState = currentState;
+    for (auto &cb: _holdStateCBs) {
+        if (cb.state == isActive) {
+            cb.executed = false;
+        }
+    }
+    if (_onChangeCB != nullptr) {
+        _onChangeCB();
+    }
+}
+
+void GenericInput::loop() {
+    if (_interruptEnabled) {
+        _drainEdges();
+    } else {
+        bool currentState = digitalRead(_pin);
+        if (currentState != _lastReadState) {
+            _lastReadState = currentState;
+            _lastDebounceTime = millis();
+        }
+    }
+    if (_lastReadState != _lastState && millis() - _lastDebounceTime >= _debounceTime) {
+        _setState(_lastReadState, _interruptEnabled ? _lastDebounceTime + _debounceTime : millis());
+    }
 
     if (!_allHoldCBExecuted) {
+        bool isActive = _lastState == _activeState;
         uint32_t lastChangeTime = isActive ? _lastActiveTime : _lastInactiveTime;
         GI_DEBUG_PRINT("Checking hold state callbacks\n");
         uint8_t pendingCnt = 0;
@@ -84,4 +175,4 @@ void GenericInput::loop() {
 
         GI_DEBUG_PRINT("> Pending hold state callbacks: %d\n", pendingCnt);
     } // !_allHoldCBExecuted
-} // loop
\ No newline at end of file
+} // loop
@@ -7,6 +7,7 @@
 
 #include <Arduino.h>
 #include <vector>
+#include "DeviceLoop.h"
 
 #define DEBUG_GENERIC_INPUT
 
@@ -24,6 +25,7 @@
 
 #include <FirebaseClient.h>
 #include "FirebaseRTDBIntegrate.h"
+#include "StateReporter.h"
 
 #ifndef USE_FIREBASE_RTDB
 #define USE_FIREBASE_RTDB
@@ -34,6 +36,17 @@
 
 
 
+// Edges buffered between two loop() calls in interrupt mode
+#ifndef GENERIC_INPUT_EDGE_QUEUE_SIZE
+#define GENERIC_INPUT_EDGE_QUEUE_SIZE 16
+#endif
+static_assert(GENERIC_INPUT_EDGE_QUEUE_SIZE >= 2 && GENERIC_INPUT_EDGE_QUEUE_SIZE <= 256, "edge queue uses uint8_t indexes");
+
+struct GI_edge_t {
+    uint32_t time;
+    bool level;
+};
+
 struct GI_hold_state_cb_t {
     bool state;
     uint32_t time;
@@ -211,6 +224,34 @@ public:
         return false;
     }
 
+    /**
+     * @brief Timestamp edges in a GPIO interrupt instead of polling the pin.
+     * Edges are queued by the ISR and debounced by their timestamps in loop(), so pulses shorter than
+     * the loop period are not missed and the reaction latency is bounded by the debounce time.
+     * @param enable false to go back to polling
+     */
+    void useInterrupt(bool enable = true);
+
+    /**
+     * @brief Check if the input is interrupt driven
+     */
+    bool isInterruptEnabled() const {
+        return _interruptEnabled;
+    }
+
+    /**
+     * @brief Number of edges lost because the queue was full since useInterrupt()
+     */
+    uint16_t getDroppedEdges() const {
+        return _droppedEdges;
+    }
+
+    /**
+     * @brief Time until loop() has work to do: a pending edge, debounce or hold state callback
+     * @return milliseconds, 0 if due now, DEVICE_LOOP_IDLE if nothing is pending
+     */
+    uint32_t getNextDeadline() const;
+
     /**
      * @brief Loop function to be called in the main loop
      */
@@ -304,6 +345,22 @@ protected:
     bool _allHoldCBExecuted = false;
     std::vector<GI_hold_state_cb_t> _holdStateCBs;
 
+    bool _interruptEnabled = false;
+    // Single producer (ISR) / single consumer (loop) ring, head is only written by the ISR
+    GI_edge_t _edges[GENERIC_INPUT_EDGE_QUEUE_SIZE]{};
+    volatile uint8_t _edgeHead = 0;
+    volatile uint8_t _edgeTail = 0;
+    volatile uint16_t _droppedEdges = 0;
+    uint16_t _handledDrops = 0;
+
+    static void IRAM_ATTR _onEdge(void *arg);
+
+    void _drainEdges();
+
+    void _readEdge(bool level, uint32_t time);
+
+    void _setState(bool level, uint32_t time);
+
 
 #ifdef USE_FIREBASE_RTDB
     fbrtdb_object *_databaseConfig = nullptr;
@@ -321,10 +378,14 @@ protected:
 
     void _setRTDBState() {
         if (_databaseConfig != nullptr && _rtdbPath.length() > 0) {
+            bool state = digitalRead(_pin) == _activeState;
+            if (_databaseConfig->reporter != nullptr && _databaseConfig->reporter->report(_rtdbPath, state)) {
+                return;
+            }
             _databaseConfig->rtdb->set(
                     *_databaseConfig->client,
                     _databaseConfig->prefixPath + _rtdbPath,
-                    digitalRead(_pin) == _activeState,
+                    state,
                     _fbCallback,
                     _rtdbTaskId);
         }
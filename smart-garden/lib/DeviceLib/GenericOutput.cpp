@@ -6,16 +6,19 @@ namespace stdGenericOutput {
         if (_pOnDelay > 0 && _pState != ON) {
             _previousMillis = millis();
             _pState = WAIT_FOR_ON;
+            DeviceLoop::notify();
             return;
         }
         _pState = ON;
         _previousMillis = millis();
         GenericOutputBase::on(force);
+        DeviceLoop::notify();
     }
 
     void GenericOutput::onOnce(uint32_t duration, bool force) {
         on(force);
         _onceTimeDuration = duration;
+        DeviceLoop::notify();
     }
 
     void GenericOutput::onPercentage(uint8_t percentage, bool force) {
@@ -31,15 +34,18 @@ namespace stdGenericOutput {
 
     void GenericOutput::setPowerOnDelay(uint32_t delay) {
         _pOnDelay = delay;
+        DeviceLoop::notify();
     }
 
     void GenericOutput::setAutoOff(bool autoOffEnabled) {
         _autoOffEnabled = autoOffEnabled;
+        DeviceLoop::notify();
     }
 
     void GenericOutput::setAutoOff(bool autoOffEnabled, uint32_t duration) {
         _autoOffEnabled = autoOffEnabled;
         _duration = duration;
+        DeviceLoop::notify();
     }
 
     void GenericOutput::setDuration(uint32_t duration) {
@@ -48,6 +54,7 @@ namespace stdGenericOutput {
             _autoOffEnabled = true;
         else
             _autoOffEnabled = false;
+        DeviceLoop::notify();
     }
 
     uint32_t GenericOutput::getDuration() const {
@@ -62,9 +69,25 @@ namespace stdGenericOutput {
         _onAutoOff = std::move(onAutoOff);
     }
 
+    uint32_t GenericOutput::getNextDeadline() const {
+        uint32_t elapsed = millis() - _previousMillis;
+        uint32_t next = DEVICE_LOOP_IDLE;
+        if (_state && (_onceTimeDuration > 0 || _autoOffEnabled)) {
+            uint32_t duration = _onceTimeDuration > 0 ? _onceTimeDuration : _duration;
+            next = elapsed >= duration ? 0 : duration - elapsed;
+        }
+        if (_pState == WAIT_FOR_ON) {
+            uint32_t delay = elapsed >= _pOnDelay ? 0 : _pOnDelay - elapsed;
+            if (delay < next)
+                next = delay;
+        }
+        return next;
+    }
+
     void GenericOutput::loop() {
+        // Elapsed time comparisons stay correct across the millis() rollover
         if (_onceTimeDuration > 0 && _state) {
-            if (millis() >= _previousMillis + _onceTimeDuration) {
+            if ((uint32_t) (millis() - _previousMillis) >= _onceTimeDuration) {
                 _onceTimeDuration = 0;
                 off(false);
                 if (_onAutoOff != nullptr) {
@@ -72,7 +95,7 @@ namespace stdGenericOutput {
                 }
             }
         } else if (_autoOffEnabled && _state) {
-            if (millis() >= _previousMillis + _duration) {
+            if ((uint32_t) (millis() - _previousMillis) >= _duration) {
                 off(false);
                 if (_onAutoOff != nullptr) {
                     _onAutoOff();
@@ -80,7 +103,7 @@ namespace stdGenericOutput {
             }
         }
 
-        if (_pState == WAIT_FOR_ON && millis() >= _previousMillis + _pOnDelay) {
+        if (_pState == WAIT_FOR_ON && (uint32_t) (millis() - _previousMillis) >= _pOnDelay) {
             _pState = ON;
             on(false);
         }
@@ -2,6 +2,7 @@
 #define GENERIC_OUTPUT_H
 
 #include "GenericOutputBase.h"
+#include "DeviceLoop.h"
 #include <vector>
 
 namespace stdGenericOutput {
@@ -17,7 +18,7 @@ namespace stdGenericOutput {
 
 class stdGenericOutput::GenericOutput : public stdGenericOutput::GenericOutputBase {
 public:
-    GenericOutput() : GenericOutputBase() { _startLoop(); }
+    GenericOutput() : GenericOutputBase() { }
 
 
     /**
@@ -33,8 +34,6 @@ public:
         _duration = duration;
         if (duration > 0)
             _autoOffEnabled = true;
-
-        _startLoop();
     }
 
 #if defined(USE_PCF8574)
@@ -52,8 +51,6 @@ public:
         _duration = duration;
         if (duration > 0)
             _autoOffEnabled = true;
-
-        _startLoop();
     }
 
 #endif
@@ -174,6 +171,13 @@ public:
      */
     void onAutoOff(std::function<void()> onAutoOff);
 
+    /**
+     * @brief Time until loop() has work to do: auto off, once duration or power on delay
+     *
+     * @return milliseconds, 0 if due now, DEVICE_LOOP_IDLE if nothing is pending
+     */
+    uint32_t getNextDeadline() const;
+
     /**
      * @brief function to be called in loop
      *
@@ -189,44 +193,10 @@ protected:
     uint32_t _previousMillis = 0;
     std::function<void()> _onAutoOff = nullptr;
 
-    unsigned long _loopPeriod = 500;
-
     void init() override {
         GenericOutputBase::init();
         _pState = _state ? ON : OFF;
     }
-
-    void _startLoop() {
-//        xTaskCreate([](void *p) {
-//            auto *self = static_cast<GenericOutput *>(p);
-//            for (;;) {
-//                if (self->_onceTimeDuration > 0 && self->_state) {
-//                    if (millis() >= self->_previousMillis + self->_onceTimeDuration) {
-//                        self->_onceTimeDuration = 0;
-//                        self->off(false);
-//                        if (self->_onAutoOff != nullptr) {
-//                            Serial.printf("P[%d] -> Autooff once\n", self->_pin);
-//                        }
-//                    }
-//                } else if (self->_autoOffEnabled && self->_state) {
-//                    if (millis() >= self->_previousMillis + self->_duration) {
-//                        self->off(false);
-//                        if (self->_onAutoOff != nullptr) {
-//                            Serial.printf("P[%d] -> Autooff\n", self->_pin);
-//                            self->_onAutoOff();
-//                        }
-//                    }
-//                }
-//
-//                if (self->_pState == WAIT_FOR_ON && millis() >= self->_previousMillis + self->_pOnDelay) {
-//                    Serial.printf("P[%d] -> on-delay\n", self->_pin);
-//                    self->_pState = ON;
-//                    self->on(false);
-//                }
-//                vTaskDelay(pdMS_TO_TICKS(self->_loopPeriod));
-//            }
-//        }, "loop", 4096, this, 1, nullptr);
-    }
 };
 
 
@@ -49,21 +49,20 @@ stdGenericOutput::GenericOutputBase::~GenericOutputBase() {
 
 }
 
+LastStateStore *stdGenericOutput::GenericOutputBase::getLastStateStore() {
+#ifdef USE_LAST_STATE
+    static LastStateStore store(GO_FS);
+    return &store;
+#else
+    return nullptr;
+#endif // USE_LAST_STATE
+}
+
 bool stdGenericOutput::GenericOutputBase::readLastState() {
 #ifdef USE_LAST_STATE
-    if (GO_FS.exists(_lastStateFSPath)) {
-        File file = GO_FS.open(_lastStateFSPath, "r");
-        if (file) {
-            String pinName = String(_pin) + ":";
-            while (file.available()) {
-                String line = file.readStringUntil('\n');
-                if (line.startsWith(pinName)) {
-                    file.close();
-                    return line.substring(pinName.length()).toInt() == 1;
-                }
-            }
-            file.close();
-        }
+    int8_t state = getLastStateStore()->get(_pin);
+    if (state >= 0) {
+        return state == 1;
     }
     _state = false;
     setLastState();
@@ -77,69 +76,8 @@ void stdGenericOutput::GenericOutputBase::setLastState() {
         return; // Do not save state if start up state is not set
     }
 
-    Serial.printf("Set last state of [%d] to %d\n", _pin, _state);
-    String pinName = String(_pin) + ":";
-
-#ifdef ESP8266
-    File file = GO_FS.open(_lastStateFSPath, "r+");
-    if (file) {
-        bool found = false;
-        while (file.size() && file.available()) {
-            String line = file.readStringUntil('\n');
-            if (line.startsWith(pinName)) {
-                Serial.printf("> Found at %d\n", file.position() - line.length() - 1);
-                found = true;
-                file.seek(file.position() - line.length() - 1);
-                file.print(pinName + (_state ? "1" : "0"));
-                break;
-            }
-        }
-        if (!found) {
-            Serial.printf("> Not found, print to new line\n");
-            file.println(pinName + (_state ? "1" : "0"));
-        }
-        file.close();
-    } else {
-        Serial.println("> Fail to open file");
-    }
-#else // ESP32
-    File file = GO_FS.open(_lastStateFSPath, "r");
-    if (file) {
-        int index = -1;
-        String fileContent = file.readString();
-        file.close();
-        if (fileContent.length()) {
-            index = fileContent.indexOf(pinName);
-        }
-        if (index >= 0) {
-            fileContent = fileContent.substring(0, index) + pinName + (_state ? "1" : "0") +
-                          fileContent.substring(index + pinName.length() + 1);
-            file = GO_FS.open(_lastStateFSPath, "w", true);
-            if (file) {
-                file.print(fileContent);
-                file.close();
-            } else {
-                Serial.println("> Fail to open file");
-            }
-        } else {
-            file = GO_FS.open(_lastStateFSPath, "a");
-            if (file) {
-                file.println(pinName + (_state ? "1" : "0"));
-                file.close();
-            } else {
-                Serial.println("> Fail to open file");
-            }
-        }
-    } else {
-        file = GO_FS.open(_lastStateFSPath, "w", true);
-        if (file) {
-            file.println(pinName + (_state ? "1" : "0"));
-            file.close();
-        } else {
-            Serial.println("> Fail to open file");
-        }
-    }
-#endif
+    // Written behind by the store, see LastStateStore::loop()
+    getLastStateStore()->set(_pin, _state);
 #endif // USE_LAST_STATE
 }
 
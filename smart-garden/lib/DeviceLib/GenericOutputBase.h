@@ -14,6 +14,7 @@
 
 #include <FirebaseClient.h>
 #include "FirebaseRTDBIntegrate.h"
+#include "StateReporter.h"
 
 #ifndef USE_FIREBASE_RTDB
 #define USE_FIREBASE_RTDB
@@ -36,6 +37,8 @@
 #endif
 #endif // USE_LAST_STATE
 
+#include "LastStateStore.h"
+
 
 //template<typename T = std::function<void()>>
 //void start_callback(T cb, const char *name = "IOTask", uint32_t stack = 2048, uint8_t priority = 1) {
@@ -185,6 +188,12 @@ public:
      */
     startup_state_t getStartUpState() const;
 
+    /**
+     * @brief Last state store shared by all outputs. Register its loop() and flush() it before a restart
+     * @return nullptr when USE_LAST_STATE is disabled
+     */
+    static LastStateStore *getLastStateStore();
+
     /**
      * @brief Set callback function to be called when power is on
      *
@@ -275,9 +284,6 @@ protected:
     std::function<void()> _onPowerOff = nullptr;
     std::function<void()> _onPowerChanged = nullptr;
 
-#ifdef USE_LAST_STATE
-    const String _lastStateFSPath = "/gpiols";
-#endif
 
     /**
      * @brief read/set last state
@@ -315,6 +321,9 @@ protected:
 
     void _setRTDBState() {
         if (_databaseConfig != nullptr) {
+            if (_databaseConfig->reporter != nullptr && _databaseConfig->reporter->report(_rtdbPath, _state)) {
+                return;
+            }
             _databaseConfig->rtdb->set(
                     *_databaseConfig->client,
                     _databaseConfig->prefixPath + _rtdbPath,
@@ -0,0 +1,185 @@
+//
+// Fixed-slot binary store for the output last states
+//
+
+#include "LastStateStore.h"
+
+static const uint32_t RECORDS_OFFSET = sizeof(last_state_header_t);
+
+uint32_t last_state_record_t::computeChecksum() const {
+    // FNV-1a over the sequence number and the slots
+    uint32_t hash = 2166136261UL;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(this);
+    for (size_t i = 0; i < offsetof(last_state_record_t, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+bool LastStateStore::begin() {
+    if (_loaded) return true;
+    _loaded = true;
+
+    if (_fs.exists(_path) && _load()) {
+        return true;
+    }
+    if (_fs.exists(_legacyPath)) {
+        _migrateLegacyFile();
+        return true;
+    }
+    return _writeAll();
+}
+
+bool LastStateStore::_load() {
+    File file = _fs.open(_path, "r");
+    if (!file) return false;
+
+    last_state_header_t header{};
+    bool ok = file.read((uint8_t *) &header, sizeof(header)) == sizeof(header) &&
+              memcmp(header.magic, "GLS", 3) == 0;
+
+    if (ok && header.version == 1) {
+        // Version 1: a single slot table
+        ok = file.read(_slots, sizeof(_slots)) == sizeof(_slots);
+        file.close();
+        if (!ok) {
+            memset(_slots, LAST_STATE_UNKNOWN, sizeof(_slots));
+            return false;
+        }
+        Serial.println("LastStateStore: upgrade file to version 2");
+        return _writeAll();
+    }
+
+    bool found = false;
+    if (ok && header.version == LAST_STATE_FILE_VERSION) {
+        last_state_record_t record{};
+        for (uint8_t i = 0; i < 2; i++) {
+            if (file.read((uint8_t *) &record, sizeof(record)) != sizeof(record)) break;
+            if (record.checksum != record.computeChecksum()) continue; // torn write
+            if (!found || (int32_t) (record.seq - _seq) > 0) {
+                found = true;
+                _seq = record.seq;
+                _active = i;
+                memcpy(_slots, record.slots, sizeof(_slots));
+            }
+        }
+    }
+    file.close();
+
+    if (!found) {
+        Serial.println("LastStateStore: invalid file, reset");
+        memset(_slots, LAST_STATE_UNKNOWN, sizeof(_slots));
+        return false;
+    }
+    memcpy(_stored, _slots, sizeof(_slots));
+    return true;
+}
+
+void LastStateStore::_migrateLegacyFile() {
+    File file = _fs.open(_legacyPath, "r");
+    if (!file) return;
+    // "pin:state" per line. Parse the full pin number: "1:" must not match "11:1"
+    while (file.available()) {
+        String line = file.readStringUntil('\n');
+        int sep = line.indexOf(':');
+        if (sep <= 0) continue;
+        long id = line.substring(0, sep).toInt();
+        if (id < 0 || id >= LAST_STATE_SLOTS) continue;
+        _slots[id] = line.substring(sep + 1).toInt() == 1 ? 1 : 0;
+    }
+    file.close();
+    Serial.println("LastStateStore: migrated legacy file");
+    if (_writeAll()) {
+        _fs.remove(_legacyPath);
+    }
+}
+
+bool LastStateStore::_writeRecord(File &file, uint8_t index) {
+    last_state_record_t record{};
+    record.seq = _seq + 1;
+    memcpy(record.slots, _slots, sizeof(_slots));
+    record.checksum = record.computeChecksum();
+    if (!file.seek(RECORDS_OFFSET + index * sizeof(record))) return false;
+    if (file.write((const uint8_t *) &record, sizeof(record)) != sizeof(record)) return false;
+    _seq = record.seq;
+    _active = index;
+    return true;
+}
+
+bool LastStateStore::_writeAll() {
+    File file = _fs.open(_path, "w", true);
+    if (!file) {
+        Serial.println("LastStateStore: fail to open file");
+        return false;
+    }
+    last_state_header_t header{{'G', 'L', 'S'}, LAST_STATE_FILE_VERSION};
+    // Both records hold the current states
+    bool ok = file.write((const uint8_t *) &header, sizeof(header)) == sizeof(header) &&
+              _writeRecord(file, 0) && _writeRecord(file, 1);
+    file.close();
+    _writeCount++;
+    if (ok) {
+        memcpy(_stored, _slots, sizeof(_slots));
+        _dirty = false;
+    }
+    return ok;
+}
+
+int8_t LastStateStore::get(uint8_t id) {
+    begin();
+    return _slots[id] == LAST_STATE_UNKNOWN ? -1 : (int8_t) _slots[id];
+}
+
+void LastStateStore::set(uint8_t id, bool state) {
+    begin();
+    uint8_t value = state ? 1 : 0;
+    if (_slots[id] == value) return;
+    _slots[id] = value;
+    uint32_t now = millis();
+    if (!_dirty) {
+        _dirty = true;
+        _firstChange = now;
+    }
+    _lastChange = now;
+}
+
+bool LastStateStore::flush() {
+    if (!_dirty) return true;
+    if (memcmp(_slots, _stored, sizeof(_slots)) == 0) {
+        // Flipped back to the saved values
+        _dirty = false;
+        return true;
+    }
+
+    File file = _fs.open(_path, "r+");
+    if (!file) {
+        // File lost: rewrite it from RAM
+        return _writeAll();
+    }
+    bool ok = _writeRecord(file, _active ^ 1);
+    file.close();
+    _writeCount++;
+    if (ok) {
+        memcpy(_stored, _slots, sizeof(_slots));
+        _dirty = false;
+    } else {
+        Serial.println("LastStateStore: flush failed");
+    }
+    return ok;
+}
+
+uint32_t LastStateStore::getNextDeadline() const {
+    if (!_dirty) return DEVICE_LOOP_IDLE;
+    uint32_t now = millis();
+    uint32_t quiet = now - _lastChange;
+    uint32_t pending = now - _firstChange;
+    if (quiet >= LAST_STATE_FLUSH_DELAY || pending >= LAST_STATE_MAX_FLUSH_DELAY) return 0;
+    uint32_t next = LAST_STATE_FLUSH_DELAY - quiet;
+    return std::min<uint32_t>(next, LAST_STATE_MAX_FLUSH_DELAY - pending);
+}
+
+void LastStateStore::loop() {
+    if (_dirty && getNextDeadline() == 0) {
+        flush();
+    }
+}
@@ -0,0 +1,131 @@
+//
+// Fixed-slot binary store for the output last states
+//
+
+#ifndef SMART_GARDEN_LASTSTATESTORE_H
+#define SMART_GARDEN_LASTSTATESTORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "DeviceLoop.h"
+
+#define LAST_STATE_FILE_VERSION 2
+#define LAST_STATE_SLOTS 256
+#define LAST_STATE_UNKNOWN 0xFF
+
+// Flush once the states have been quiet for this long (ms)
+#ifndef LAST_STATE_FLUSH_DELAY
+#define LAST_STATE_FLUSH_DELAY 3000UL
+#endif
+
+// Upper bound for a state to stay unsaved while outputs keep changing (ms)
+#ifndef LAST_STATE_MAX_FLUSH_DELAY
+#define LAST_STATE_MAX_FLUSH_DELAY 30000UL
+#endif
+
+struct last_state_header_t {
+    char magic[3]; // "GLS"
+    uint8_t version;
+};
+
+struct last_state_record_t {
+    uint32_t seq;
+    uint8_t slots[LAST_STATE_SLOTS];
+    uint32_t checksum;
+
+    uint32_t computeChecksum() const;
+};
+
+/**
+ * @brief One byte per pin / virtual device ID, cached in RAM and written behind.
+ *
+ * set() only updates the RAM copy, so switching an output never waits on flash. Dirty states are
+ * flushed by loop() after LAST_STATE_FLUSH_DELAY without changes (at most LAST_STATE_MAX_FLUSH_DELAY
+ * after the first one), or by flush() before a restart / OTA. A pin flipped back to its saved value
+ * costs no write.
+ *
+ * File: header + two checksummed records. A flush overwrites the older record with the next sequence
+ * number, load picks the newest valid one, so a write torn by a reset leaves the previous states.
+ * The version 1 file (single slot table) and the legacy text file ("pin:state" lines) are migrated.
+ */
+class LastStateStore {
+public:
+    explicit LastStateStore(fs::FS &fs, const char *path = "/gpiols.bin", const char *legacyPath = "/gpiols")
+            : _fs(fs), _path(path), _legacyPath(legacyPath) {
+        memset(_slots, LAST_STATE_UNKNOWN, sizeof(_slots));
+        memset(_stored, LAST_STATE_UNKNOWN, sizeof(_stored));
+    }
+
+    /**
+     * @brief Load the slots into RAM, migrating or creating the file if needed
+     * @return false if the file can not be created
+     */
+    bool begin();
+
+    /**
+     * @brief State of a pin, including the ones not flushed yet
+     * @param id pin number or virtual device ID
+     * @return 1 / 0, -1 if never saved
+     */
+    int8_t get(uint8_t id);
+
+    /**
+     * @brief Save the state of a pin. Written to flash by loop() or flush()
+     * @param id pin number or virtual device ID
+     * @param state
+     */
+    void set(uint8_t id, bool state);
+
+    /**
+     * @brief Write the pending states now
+     * @return true if the file is up to date
+     */
+    bool flush();
+
+    bool isDirty() const {
+        return _dirty;
+    }
+
+    /**
+     * @brief Time until loop() flushes
+     * @return milliseconds, 0 if due now, DEVICE_LOOP_IDLE if nothing is pending
+     */
+    uint32_t getNextDeadline() const;
+
+    /**
+     * @brief Flush once the quiet period has passed
+     */
+    void loop();
+
+    /**
+     * @brief Number of flash writes since begin(), for diagnostics and tests
+     */
+    uint32_t getWriteCount() const {
+        return _writeCount;
+    }
+
+private:
+    fs::FS &_fs;
+    const char *_path;
+    const char *_legacyPath;
+    uint8_t _slots[LAST_STATE_SLOTS];
+    uint8_t _stored[LAST_STATE_SLOTS]; // what the newest record on flash holds
+    bool _loaded = false;
+    bool _dirty = false;
+    uint32_t _firstChange = 0;
+    uint32_t _lastChange = 0;
+    uint32_t _seq = 0;
+    uint8_t _active = 0; // record holding _seq
+    uint32_t _writeCount = 0;
+
+    bool _load();
+
+    bool _writeAll();
+
+    bool _writeRecord(File &file, uint8_t index);
+
+    void _migrateLegacyFile();
+};
+
+
+#endif //SMART_GARDEN_LASTSTATESTORE_H
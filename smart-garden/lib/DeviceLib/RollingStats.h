@@ -0,0 +1,133 @@
+//
+// Fixed-size rolling min / avg / max over time buckets
+//
+
+#ifndef SMART_GARDEN_ROLLINGSTATS_H
+#define SMART_GARDEN_ROLLINGSTATS_H
+
+#include <Arduino.h>
+
+struct stats_bucket_t {
+    float min;
+    float max;
+    double sum;
+    uint32_t count;
+
+    void clear() {
+        min = max = 0;
+        sum = 0;
+        count = 0;
+    }
+
+    void add(float v) {
+        if (!count || v < min) min = v;
+        if (!count || v > max) max = v;
+        sum += v;
+        count++;
+    }
+
+    void merge(const stats_bucket_t &other) {
+        if (!other.count) return;
+        if (!count || other.min < min) min = other.min;
+        if (!count || other.max > max) max = other.max;
+        sum += other.sum;
+        count += other.count;
+    }
+
+    float avg() const {
+        return count ? (float) (sum / count) : 0;
+    }
+};
+
+/**
+ * @brief Sliding window over the last N buckets.
+ * push() and get() are O(1): the sum is kept running and min / max come from monotonic queues
+ * of bucket sequence numbers, so no bucket is rescanned when the oldest one is evicted.
+ */
+template<uint8_t N>
+class RollingWindow {
+public:
+    RollingWindow() {
+        clear();
+    }
+
+    void clear() {
+        _seq = 0;
+        _size = 0;
+        _total.clear();
+        _minHead = _minSize = 0;
+        _maxHead = _maxSize = 0;
+    }
+
+    /**
+     * @brief Append a bucket, evicting the oldest one when the window is full. Empty buckets keep
+     * their time slot but never become the min / max
+     */
+    void push(const stats_bucket_t &bucket) {
+        if (_size == N) {
+            uint32_t oldest = _seq - N;
+            const stats_bucket_t &old = _ring[oldest % N];
+            _total.sum -= old.sum;
+            _total.count -= old.count;
+            if (_minSize && _minQueue[_minHead] == oldest) _pop(_minHead, _minSize);
+            if (_maxSize && _maxQueue[_maxHead] == oldest) _pop(_maxHead, _maxSize);
+        } else {
+            _size++;
+        }
+
+        _ring[_seq % N] = bucket;
+        if (bucket.count) {
+            _total.sum += bucket.sum;
+            _total.count += bucket.count;
+            while (_minSize && _ring[_back(_minQueue, _minHead, _minSize) % N].min >= bucket.min) _minSize--;
+            _minQueue[(_minHead + _minSize++) % N] = _seq;
+            while (_maxSize && _ring[_back(_maxQueue, _maxHead, _maxSize) % N].max <= bucket.max) _maxSize--;
+            _maxQueue[(_maxHead + _maxSize++) % N] = _seq;
+        }
+        _seq++;
+    }
+
+    /**
+     * @brief Aggregate of all buckets in the window
+     */
+    stats_bucket_t get() const {
+        stats_bucket_t out = _total;
+        if (_total.count == 0) {
+            out.clear();
+            return out;
+        }
+        out.min = _ring[_minQueue[_minHead] % N].min;
+        out.max = _ring[_maxQueue[_maxHead] % N].max;
+        return out;
+    }
+
+    uint8_t size() const {
+        return _size;
+    }
+
+    static constexpr uint8_t capacity() {
+        return N;
+    }
+
+private:
+    stats_bucket_t _ring[N];
+    stats_bucket_t _total;
+    uint32_t _seq;
+    uint8_t _size;
+    uint32_t _minQueue[N];
+    uint32_t _maxQueue[N];
+    uint8_t _minHead, _minSize;
+    uint8_t _maxHead, _maxSize;
+
+    static uint32_t _back(const uint32_t *queue, uint8_t head, uint8_t size) {
+        return queue[(head + size - 1) % N];
+    }
+
+    static void _pop(uint8_t &head, uint8_t &size) {
+        head = (head + 1) % N;
+        size--;
+    }
+};
+
+
+#endif //SMART_GARDEN_ROLLINGSTATS_H
@@ -0,0 +1,138 @@
+//
+// Coalesces the device state reports into one multi-path database update
+//
+
+#include "StateReporter.h"
+
+state_report_entry_t *StateReporter::_find(const String &path, bool create) {
+    const char *key = path.c_str();
+    if (*key == '/') key++;
+    for (uint8_t i = 0; i < _entryCount; i++) {
+        if (_entries[i].path == key) return &_entries[i];
+    }
+    if (!create || _entryCount >= STATE_REPORTER_MAX_PATHS) return nullptr;
+    state_report_entry_t &entry = _entries[_entryCount++];
+    entry.path = key;
+    entry.pending = false;
+    entry.inFlight = false;
+    return &entry;
+}
+
+bool StateReporter::reportJson(const String &path, const String &json, bool force) {
+    state_report_entry_t *entry = _find(path, true);
+    if (entry == nullptr) {
+        Serial.printf("StateReporter: too many paths, %s not queued\n", path.c_str());
+        return false;
+    }
+
+    // Flipped back before it was sent: the database (or the update in flight) already has it
+    const String &current = entry->inFlight ? entry->flight : entry->sent;
+    if (!force && json == current) {
+        entry->pending = false;
+        return true;
+    }
+    if (entry->pending && entry->value == json) return true;
+
+    bool wasPending = isPending();
+    entry->value = json;
+    entry->pending = true;
+    if (!wasPending) {
+        _windowStart = millis();
+        _wait = STATE_REPORTER_WINDOW;
+        DeviceLoop::notify();
+    }
+    return true;
+}
+
+void StateReporter::invalidate() {
+    for (uint8_t i = 0; i < _entryCount; i++) {
+        _entries[i].sent = "";
+    }
+}
+
+bool StateReporter::isPending() const {
+    for (uint8_t i = 0; i < _entryCount; i++) {
+        if (_entries[i].pending) return true;
+    }
+    return false;
+}
+
+String StateReporter::_buildPayload() {
+    String payload;
+    payload.reserve(64);
+    payload += '{';
+    for (uint8_t i = 0; i < _entryCount; i++) {
+        state_report_entry_t &entry = _entries[i];
+        if (!entry.pending) continue;
+        if (payload.length() > 1) payload += ',';
+        payload += '"';
+        payload += entry.path;
+        payload += "\":";
+        payload += entry.value;
+    }
+    payload += '}';
+    return payload;
+}
+
+void StateReporter::onSent(bool success) {
+    if (!_inFlight) return;
+    _inFlight = false;
+    for (uint8_t i = 0; i < _entryCount; i++) {
+        state_report_entry_t &entry = _entries[i];
+        if (!entry.inFlight) continue;
+        entry.inFlight = false;
+        if (success) {
+            entry.sent = entry.flight;
+            // Flipped back while in flight
+            if (entry.pending && entry.value == entry.sent) entry.pending = false;
+        } else if (!entry.pending) {
+            entry.value = entry.flight;
+            entry.pending = true;
+        }
+    }
+    if (!success) {
+        Serial.println("StateReporter: update failed, retry");
+        _windowStart = millis();
+        _wait = STATE_REPORTER_RETRY_DELAY;
+    }
+    DeviceLoop::notify();
+}
+
+uint32_t StateReporter::getNextDeadline() const {
+    uint32_t now = millis();
+    if (_inFlight) {
+        uint32_t elapsed = now - _sentAt;
+        return elapsed >= STATE_REPORTER_ACK_TIMEOUT ? 0 : STATE_REPORTER_ACK_TIMEOUT - elapsed;
+    }
+    if (_sender == nullptr || !isPending()) return DEVICE_LOOP_IDLE;
+    uint32_t elapsed = now - _windowStart;
+    return elapsed >= _wait ? 0 : _wait - elapsed;
+}
+
+void StateReporter::loop() {
+    if (getNextDeadline() != 0) return;
+
+    if (_inFlight) {
+        Serial.println("StateReporter: no answer, assume lost");
+        onSent(false);
+        return;
+    }
+
+    String payload = _buildPayload();
+    if (!_sender(payload)) {
+        // Backpressure: keep coalescing until the retry delay
+        _windowStart = millis();
+        _wait = STATE_REPORTER_RETRY_DELAY;
+        return;
+    }
+    _sendCount++;
+    _inFlight = true;
+    _sentAt = millis();
+    for (uint8_t i = 0; i < _entryCount; i++) {
+        state_report_entry_t &entry = _entries[i];
+        if (!entry.pending) continue;
+        entry.flight = entry.value;
+        entry.pending = false;
+        entry.inFlight = true;
+    }
+}
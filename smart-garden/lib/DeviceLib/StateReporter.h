@@ -0,0 +1,135 @@
+//
+// Coalesces the device state reports into one multi-path database update
+//
+
+#ifndef SMART_GARDEN_STATEREPORTER_H
+#define SMART_GARDEN_STATEREPORTER_H
+
+#include <Arduino.h>
+#include <functional>
+#include "DeviceLoop.h"
+
+// Paths tracked at the same time, a report beyond that is refused
+#ifndef STATE_REPORTER_MAX_PATHS
+#define STATE_REPORTER_MAX_PATHS 16
+#endif
+
+// Changes reported within this window after the first one share an update (ms)
+#ifndef STATE_REPORTER_WINDOW
+#define STATE_REPORTER_WINDOW 100UL
+#endif
+
+// Wait before trying again when the sender is busy or the update failed (ms)
+#ifndef STATE_REPORTER_RETRY_DELAY
+#define STATE_REPORTER_RETRY_DELAY 500UL
+#endif
+
+// An update without an answer after this long is considered lost (ms)
+#ifndef STATE_REPORTER_ACK_TIMEOUT
+#define STATE_REPORTER_ACK_TIMEOUT 15000UL
+#endif
+
+struct state_report_entry_t {
+    String path;   // relative to the update root, without the leading '/'
+    String value;  // JSON literal waiting to be sent
+    String flight; // JSON literal of the update in flight
+    String sent;   // last JSON literal confirmed by the database
+    bool pending;
+    bool inFlight;
+};
+
+/**
+ * @brief Queue of state changes from all devices, sent as one multi-path update.
+ *
+ * Devices call report() instead of writing their own path. The first change opens a
+ * STATE_REPORTER_WINDOW, everything reported until it closes goes out in a single
+ * {"path": value, ...} payload. A value flipped back to what the database already holds is dropped.
+ *
+ * Only one update is in flight at a time. The sender returns false when its client queue is full
+ * (or it is not connected yet): the changes stay queued and keep coalescing until the retry delay.
+ * Call onSent() from the update callback; a failed update is queued again unless newer values
+ * replaced it.
+ */
+class StateReporter {
+public:
+    /**
+     * @brief Queue the payload for sending
+     * @return false if it can not be queued now
+     */
+    typedef std::function<bool(const String &payload)> state_report_sender_t;
+
+    void setSender(state_report_sender_t sender) {
+        _sender = std::move(sender);
+    }
+
+    /**
+     * @brief Report a boolean state
+     * @param path relative to the update root, e.g. "/valve"
+     * @param state
+     * @return false if the path table is full
+     */
+    bool report(const String &path, bool state) {
+        return reportJson(path, state ? "true" : "false");
+    }
+
+    /**
+     * @brief Report a value already serialized as JSON
+     * @param path relative to the update root
+     * @param json JSON literal, e.g. "12", "\"text\"" or "{...}"
+     * @param force send even if the database already holds this value
+     * @return false if the path table is full
+     */
+    bool reportJson(const String &path, const String &json, bool force = false);
+
+    /**
+     * @brief Forget what the database holds, so the next reports are always sent
+     */
+    void invalidate();
+
+    /**
+     * @brief Result of the update passed to the sender
+     * @param success
+     */
+    void onSent(bool success);
+
+    bool isPending() const;
+
+    bool isInFlight() const {
+        return _inFlight;
+    }
+
+    /**
+     * @brief Time until loop() sends
+     * @return milliseconds, 0 if due now, DEVICE_LOOP_IDLE if nothing is queued
+     */
+    uint32_t getNextDeadline() const;
+
+    /**
+     * @brief Send the queued changes once the window has closed
+     */
+    void loop();
+
+    /**
+     * @brief Number of updates handed to the sender, for diagnostics and tests
+     */
+    uint32_t getSendCount() const {
+        return _sendCount;
+    }
+
+private:
+    state_report_entry_t _entries[STATE_REPORTER_MAX_PATHS];
+    uint8_t _entryCount = 0;
+    state_report_sender_t _sender = nullptr;
+    bool _inFlight = false;
+    uint32_t _windowStart = 0; // first change not sent yet, or last failed attempt
+    uint32_t _wait = STATE_REPORTER_WINDOW; // from _windowStart until the next attempt
+    uint32_t _sentAt = 0;
+    uint32_t _sendCount = 0;
+
+    state_report_entry_t *_find(const String &path, bool create);
+
+    String _buildPayload();
+};
+
+
+#endif //SMART_GARDEN_STATEREPORTER_H
@@ -0,0 +1,138 @@
+//
+// Text snapshot of the device states, serialized once per change
+//
+
+#include "StateSnapshot.h"
+
+bool StateSnapshot::add(const char *label, state_getter_t getState, const char *onText, const char *offText) {
+    if (_fieldCount >= STATE_SNAPSHOT_MAX_FIELDS || getState == nullptr) return false;
+    _fields[_fieldCount++] = {label, getState, onText, offText};
+    _valid = false;
+    _published = false;
+    return true;
+}
+
+uint32_t StateSnapshot::_poll() const {
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < _fieldCount; i++) {
+        if (_fields[i].getState()) mask |= 1UL << i;
+    }
+    return mask;
+}
+
+bool StateSnapshot::refresh() {
+    uint32_t mask = _poll();
+    if (_valid && mask == _mask && _renderedSeq == _seq) return false;
+    _length = _render(_buffer, 'S', mask, (1UL << _fieldCount) - 1);
+    _mask = mask;
+    _renderedSeq = _seq;
+    _valid = true;
+    _renderCount++;
+    return true;
+}
+
+size_t StateSnapshot::_render(char *buffer, char tag, uint32_t mask, uint32_t fields) const {
+    int header = snprintf(buffer, STATE_SNAPSHOT_BUFFER_SIZE, "%c:%u\n", tag, (unsigned) _seq);
+    size_t pos = header > 0 ? (size_t) header : 0;
+    for (uint8_t i = 0; i < _fieldCount; i++) {
+        if (!(fields & (1UL << i))) continue;
+        const char *value = mask & (1UL << i) ? _fields[i].onText : _fields[i].offText;
+        size_t labelLen = strlen(_fields[i].label);
+        size_t valueLen = strlen(value);
+        // "LABEL:VALUE\n" and the final '\0'
+        if (pos + labelLen + valueLen + 3 > STATE_SNAPSHOT_BUFFER_SIZE) {
+            Serial.println("StateSnapshot: buffer too small");
+            break;
+        }
+        memcpy(buffer + pos, _fields[i].label, labelLen);
+        pos += labelLen;
+        buffer[pos++] = ':';
+        memcpy(buffer + pos, value, valueLen);
+        pos += valueLen;
+        buffer[pos++] = '\n';
+    }
+    buffer[pos] = '\0';
+    return pos;
+}
+
+void StateSnapshot::markChanged() {
+    if (_marked) return;
+    _marked = true;
+    _markedAt = millis();
+    DeviceLoop::notify();
+}
+
+bool StateSnapshot::publish() {
+    _marked = false;
+    uint32_t mask = _poll();
+    uint32_t changed = _published ? mask ^ _publishedMask : (1UL << _fieldCount) - 1;
+    if (!changed) return false;
+
+    _seq++;
+    size_t length = _render(_delta, 'D', mask, changed);
+    _publishedMask = mask;
+    _published = true;
+    if (_onPublish) {
+        _onPublish(_delta, length);
+    }
+    return true;
+}
+
+void StateSnapshot::requestSnapshot(uint32_t clientId) {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portENTER_CRITICAL(&_pendingMux);
+#endif
+    bool known = false;
+    for (uint8_t i = 0; i < _pendingCount; i++) {
+        if (_pending[i] == clientId) known = true;
+    }
+    if (!known) {
+        if (_pendingCount < STATE_SNAPSHOT_MAX_PENDING) {
+            _pending[_pendingCount++] = clientId;
+        } else {
+            _pendingAll = true;
+        }
+    }
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portEXIT_CRITICAL(&_pendingMux);
+#endif
+    DeviceLoop::notify();
+}
+
+void StateSnapshot::_sendPending() {
+    uint32_t pending[STATE_SNAPSHOT_MAX_PENDING];
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portENTER_CRITICAL(&_pendingMux);
+#endif
+    uint8_t count = _pendingCount;
+    bool all = _pendingAll;
+    memcpy(pending, _pending, count * sizeof(pending[0]));
+    _pendingCount = 0;
+    _pendingAll = false;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portEXIT_CRITICAL(&_pendingMux);
+#endif
+    if (_onSnapshot == nullptr || (!count && !all)) return;
+    if (all) {
+        _onSnapshot(STATE_SNAPSHOT_ALL_CLIENTS, c_str(), length());
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        _onSnapshot(pending[i], c_str(), length());
+    }
+}
+
+uint32_t StateSnapshot::getNextDeadline() const {
+    if (_pendingCount || _pendingAll) return 0;
+    if (!_marked) return DEVICE_LOOP_IDLE;
+    uint32_t elapsed = millis() - _markedAt;
+    return elapsed >= STATE_SNAPSHOT_PUSH_WINDOW ? 0 : STATE_SNAPSHOT_PUSH_WINDOW - elapsed;
+}
+
+void StateSnapshot::loop() {
+    if (_marked && millis() - _markedAt >= STATE_SNAPSHOT_PUSH_WINDOW) {
+        publish();
+    }
+    // After the delta, so the snapshot carries its sequence number
+    _sendPending();
+}
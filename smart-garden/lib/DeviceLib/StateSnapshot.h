@@ -0,0 +1,196 @@
+//
+// Text snapshot of the device states, serialized once per change
+//
+
+#ifndef SMART_GARDEN_STATESNAPSHOT_H
+#define SMART_GARDEN_STATESNAPSHOT_H
+
+#include <Arduino.h>
+#include <functional>
+#include "DeviceLoop.h"
+
+// Devices in one snapshot
+#ifndef STATE_SNAPSHOT_MAX_FIELDS
+#define STATE_SNAPSHOT_MAX_FIELDS 8
+#endif
+
+// Rendered text, including the terminating '\0'
+#ifndef STATE_SNAPSHOT_BUFFER_SIZE
+#define STATE_SNAPSHOT_BUFFER_SIZE 128
+#endif
+
+// Changes marked within this window after the first one share a delta message (ms)
+#ifndef STATE_SNAPSHOT_PUSH_WINDOW
+#define STATE_SNAPSHOT_PUSH_WINDOW 50UL
+#endif
+
+// Clients waiting for a snapshot; past this, loop() sends one to every client
+#ifndef STATE_SNAPSHOT_MAX_PENDING
+#define STATE_SNAPSHOT_MAX_PENDING 8
+#endif
+
+// Client id of a snapshot meant for every client
+#define STATE_SNAPSHOT_ALL_CLIENTS 0
+
+struct state_snapshot_field_t {
+    const char *label;
+    bool (*getState)();
+    const char *onText;
+    const char *offText;
+};
+
+/**
+ * @brief "LABEL:ON\n" lines for a fixed set of devices, kept in preallocated buffers.
+ *
+ * The states are polled as a bit mask; text is only rendered again when the mask differs from the
+ * last render, so answering a client costs no heap allocation and no formatting while nothing changed.
+ *
+ * Messages:
+ *  - snapshot, c_str(): "S:<seq>\n" followed by every device line, sent to one client on connect / "GET"
+ *    through requestSnapshot(), from the task running loop() so it never goes out half rewritten
+ *  - delta, published by loop(): "D:<seq>\n" followed by the lines that changed since the previous delta
+ *
+ * markChanged() opens a STATE_SNAPSHOT_PUSH_WINDOW, a burst of relay changes inside it becomes one delta.
+ * The sequence number grows by one per delta; a client seeing "D:" with anything but its last seq + 1
+ * missed a message and asks for a snapshot. Clients that ignore the "S"/"D" lines still work.
+ *
+ * There is one sequence for all clients rather than one per client: every delta is broadcast to all of
+ * them, so per-client counters would hold the same values. The per-client part is the last seq each
+ * client has seen, kept by the client (wsSeq in main.html). A client whose queue dropped a delta sees
+ * the gap on the next one and resyncs with "GET", whose snapshot carries the current seq.
+ */
+class StateSnapshot {
+public:
+    typedef bool (*state_getter_t)();
+    typedef std::function<void(const char *text, size_t length)> state_publish_cb_t;
+    typedef std::function<void(uint32_t clientId, const char *text, size_t length)> state_snapshot_cb_t;
+
+    /**
+     * @brief Add a device line
+     * @param label e.g. "R1", must outlive the snapshot
+     * @param getState captureless function returning the device state
+     * @param onText value when the state is true, e.g. the input active label
+     * @param offText value when the state is false
+     * @return false if STATE_SNAPSHOT_MAX_FIELDS is reached
+     */
+    bool add(const char *label, state_getter_t getState, const char *onText = "ON", const char *offText = "OFF");
+
+    /**
+     * @brief Set the function that broadcasts the deltas
+     * @param cb
+     */
+    void onPublish(state_publish_cb_t cb) {
+        _onPublish = std::move(cb);
+    }
+
+    /**
+     * @brief Set the function that sends a requested snapshot to one client
+     * @param cb called with STATE_SNAPSHOT_ALL_CLIENTS when the pending list overflowed
+     */
+    void onSnapshot(state_snapshot_cb_t cb) {
+        _onSnapshot = std::move(cb);
+    }
+
+    /**
+     * @brief Send the snapshot to a client from loop(). Safe to call from any task
+     * @param clientId not STATE_SNAPSHOT_ALL_CLIENTS
+     */
+    void requestSnapshot(uint32_t clientId);
+
+    /**
+     * @brief Render again on the next c_str()
+     */
+    void invalidate() {
+        _valid = false;
+    }
+
+    /**
+     * @brief Render the snapshot if a state changed since the last render
+     * @return true if the text changed
+     */
+    bool refresh();
+
+    /**
+     * @brief Current snapshot message, rendered if needed
+     */
+    const char *c_str() {
+        refresh();
+        return _buffer;
+    }
+
+    size_t length() {
+        refresh();
+        return _length;
+    }
+
+    /**
+     * @brief A state may have changed: publish a delta once the push window closes
+     */
+    void markChanged();
+
+    /**
+     * @brief Publish the delta now
+     * @return false if no state changed since the previous delta
+     */
+    bool publish();
+
+    /**
+     * @brief Sequence number of the last delta
+     */
+    uint32_t getSeq() const {
+        return _seq;
+    }
+
+    /**
+     * @brief Time until loop() publishes
+     * @return milliseconds, 0 if due now, DEVICE_LOOP_IDLE if nothing is marked
+     */
+    uint32_t getNextDeadline() const;
+
+    /**
+     * @brief Publish the delta once the push window has closed, then send the requested snapshots
+     */
+    void loop();
+
+    /**
+     * @brief Number of snapshot renders, for diagnostics and benchmarks
+     */
+    uint32_t getRenderCount() const {
+        return _renderCount;
+    }
+
+private:
+    state_snapshot_field_t _fields[STATE_SNAPSHOT_MAX_FIELDS]{};
+    uint8_t _fieldCount = 0;
+    char _buffer[STATE_SNAPSHOT_BUFFER_SIZE]{};
+    char _delta[STATE_SNAPSHOT_BUFFER_SIZE]{};
+    size_t _length = 0;
+    uint32_t _mask = 0;
+    uint32_t _renderedSeq = 0;
+    bool _valid = false;
+    uint32_t _renderCount = 0;
+
+    uint32_t _seq = 0;
+    uint32_t _publishedMask = 0;
+    bool _published = false;
+    bool _marked = false;
+    uint32_t _markedAt = 0;
+    state_publish_cb_t _onPublish = nullptr;
+
+    state_snapshot_cb_t _onSnapshot = nullptr;
+    uint32_t _pending[STATE_SNAPSHOT_MAX_PENDING]{};
+    uint8_t _pendingCount = 0;
+    bool _pendingAll = false;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portMUX_TYPE _pendingMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    uint32_t _poll() const;
+
+    size_t _render(char *buffer, char tag, uint32_t mask, uint32_t fields) const;
+
+    void _sendPending();
+};
+
+
+#endif //SMART_GARDEN_STATESNAPSHOT_H
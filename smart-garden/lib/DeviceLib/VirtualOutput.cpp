@@ -9,10 +9,12 @@ void VirtualOutput::on(bool force) {
     if (_pOnDelay > 0 && _pState != stdGenericOutput::ON) {
         _previousMillis = millis();
         _pState = stdGenericOutput::WAIT_FOR_ON;
+        DeviceLoop::notify();
         return;
     }
     _pState = stdGenericOutput::ON;
     _previousMillis = millis();
+    DeviceLoop::notify();
 
     if (!force && _state) return;
     _state = true;
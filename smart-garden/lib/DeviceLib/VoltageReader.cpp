@@ -20,28 +20,179 @@ void VoltageReader::setSafeThreshold(float min, float max) {
     this->maxVolt = max;
 }
 
+bool VoltageReader::setCalibration(const voltage_cal_point_t *points, uint8_t count) {
+    if (count > VOLTAGE_READER_MAX_CAL_POINTS) return false;
+    for (uint8_t i = 1; i < count; i++) {
+        if (points[i].measured <= points[i - 1].measured) return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        _calibration[i] = points[i];
+    }
+    _calibrationCount = count;
+    return true;
+}
+
 float VoltageReader::get() {
-    return lastVolt;
+    return _filtered;
+}
+
+float VoltageReader::_calibrate(float v) const {
+    if (_calibrationCount == 0) return v;
+    if (_calibrationCount == 1) return v + _calibration[0].actual - _calibration[0].measured;
+
+    // Segment containing v, the first / last one extrapolates
+    uint8_t i = 1;
+    while (i < _calibrationCount - 1 && v > _calibration[i].measured) i++;
+    const voltage_cal_point_t &a = _calibration[i - 1];
+    const voltage_cal_point_t &b = _calibration[i];
+    return a.actual + (v - a.measured) * (b.actual - a.actual) / (b.measured - a.measured);
 }
 
 float VoltageReader::_read() {
-    float v = analogRead(pin) / 4095.0 * 3.3;
+    // Oversample and keep the median to reject ADC spikes
+    uint16_t samples[VOLTAGE_READER_OVERSAMPLE];
+    for (uint8_t i = 0; i < VOLTAGE_READER_OVERSAMPLE; i++) {
+#if defined(ESP32)
+        // Corrected with the eFuse calibration of the chip
+        uint16_t mv = analogReadMilliVolts(pin);
+#else
+        uint16_t mv = analogRead(pin) * 3300UL / 4095;
+#endif
+        uint8_t j = i;
+        while (j > 0 && samples[j - 1] > mv) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = mv;
+    }
+    const uint8_t mid = VOLTAGE_READER_OVERSAMPLE / 2;
+    float v = (VOLTAGE_READER_OVERSAMPLE % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0f) / 1000.0f;
     if (R1 > 0 && R2 > 0) {
-        return v * (R1 + R2) / R2;
+        v = v * (R1 + R2) / R2;
+    }
+    return _calibrate(v);
+}
+
+void VoltageReader::_updateAlarm(float v) {
+    voltage_alarm_t alarm = _alarm;
+    if (_alarm == VOLTAGE_LOW) {
+        if (minVolt <= 0 || v > minVolt + hysteresis) alarm = VOLTAGE_NORMAL;
+    } else if (_alarm == VOLTAGE_HIGH) {
+        if (maxVolt <= 0 || v < maxVolt - hysteresis) alarm = VOLTAGE_NORMAL;
+    } else if (minVolt > 0 && v < minVolt) {
+        alarm = VOLTAGE_LOW;
+    } else if (maxVolt > 0 && v > maxVolt) {
+        alarm = VOLTAGE_HIGH;
+    }
+    if (alarm == _alarm) return;
+
+    _alarm = alarm;
+    if (alarm == VOLTAGE_LOW && _onLow != nullptr) {
+        _onLow();
+    } else if (alarm == VOLTAGE_HIGH && _onHigh != nullptr) {
+        _onHigh();
+    }
+    if (alarm != VOLTAGE_NORMAL && _onUnsafe != nullptr) {
+        _onUnsafe();
+    }
+}
+
+stats_bucket_t VoltageReader::getStats(voltage_window_t window) const {
+    stats_bucket_t out;
+    switch (window) {
+        case VOLTAGE_WINDOW_24H:
+            out = _dayWindow.get();
+            out.merge(_hourBucket);
+            out.merge(_minuteBucket);
+            break;
+        case VOLTAGE_WINDOW_1H:
+            out = _hourWindow.get();
+            out.merge(_minuteBucket);
+            break;
+        default:
+            out = _minuteWindow.get();
+            break;
     }
-    return v;
+    out.merge(_secondBucket);
+    return out;
+}
+
+void VoltageReader::_closeSecond(const stats_bucket_t &bucket) {
+    _minuteWindow.push(bucket);
+    _minuteBucket.merge(bucket);
+    if (++_secondsInMinute < 60) return;
+
+    _secondsInMinute = 0;
+    _hourWindow.push(_minuteBucket);
+    _hourBucket.merge(_minuteBucket);
+    _minuteBucket.clear();
+    if (++_minutesInHour < 60) return;
+
+    _minutesInHour = 0;
+    _dayWindow.push(_hourBucket);
+    _hourBucket.clear();
+}
+
+uint16_t VoltageReader::copySamples(voltage_sample_t *out) const {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portENTER_CRITICAL(&_sampleMux);
+#endif
+    uint16_t count = _sampleCount;
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = getSample(i);
+    }
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portEXIT_CRITICAL(&_sampleMux);
+#endif
+    return count;
+}
+
+void VoltageReader::_record(float v, uint32_t now) {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portENTER_CRITICAL(&_sampleMux);
+#endif
+    _samples[_sampleHead] = {now, v};
+    _sampleHead = (_sampleHead + 1) % VOLTAGE_READER_SAMPLE_RING;
+    if (_sampleCount < VOLTAGE_READER_SAMPLE_RING) _sampleCount++;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    portEXIT_CRITICAL(&_sampleMux);
+#endif
+
+    uint32_t second = now / 1000;
+    if (_secondBucket.count && second != _currentSecond) {
+        stats_bucket_t closed = _secondBucket;
+        _secondBucket.clear();
+        _closeSecond(closed);
+        // Seconds without a reading keep their slot so the windows stay aligned to time
+        stats_bucket_t empty{};
+        uint32_t gap = second - _currentSecond - 1;
+        for (uint32_t i = 0; i < gap && i < 86400UL; i++) {
+            _closeSecond(empty);
+        }
+        if (_onSecond != nullptr) {
+            _onSecond(closed);
+        }
+    }
+    _currentSecond = second;
+    _secondBucket.add(v);
 }
 
 void VoltageReader::loop() {
     float v = _read();
-    if (abs(v - lastVolt) > changeThreshold) {
-        lastVolt = v;
-        if (minVolt > 0 && v < minVolt && _onLow != nullptr) {
-            _onLow();
-        } else if (maxVolt > 0 && v > maxVolt && _onHigh != nullptr) {
-            _onHigh();
-        } else if (_onChanged != nullptr) {
+    _record(v, millis());
+    _filtered = _hasReading ? _filtered + filterAlpha * (v - _filtered) : v;
+    _hasReading = true;
+
+    _updateAlarm(_filtered);
+
+    if (fabsf(_filtered - lastVolt) > changeThreshold) {
+        uint32_t now = millis();
+        if (_changeReported && now - _lastCallbackTime < minCallbackInterval) return;
+        _changeReported = true;
+        _lastCallbackTime = now;
+        lastVolt = _filtered;
+        if (_onChanged != nullptr) {
             _onChanged();
         }
     }
-}
\ No newline at end of file
+}
@@ -6,6 +6,43 @@
 #define SMART_GARDEN_VOLTAGEREADER_H
 
 #include <Arduino.h>
+#include "RollingStats.h"
+
+// ADC samples taken per loop(), the median of them is fed to the EMA filter
+#ifndef VOLTAGE_READER_OVERSAMPLE
+#define VOLTAGE_READER_OVERSAMPLE 16
+#endif
+
+#ifndef VOLTAGE_READER_MAX_CAL_POINTS
+#define VOLTAGE_READER_MAX_CAL_POINTS 8
+#endif
+
+// Raw readings kept for streaming, one per loop()
+#ifndef VOLTAGE_READER_SAMPLE_RING
+#define VOLTAGE_READER_SAMPLE_RING 120
+#endif
+
+struct voltage_sample_t {
+    uint32_t time; // millis()
+    float volt;
+};
+
+typedef enum {
+    VOLTAGE_WINDOW_1M = 0, // 1 s buckets
+    VOLTAGE_WINDOW_1H = 1, // 1 min buckets
+    VOLTAGE_WINDOW_24H = 2, // 1 h buckets
+} voltage_window_t;
+
+struct voltage_cal_point_t {
+    float measured; // voltage computed from the ADC
+    float actual;   // voltage measured with a meter
+};
+
+typedef enum {
+    VOLTAGE_NORMAL = 0,
+    VOLTAGE_LOW = 1,
+    VOLTAGE_HIGH = 2,
+} voltage_alarm_t;
 
 class VoltageReader {
 public:
@@ -15,13 +52,79 @@ public:
     float changeThreshold = 0.1;
     float minVolt = -1;
     float maxVolt = -1;
-    float lastVolt = 0;
+    float lastVolt = 0; // last value reported to onChanged
+
+    // Margin to cross back over minVolt / maxVolt before the alarm clears
+    float hysteresis = 0.2;
+    // Weight of a new reading in the exponential moving average (0 - 1]
+    float filterAlpha = 0.3;
+    // Minimum time between two onChanged callbacks in milliseconds
+    uint32_t minCallbackInterval = 5000;
 
     VoltageReader(uint8_t pin, float r1 = 0, float r2 = 0, float changeThreshold = 0.1, float minVolt = -1, float maxVolt = -1);
     void setSafeThreshold(float min, float max);
+
+    /**
+     * @brief Correct the divider and ADC error with a piecewise linear table.
+     * Points are sorted by measured value, outside the table the end segments are extrapolated.
+     * A single point applies an offset. Pass count 0 to remove the calibration
+     * @param points pairs of {measured, actual}
+     * @param count number of points, up to VOLTAGE_READER_MAX_CAL_POINTS
+     * @return false if the table does not fit or is not sorted
+     */
+    bool setCalibration(const voltage_cal_point_t *points, uint8_t count);
+
+    /**
+     * @brief Filtered voltage
+     */
     float get();
+
+    /**
+     * @brief Current alarm state, with hysteresis applied
+     */
+    voltage_alarm_t getAlarm() const {
+        return _alarm;
+    }
+
+    /**
+     * @brief Min / avg / max of the readings over a rolling window.
+     * The window holds the last complete buckets (60 s, 60 min or 24 h) plus the current partial one
+     * @param window
+     */
+    stats_bucket_t getStats(voltage_window_t window) const;
+
+    /**
+     * @brief Number of readings in the sample ring
+     */
+    uint16_t getSampleCount() const {
+        return _sampleCount;
+    }
+
+    /**
+     * @brief Reading from the sample ring
+     * @param index 0 is the oldest
+     */
+    voltage_sample_t getSample(uint16_t index) const {
+        return _samples[(_sampleHead + VOLTAGE_READER_SAMPLE_RING - _sampleCount + index) % VOLTAGE_READER_SAMPLE_RING];
+    }
+
+    /**
+     * @brief Copy the sample ring in one consistent pass, safe to call from another task (web server)
+     * @param out at least VOLTAGE_READER_SAMPLE_RING samples, oldest first
+     * @return number of samples copied
+     */
+    uint16_t copySamples(voltage_sample_t *out) const;
+
     void loop();
 
+    /**
+     * @brief Called with every completed 1 s bucket, e.g. to stream the readings
+     * @param callback
+     */
+    void onSecond(std::function<void(const stats_bucket_t &)> callback) {
+        _onSecond = std::move(callback);
+    }
+
     void onChanged(std::function<void()> callback) {
         _onChanged = callback;
     }
@@ -42,7 +145,41 @@ private:
     std::function<void()> _onUnsafe = nullptr;
     std::function<void()> _onLow = nullptr;
     std::function<void()> _onHigh = nullptr;
+
+    voltage_cal_point_t _calibration[VOLTAGE_READER_MAX_CAL_POINTS]{};
+    uint8_t _calibrationCount = 0;
+
+    float _filtered = 0;
+    bool _hasReading = false;
+    voltage_alarm_t _alarm = VOLTAGE_NORMAL;
+    uint32_t _lastCallbackTime = 0;
+    bool _changeReported = false;
+
+    std::function<void(const stats_bucket_t &)> _onSecond = nullptr;
+
+    voltage_sample_t _samples[VOLTAGE_READER_SAMPLE_RING]{};
+    uint16_t _sampleHead = 0;
+    uint16_t _sampleCount = 0;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    mutable portMUX_TYPE _sampleMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    // 1 s buckets cascade into 1 min and 1 h buckets
+    RollingWindow<60> _minuteWindow;
+    RollingWindow<60> _hourWindow;
+    RollingWindow<24> _dayWindow;
+    stats_bucket_t _secondBucket{};
+    stats_bucket_t _minuteBucket{};
+    stats_bucket_t _hourBucket{};
+    uint32_t _currentSecond = 0;
+    uint8_t _secondsInMinute = 0;
+    uint8_t _minutesInHour = 0;
+
     float _read();
+    float _calibrate(float v) const;
+    void _updateAlarm(float v);
+    void _record(float v, uint32_t now);
+    void _closeSecond(const stats_bucket_t &bucket);
 };
 
 
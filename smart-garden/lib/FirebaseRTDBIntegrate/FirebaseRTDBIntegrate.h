@@ -4,11 +4,15 @@
 #include <Arduino.h>
 #include <FirebaseClient.h>
 
+class StateReporter;
+
 typedef struct
 {
     AsyncClientClass *client;
     RealtimeDatabase *rtdb;
     String prefixPath;
+    StateReporter *reporter; // batches the device states under prefixPath, nullptr to set each path
+
 
 } fbrtdb_object;
 
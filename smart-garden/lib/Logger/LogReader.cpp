@@ -0,0 +1,218 @@
+//
+// Streams filtered log lines from the log segments with a fixed buffer
+//
+
+#include "LogReader.h"
+
+#define LOG_DATA_START sizeof(log_segment_header_t)
+
+static uint32_t readTime(const uint8_t *record) {
+    return (uint32_t) record[0] | (uint32_t) record[1] << 8 | (uint32_t) record[2] << 16 |
+           (uint32_t) record[3] << 24;
+}
+
+LogReader::LogReader(fs::FS &fs, std::vector<String> paths, const log_query_t &query)
+        : _fs(&fs), _paths(std::move(paths)), _query(query) {
+    if (!_open()) {
+        _done = true;
+    }
+}
+
+bool LogReader::_open() {
+    if (_file) _file.close();
+    while (_next < _paths.size()) {
+        _file = _fs->open(_paths[_next++], "r");
+        if (!_file) continue; // removed in between
+        size_t size = _file.size();
+        if (_file.read((uint8_t *) &_header, sizeof(_header)) != sizeof(_header) ||
+            _header.magic != LOG_SEGMENT_MAGIC) {
+            _file.close();
+            continue;
+        }
+        // Ignore an interrupted write past the size in the header
+        if (_header.size > size - LOG_DATA_START) {
+            _header.size = size - LOG_DATA_START;
+        }
+        _end = LOG_DATA_START + _header.size;
+        _blockOffset = 0;
+        _blockLen = 0;
+        _dictionary.clear();
+        if (_query.raw) {
+            _pos = 0;
+        } else if (_query.reverse) {
+            _loadDictionary();
+            _pos = _end;
+        } else {
+            _pos = LOG_DATA_START;
+        }
+        return true;
+    }
+    return false;
+}
+
+const uint8_t *LogReader::_at(size_t offset, size_t length, bool backward) {
+    if (offset >= _blockOffset && offset + length <= _blockOffset + _blockLen) {
+        return _block + (offset - _blockOffset);
+    }
+    size_t begin = offset;
+    if (backward) {
+        size_t end = offset + length;
+        begin = end > LOG_DATA_START + sizeof(_block) ? end - sizeof(_block) : LOG_DATA_START;
+    }
+    size_t n = begin < _end ? _end - begin : 0;
+    if (n > sizeof(_block)) n = sizeof(_block);
+    _file.seek(begin);
+    _blockOffset = begin;
+    _blockLen = _file.read(_block, n);
+    if (offset + length > _blockOffset + _blockLen) {
+        return nullptr;
+    }
+    return _block + (offset - _blockOffset);
+}
+
+void LogReader::_loadDictionary() {
+    size_t pos = LOG_DATA_START;
+    while (pos + LOG_RECORD_SIZE(0) <= _end) {
+        const uint8_t *record = _at(pos, LOG_RECORD_HEADER_SIZE, false);
+        if (record == nullptr || record[6] > LOG_PAYLOAD_MAX) break;
+        uint8_t length = record[6];
+        if (record[4] == LOG_RECORD_DEFINE) {
+            record = _at(pos, LOG_RECORD_SIZE(length), false);
+            if (record == nullptr) break;
+            _dictionary.set(record[5], (const char *) record + LOG_RECORD_HEADER_SIZE, length);
+        }
+        pos += LOG_RECORD_SIZE(length);
+    }
+}
+
+const uint8_t *LogReader::_nextRecord() {
+    while (true) {
+        const uint8_t *record = nullptr;
+        size_t size = 0;
+        if (!_query.reverse) {
+            if (_pos + LOG_RECORD_SIZE(0) <= _end) {
+                record = _at(_pos, LOG_RECORD_HEADER_SIZE, false);
+                if (record != nullptr && record[6] <= LOG_PAYLOAD_MAX) {
+                    uint8_t length = record[6];
+                    size = LOG_RECORD_SIZE(length);
+                    record = _at(_pos, size, false);
+                    if (record != nullptr && record[size - 1] != length) record = nullptr;
+                } else {
+                    record = nullptr;
+                }
+            }
+            if (record != nullptr) {
+                _pos += size;
+                return record;
+            }
+        } else {
+            if (_pos >= LOG_DATA_START + LOG_RECORD_SIZE(0)) {
+                record = _at(_pos - 1, 1, true);
+                if (record != nullptr && *record <= LOG_PAYLOAD_MAX &&
+                    (size_t) LOG_RECORD_SIZE(*record) <= _pos - LOG_DATA_START) {
+                    uint8_t length = *record;
+                    size = LOG_RECORD_SIZE(length);
+                    record = _at(_pos - size, size, true);
+                    if (record != nullptr && record[6] != length) record = nullptr;
+                } else {
+                    record = nullptr;
+                }
+            }
+            if (record != nullptr) {
+                _pos -= size;
+                return record;
+            }
+        }
+        // End of the segment, or a damaged record
+        if (!_open()) return nullptr;
+    }
+}
+
+bool LogReader::_nextMatch() {
+    if (_done || (_query.limit && _count >= _query.limit)) return false;
+    const uint8_t *record;
+    while ((record = _nextRecord()) != nullptr) {
+        uint32_t time = readTime(record);
+        uint8_t event = record[4];
+        uint8_t source = record[5];
+        uint8_t length = record[6];
+        const char *payload = (const char *) record + LOG_RECORD_HEADER_SIZE;
+
+        if (event == LOG_RECORD_DEFINE) {
+            // Loaded up front when reading from the end
+            if (!_query.reverse) _dictionary.set(source, payload, length);
+            continue;
+        }
+
+        if (!_query.reverse && time > _query.to) {
+            if (time - _query.to > LOG_READER_ORDER_SLACK) break;
+            continue;
+        }
+        if (_query.reverse && time < _query.from) {
+            if (_query.from - time > LOG_READER_ORDER_SLACK) break;
+            continue;
+        }
+        if (time < _query.from || time > _query.to) continue;
+
+        // "<epoch> <event>-<source>-<message>", or "<epoch> <message>" for a plain one
+        int n = snprintf(_line, sizeof(_line), "%lu ", (unsigned long) time);
+        if (event != LOG_RECORD_NONE) {
+            n += snprintf(_line + n, sizeof(_line) - n, "%s-%s-", _dictionary.name(event),
+                          source == LOG_RECORD_NONE ? "" : _dictionary.name(source));
+        }
+        memcpy(_line + n, payload, length);
+        _lineLen = n + length;
+        _line[_lineLen++] = '\n';
+        _lineSent = 0;
+        _count++;
+        return true;
+    }
+    close();
+    return false;
+}
+
+size_t LogReader::_readRaw(uint8_t *buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen && !_done) {
+        if (_pos >= _end) {
+            if (!_open()) {
+                close();
+                break;
+            }
+            continue;
+        }
+        size_t n = _end - _pos;
+        if (n > maxLen - written) n = maxLen - written;
+        if (_pos < LOG_DATA_START) {
+            // Header with the size actually sent
+            if (n > LOG_DATA_START - _pos) n = LOG_DATA_START - _pos;
+            memcpy(buffer + written, (const uint8_t *) &_header + _pos, n);
+        } else {
+            _file.seek(_pos);
+            n = _file.read(buffer + written, n);
+            if (n == 0) {
+                _pos = _end;
+                continue;
+            }
+        }
+        _pos += n;
+        written += n;
+    }
+    return written;
+}
+
+size_t LogReader::read(uint8_t *buffer, size_t maxLen) {
+    if (_query.raw) {
+        return _readRaw(buffer, maxLen);
+    }
+    size_t written = 0;
+    while (written < maxLen) {
+        if (_lineSent >= _lineLen && !_nextMatch()) break;
+        size_t n = _lineLen - _lineSent;
+        if (n > maxLen - written) n = maxLen - written;
+        memcpy(buffer + written, _line + _lineSent, n);
+        _lineSent += n;
+        written += n;
+    }
+    return written;
+}
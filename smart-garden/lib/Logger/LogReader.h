@@ -0,0 +1,135 @@
+//
+// Streams filtered log lines from the log segments with a fixed buffer
+//
+
+#ifndef SMART_GARDEN_LOGREADER_H
+#define SMART_GARDEN_LOGREADER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+#include "LogRecord.h"
+
+// Longest line returned: "<epoch> <event>-<source>-<message>"
+#define LOG_READER_LINE_MAX (11 + 2 * (LOG_NAME_MAX + 1) + LOG_PAYLOAD_MAX)
+
+// File read size
+#ifndef LOG_READER_BLOCK_SIZE
+#define LOG_READER_BLOCK_SIZE 256
+#endif
+
+#if LOG_READER_BLOCK_SIZE < LOG_RECORD_SIZE_MAX
+#error "LOG_READER_BLOCK_SIZE must hold a whole record"
+#endif
+
+// Records are appended in time order, except for the ones queued before the clock was set. Scanning stops
+// once a record is this far past the requested range (seconds)
+#ifndef LOG_READER_ORDER_SLACK
+#define LOG_READER_ORDER_SLACK 3600
+#endif
+
+struct log_query_t {
+    uint32_t from = 0;          // epoch, inclusive
+    uint32_t to = 0xFFFFFFFF;   // epoch, inclusive
+    uint32_t limit = 0;         // lines, 0 for all
+    bool reverse = false;       // newest first
+    bool raw = false;           // segments as stored (header + records) for log_decode.py, oldest first
+};
+
+/**
+ * @brief Decodes the records matching a query into "<epoch> <event>-<source>-<message>" lines, forward
+ * or from the end.
+ *
+ * The segment files are read one after another in the given order. read() fills the caller's buffer
+ * (e.g. an AsyncWebServer chunk) with whole lines and carries a line that does not fit over to the next
+ * call, so memory use does not depend on the log size.
+ */
+class LogReader {
+public:
+    /**
+     * @param fs
+     * @param paths segment files in reading order: oldest first, or newest first for a reverse query
+     * @param query
+     */
+    LogReader(fs::FS &fs, std::vector<String> paths, const log_query_t &query);
+
+    ~LogReader() {
+        close();
+    }
+
+    /**
+     * @brief Copy the next matching lines, '\n' terminated (raw query: the next segment bytes)
+     * @param buffer
+     * @param maxLen
+     * @return bytes written, 0 when done
+     */
+    size_t read(uint8_t *buffer, size_t maxLen);
+
+    /**
+     * @brief Number of lines returned so far
+     */
+    uint32_t getCount() const {
+        return _count;
+    }
+
+    void close() {
+        if (_file) _file.close();
+        _done = true;
+    }
+
+private:
+    fs::FS *_fs;
+    std::vector<String> _paths;
+    size_t _next = 0;       // next file to open
+    File _file;
+    log_query_t _query;
+    log_segment_header_t _header{};
+    LogDictionary _dictionary;
+    size_t _pos = 0;        // next record (forward), end of the part not read yet (reverse)
+    size_t _end = 0;        // end of the records in the file
+    uint8_t _block[LOG_READER_BLOCK_SIZE]{};
+    size_t _blockOffset = 0;
+    size_t _blockLen = 0;
+    char _line[LOG_READER_LINE_MAX + 2]{}; // line being returned, with its '\n'
+    size_t _lineLen = 0;
+    size_t _lineSent = 0;
+    uint32_t _count = 0;
+    bool _done = false;
+
+    /**
+     * @brief Open the next segment of the list
+     * @return false when there is none left
+     */
+    bool _open();
+
+    /**
+     * @brief Bytes of the file, through the block buffer
+     * @param offset
+     * @param length at most LOG_READER_BLOCK_SIZE
+     * @param backward fill the buffer with the bytes before `offset` rather than after
+     * @return nullptr past the end
+     */
+    const uint8_t *_at(size_t offset, size_t length, bool backward);
+
+    /**
+     * @brief Load the names of the segment before reading it from its end
+     */
+    void _loadDictionary();
+
+    /**
+     * @brief Next record in reading order, across segments. A damaged record ends its segment
+     * @return nullptr at the end of the last segment
+     */
+    const uint8_t *_nextRecord();
+
+    /**
+     * @brief Find the next record in range and render it
+     * @return false at the end of the segments, the range or the limit
+     */
+    bool _nextMatch();
+
+    size_t _readRaw(uint8_t *buffer, size_t maxLen);
+};
+
+
+#endif //SMART_GARDEN_LOGREADER_H
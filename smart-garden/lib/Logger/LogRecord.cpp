@@ -0,0 +1,57 @@
+//
+// Binary log record format, shared by Logger (writer), LogReader and log_decode.py
+//
+
+#include "LogRecord.h"
+
+uint8_t LogDictionary::find(const char *name, size_t length) const {
+    if (length > LOG_NAME_MAX) length = LOG_NAME_MAX;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (strncmp(_names[i], name, length) == 0 && _names[i][length] == '\0') {
+            return i + 1;
+        }
+    }
+    return LOG_RECORD_NONE;
+}
+
+uint8_t LogDictionary::add(const char *name, size_t length) {
+    if (full()) {
+        return LOG_RECORD_NONE;
+    }
+    set(_count + 1, name, length);
+    return _count;
+}
+
+void LogDictionary::set(uint8_t id, const char *name, size_t length) {
+    if (id == LOG_RECORD_NONE || id > LOG_DICTIONARY_SIZE) {
+        return;
+    }
+    if (length > LOG_NAME_MAX) length = LOG_NAME_MAX;
+    memcpy(_names[id - 1], name, length);
+    _names[id - 1][length] = '\0';
+    if (id > _count) {
+        _count = id;
+    }
+}
+
+const char *LogDictionary::name(uint8_t id) const {
+    if (id == LOG_RECORD_NONE || id > _count) {
+        return "?";
+    }
+    return _names[id - 1];
+}
+
+size_t logRecordEncode(uint8_t *out, uint32_t time, uint8_t event, uint8_t source, const char *payload,
+                       size_t length) {
+    if (length > LOG_PAYLOAD_MAX) length = LOG_PAYLOAD_MAX;
+    out[0] = time;
+    out[1] = time >> 8;
+    out[2] = time >> 16;
+    out[3] = time >> 24;
+    out[4] = event;
+    out[5] = source;
+    out[6] = length;
+    memcpy(out + LOG_RECORD_HEADER_SIZE, payload, length);
+    out[LOG_RECORD_HEADER_SIZE + length] = length;
+    return LOG_RECORD_SIZE(length);
+}
@@ -0,0 +1,113 @@
+//
+// Binary log record format, shared by Logger (writer), LogReader and log_decode.py
+//
+
+#ifndef SMART_GARDEN_LOGRECORD_H
+#define SMART_GARDEN_LOGRECORD_H
+
+#include <Arduino.h>
+
+// Event / source names per segment, ids 1..LOG_DICTIONARY_SIZE
+#ifndef LOG_DICTIONARY_SIZE
+#define LOG_DICTIONARY_SIZE 32
+#endif
+
+// Longest event / source name, longer ones are cut
+#ifndef LOG_NAME_MAX
+#define LOG_NAME_MAX 23
+#endif
+
+// Longest message, longer ones are cut
+#ifndef LOG_PAYLOAD_MAX
+#define LOG_PAYLOAD_MAX 128
+#endif
+
+#define LOG_SEGMENT_MAGIC 0x32474C53 // "SLG2"
+
+// Event id of a record that defines the name of id `source` (payload) for the rest of its segment
+#define LOG_RECORD_DEFINE 0xFF
+// Event / source id of a plain message
+#define LOG_RECORD_NONE 0
+
+// time (4), event (1), source (1), length (1)
+#define LOG_RECORD_HEADER_SIZE 7
+// Payload length again after the payload, so a segment can be read from its end
+#define LOG_RECORD_SIZE(length) (LOG_RECORD_HEADER_SIZE + (length) + 1)
+#define LOG_RECORD_SIZE_MAX LOG_RECORD_SIZE(LOG_PAYLOAD_MAX)
+
+/**
+ * @brief Start of each segment file, followed by `size` bytes of records. Little endian.
+ */
+struct log_segment_header_t {
+    uint32_t magic;
+    uint32_t seq;       // increases with each new segment, 0 for a free slot
+    uint32_t firstTime; // oldest record (epoch)
+    uint32_t lastTime;  // newest record (epoch)
+    uint32_t lines;     // records, definitions excluded
+    uint32_t size;      // bytes of records; anything past it is an interrupted write
+};
+
+/**
+ * @brief Names interned in a segment. Each segment starts with an empty dictionary, so dropping the
+ * oldest segment never loses a definition the others need.
+ */
+class LogDictionary {
+public:
+    /**
+     * @brief Find a name
+     * @param name
+     * @param length
+     * @return id, LOG_RECORD_NONE if not defined
+     */
+    uint8_t find(const char *name, size_t length) const;
+
+    /**
+     * @brief Define the next id
+     * @param name
+     * @param length cut to LOG_NAME_MAX
+     * @return id, LOG_RECORD_NONE if the dictionary is full
+     */
+    uint8_t add(const char *name, size_t length);
+
+    /**
+     * @brief Set the name of an id read from a definition record
+     */
+    void set(uint8_t id, const char *name, size_t length);
+
+    /**
+     * @return name, "?" for an unknown id
+     */
+    const char *name(uint8_t id) const;
+
+    uint8_t size() const {
+        return _count;
+    }
+
+    bool full() const {
+        return _count >= LOG_DICTIONARY_SIZE;
+    }
+
+    void clear() {
+        _count = 0;
+    }
+
+private:
+    uint8_t _count = 0;
+    char _names[LOG_DICTIONARY_SIZE][LOG_NAME_MAX + 1]{};
+};
+
+/**
+ * @brief Encode a record
+ * @param out at least LOG_RECORD_SIZE(length) bytes
+ * @param time epoch
+ * @param event id, or LOG_RECORD_DEFINE
+ * @param source id
+ * @param payload
+ * @param length cut to LOG_PAYLOAD_MAX
+ * @return bytes written
+ */
+size_t logRecordEncode(uint8_t *out, uint32_t time, uint8_t event, uint8_t source, const char *payload,
+                       size_t length);
+
+
+#endif //SMART_GARDEN_LOGRECORD_H
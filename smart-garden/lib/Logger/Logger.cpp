@@ -4,127 +4,419 @@
 
 #include "Logger.h"
 
+#include <algorithm>
 #include <utility>
 
+#define LOG_SEGMENT_DATA_SIZE (LOG_SEGMENT_SIZE - sizeof(log_segment_header_t))
+
+/**
+ * Holds the logger state for the scope, it is shared by the loop task and the web server
+ */
+class LogLock {
+public:
+    explicit LogLock(Logger &logger) : _logger(logger) {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+        xSemaphoreTakeRecursive(_logger._mutex, portMAX_DELAY);
+#endif
+    }
+
+    ~LogLock() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+        xSemaphoreGiveRecursive(_logger._mutex);
+#endif
+    }
+
+private:
+    Logger &_logger;
+};
+
 Logger::Logger() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    _mutex = xSemaphoreCreateRecursiveMutex();
+#endif
     LOG_FS.begin();
+}
 
-    if (!LOG_FS.exists(filePath)) {
+Logger::~Logger() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    vSemaphoreDelete(_mutex);
+#endif
+}
+
+String Logger::getSegmentPath(uint8_t index) const {
+    int dot = filePath.lastIndexOf('.');
+    String base = dot > 0 ? filePath.substring(0, dot) : filePath;
+    return base + "_" + String(index) + ".seg";
+}
+
+void Logger::_createSegment(uint8_t index, uint32_t seq) {
+    log_segment_header_t &header = _segments[index];
+    header = log_segment_header_t();
+    header.magic = LOG_SEGMENT_MAGIC;
+    header.seq = seq;
+
+    // "w" truncates the oldest segment being reused
 #if defined(ESP8266)
-        File file = LOG_FS.open(filePath, "w");
-        file.close();
+    File file = LOG_FS.open(getSegmentPath(index), "w");
 #elif defined(ESP32)
-        File file = LOG_FS.open(filePath, FILE_WRITE, true);
-        file.close();
+    File file = LOG_FS.open(getSegmentPath(index), "w", true);
 #endif
+    if (file) {
+        file.write((const uint8_t *) &header, sizeof(header));
+        file.close();
     }
+    _active = index;
+    _activeSize = 0;
+    _dictionary.clear();
 }
 
-bool Logger::_log(const String &message) {
-    if (time(nullptr) <= 1609459200) {
-        // Time is not set (2021-01-01)
-
-        log_queue_item item;
-        item.millis = millis();
-        item.message = message;
-        _log_queue.push_back(item);
+bool Logger::_begin() {
+    if (_ready) {
         return true;
     }
+    _ready = true;
 
-    File file = LOG_FS.open(filePath, "a");
-    if (!file || file.name() == nullptr) {
-        return false;
+    uint32_t newest = 0;
+    for (uint8_t i = 0; i < LOG_SEGMENT_COUNT; i++) {
+        log_segment_header_t &header = _segments[i];
+        header = log_segment_header_t();
+        File file = LOG_FS.open(getSegmentPath(i), "r");
+        if (!file) {
+            continue;
+        }
+        size_t size = file.size();
+        if (file.read((uint8_t *) &header, sizeof(header)) != sizeof(header) || header.magic != LOG_SEGMENT_MAGIC ||
+            header.seq % LOG_SEGMENT_COUNT != i || header.size > size - sizeof(header)) {
+            header = log_segment_header_t();
+        } else if (header.seq > newest) {
+            newest = header.seq;
+            _active = i;
+            // Bytes past header.size (interrupted write) get overwritten
+            _activeSize = header.size;
+        }
+        file.close();
     }
-    time_t now;
-    time(&now);
-    file.printf("%ld %s\n", now, message.c_str());
-    file.close();
+    if (!newest) {
+        _createSegment(0, LOG_SEGMENT_COUNT); // seq of slot 0
+    } else {
+        _loadDictionary();
+    }
+
+    _importLegacy();
     return true;
 }
 
-
-void Logger::clearOldLogs() {
+void Logger::_importLegacy() {
     if (!LOG_FS.exists(filePath)) {
         return;
     }
-
     File file = LOG_FS.open(filePath, "r");
     if (!file || file.name() == nullptr) {
         return;
     }
-
-    time_t now;
-    time(&now);
-    uint32_t minTime = now - _maxLogTime * 24 * 3600;
-
-#if defined(ESP8266)
-    File tempFile = LOG_FS.open("/temp_log.txt", "w");
-#elif defined(ESP32)
-    File tempFile = LOG_FS.open("/temp_log.txt", "w", true);
-#endif
-    if (!tempFile) {
-        return;
-    }
-
     while (file.available()) {
         String line = file.readStringUntil('\n');
-        if (line.length() < 10) { // invalid time
-            continue;
-        }
         int index = line.indexOf(' ');
         if (index < 10) { // invalid time
             continue;
         }
+        line.trim();
+        _append(line.substring(0, index).toInt(), nullptr, nullptr, line.c_str() + index + 1,
+                line.length() - index - 1);
+    }
+    file.close();
+    flush();
+    LOG_FS.remove(filePath);
+}
 
-        uint32_t time = line.substring(0, index).toInt();
-        if (time >= minTime) {
-            line.trim();
-            tempFile.println(line);
+void Logger::_loadDictionary() {
+    _dictionary.clear();
+    File file = LOG_FS.open(getSegmentPath(_active), "r");
+    if (!file) {
+        return;
+    }
+    size_t pos = sizeof(log_segment_header_t);
+    size_t end = pos + _activeSize;
+    uint8_t record[LOG_RECORD_SIZE_MAX];
+    while (pos + LOG_RECORD_SIZE(0) <= end) {
+        file.seek(pos);
+        if (file.read(record, LOG_RECORD_HEADER_SIZE) != LOG_RECORD_HEADER_SIZE || record[6] > LOG_PAYLOAD_MAX) {
+            break;
+        }
+        uint8_t length = record[6];
+        if (record[4] == LOG_RECORD_DEFINE) {
+            file.read(record + LOG_RECORD_HEADER_SIZE, length);
+            _dictionary.set(record[5], (const char *) record + LOG_RECORD_HEADER_SIZE, length);
         }
+        pos += LOG_RECORD_SIZE(length);
+    }
+    file.close();
+}
+
+/**
+ * Bytes of the definition record a name needs in the active segment, 0 if it has an id already
+ */
+static size_t defineSize(const LogDictionary &dictionary, const char *name) {
+    if (name == nullptr || !*name) {
+        return 0;
+    }
+    size_t length = strlen(name);
+    if (dictionary.find(name, length) != LOG_RECORD_NONE) {
+        return 0;
+    }
+    return LOG_RECORD_SIZE(length > LOG_NAME_MAX ? LOG_NAME_MAX : length);
+}
+
+uint8_t Logger::_intern(uint32_t time, const char *name) {
+    if (name == nullptr || !*name) {
+        return LOG_RECORD_NONE;
+    }
+    size_t length = strlen(name);
+    uint8_t id = _dictionary.find(name, length);
+    if (id == LOG_RECORD_NONE) {
+        id = _dictionary.add(name, length);
+        _bufferLen += logRecordEncode(_buffer + _bufferLen, time, LOG_RECORD_DEFINE, id, name,
+                                      length > LOG_NAME_MAX ? LOG_NAME_MAX : length);
+    }
+    return id;
+}
+
+bool Logger::_append(uint32_t time, const char *event, const char *source, const char *message, size_t length) {
+    if (!_begin()) {
+        return false;
+    }
+    if (length > LOG_PAYLOAD_MAX) {
+        length = LOG_PAYLOAD_MAX;
+    }
+
+    size_t eventDefine = defineSize(_dictionary, event);
+    size_t sourceDefine = defineSize(_dictionary, source);
+    size_t need = LOG_RECORD_SIZE(length) + eventDefine + sourceDefine;
+    uint8_t names = (eventDefine ? 1 : 0) + (sourceDefine ? 1 : 0);
+
+    if (_activeSize + _bufferLen + need > LOG_SEGMENT_DATA_SIZE || LOG_DICTIONARY_SIZE - _dictionary.size() < names) {
+        // Segment or dictionary full: drop the oldest segment and reuse its slot
+        if (!flush()) {
+            return false;
+        }
+        uint32_t seq = _segments[_active].seq + 1;
+        _createSegment(seq % LOG_SEGMENT_COUNT, seq);
+        need = LOG_RECORD_SIZE(length) + defineSize(_dictionary, event) + defineSize(_dictionary, source);
+    }
+    if (_bufferLen + need > LOG_BUFFER_SIZE && !flush()) {
+        return false;
+    }
+
+    if (!_bufferLen) {
+        _bufferSince = millis();
+        _bufferFirst = time;
+        _bufferLast = time;
     }
+    if (time < _bufferFirst) _bufferFirst = time;
+    if (time > _bufferLast) _bufferLast = time;
+    uint8_t eventId = _intern(time, event);
+    uint8_t sourceId = _intern(time, source);
+    _bufferLen += logRecordEncode(_buffer + _bufferLen, time, eventId, sourceId, message, length);
+    _bufferLines++;
+    return true;
+}
+
+bool Logger::flush() {
+    LogLock lock(*this);
+    if (!_bufferLen) {
+        return true;
+    }
+    if (!_begin()) {
+        return false;
+    }
+
+    File file = LOG_FS.open(getSegmentPath(_active), "r+");
+    if (!file || file.name() == nullptr) {
+        return false;
+    }
+
+    log_segment_header_t header = _segments[_active];
+    if (!header.lines) {
+        header.firstTime = _bufferFirst;
+        header.lastTime = _bufferLast;
+    } else {
+        if (_bufferFirst < header.firstTime) header.firstTime = _bufferFirst;
+        if (_bufferLast > header.lastTime) header.lastTime = _bufferLast;
+    }
+    header.lines += _bufferLines;
+    header.size = _activeSize + _bufferLen;
 
+    // Records first, then the header that covers them
+    file.seek(sizeof(header) + _activeSize);
+    bool ok = file.write(_buffer, _bufferLen) == _bufferLen;
+    if (ok) {
+        file.seek(0);
+        file.write((const uint8_t *) &header, sizeof(header));
+        _segments[_active] = header;
+        _activeSize = header.size;
+    }
     file.close();
-    tempFile.close();
+    _writeCount++;
+    _bufferLen = 0;
+    _bufferLines = 0;
+    if (!ok) {
+        // The buffered definitions are lost with the records
+        _loadDictionary();
+    }
+    return ok;
+}
 
-    LOG_FS.remove(filePath);
-    LOG_FS.rename("/temp_log.txt", filePath);
+/**
+ * Copy a name into a queue slot, cut to LOG_NAME_MAX
+ */
+static void copyName(char *out, const char *name) {
+    if (name == nullptr) {
+        // Plain message
+        out[0] = '\0';
+        return;
+    }
+    size_t length = strlen(name);
+    if (length > LOG_NAME_MAX) length = LOG_NAME_MAX;
+    memcpy(out, name, length);
+    out[length] = '\0';
 }
 
+bool Logger::_enqueue(const char *event, const char *source, const char *message, size_t length) {
+    uint8_t index;
+    if (_queueCount < LOG_QUEUE_SIZE) {
+        index = (_queueHead + _queueCount++) % LOG_QUEUE_SIZE;
+    } else {
+        _queueDropped++;
+        _queueDroppedPending++;
+        if (_queuePolicy == LOG_QUEUE_DROP_NEWEST) {
+            return false;
+        }
+        index = _queueHead;
+        _queueHead = (_queueHead + 1) % LOG_QUEUE_SIZE;
+    }
 
-void Logger::clearAllLogs() {
-    if (!LOG_FS.exists(filePath)) {
+    log_queue_item &item = _queue[index];
+    item.millis = millis();
+    copyName(item.event, event);
+    copyName(item.source, source);
+    if (length > LOG_QUEUE_MESSAGE_MAX) length = LOG_QUEUE_MESSAGE_MAX;
+    memcpy(item.message, message, length);
+    item.length = length;
+    return true;
+}
+
+bool Logger::_log(const char *event, const char *source, const char *message, size_t length) {
+    time_t now;
+    time(&now);
+    if (now <= 1609459200) {
+        // Time is not set (2021-01-01)
+        _enqueue(event, source, message, length);
+        return true;
+    }
+    return _append(now, event, source, message, length);
+}
+
+
+void Logger::clearOldLogs() {
+    LogLock lock(*this);
+    if (!_begin()) {
         return;
     }
 
-    LOG_FS.remove(filePath);
-#if defined(ESP8266)
-    File file = LOG_FS.open(filePath, "w");
-#elif defined(ESP32)
-    File file = LOG_FS.open(filePath, "w", true);
-#endif
+    time_t now;
+    time(&now);
+    uint32_t minTime = now - _maxLogTime * 24 * 3600;
 
-    file.close();
+    // Whole segments, oldest first, never the active one
+    uint32_t activeSeq = _segments[_active].seq;
+    uint32_t seq = activeSeq > LOG_SEGMENT_COUNT ? activeSeq - LOG_SEGMENT_COUNT + 1 : 1;
+    for (; seq < activeSeq; seq++) {
+        uint8_t index = seq % LOG_SEGMENT_COUNT;
+        log_segment_header_t &header = _segments[index];
+        if (header.seq != seq) {
+            continue;
+        }
+        if (header.lines && header.lastTime >= minTime) {
+            break;
+        }
+        LOG_FS.remove(getSegmentPath(index));
+        header = log_segment_header_t();
+    }
+}
+
+
+void Logger::clearAllLogs() {
+    LogLock lock(*this);
+    _begin();
+    _bufferLen = 0;
+    _bufferLines = 0;
+    for (uint8_t i = 0; i < LOG_SEGMENT_COUNT; i++) {
+        if (_segments[i].seq) {
+            LOG_FS.remove(getSegmentPath(i));
+        }
+        _segments[i] = log_segment_header_t();
+    }
+    _createSegment(0, LOG_SEGMENT_COUNT);
 }
 
 
 String Logger::getLogs() {
-    File file = LOG_FS.open(filePath, "r");
-    if (!file || file.name() == nullptr) {
-        return "";
+    log_query_t query;
+    std::shared_ptr<LogReader> reader = read(query);
+    String logs;
+    uint8_t buffer[LOG_READER_BLOCK_SIZE];
+    size_t n;
+    while ((n = reader->read(buffer, sizeof(buffer))) > 0) {
+        logs.concat((const char *) buffer, n);
     }
-    String logs = file.readString();
-    file.close();
     return logs;
 }
 
 
+std::shared_ptr<LogReader> Logger::read(const log_query_t &query) {
+    LogLock lock(*this);
+    _begin();
+    flush();
+
+    // Newest segment first, skipping the ones outside the range by their header
+    std::vector<String> paths;
+    uint32_t activeSeq = _segments[_active].seq;
+    for (uint32_t seq = activeSeq; seq && activeSeq - seq < LOG_SEGMENT_COUNT; seq--) {
+        uint8_t index = seq % LOG_SEGMENT_COUNT;
+        const log_segment_header_t &header = _segments[index];
+        if (header.seq != seq || !header.lines) {
+            continue;
+        }
+        if (header.lastTime < query.from || header.firstTime > query.to) {
+            continue;
+        }
+        paths.push_back(getSegmentPath(index));
+    }
+    if (!query.reverse || query.raw) {
+        std::reverse(paths.begin(), paths.end());
+    }
+    return std::make_shared<LogReader>(LOG_FS, std::move(paths), query);
+}
+
+
 bool Logger::log(const String &message) {
-    return _log(message);
+    LogLock lock(*this);
+    return _log(nullptr, nullptr, message.c_str(), message.length());
+}
+
+
+bool Logger::log(const char *event, const char *source, const char *message) {
+    LogLock lock(*this);
+    if (message == nullptr) {
+        message = "";
+    }
+    return _log(event, source, message, strlen(message));
 }
 
 
 void Logger::processQueue() {
-    if (_log_queue.empty()) {
+    LogLock lock(*this);
+    if (!_queueCount && !_queueDroppedPending) {
         return;
     }
 
@@ -135,14 +427,28 @@ void Logger::processQueue() {
         return;
     }
 
-    File file = LOG_FS.open(filePath, "a");
-    if (!file || file.name() == nullptr) {
-        return;
+    // Same millis() reading for all: the ages are relative to the moment `now` was read
+    uint32_t nowMillis = millis();
+    for (; _queueCount; _queueCount--) {
+        const log_queue_item &item = _queue[_queueHead];
+        _append(now - (nowMillis - item.millis) / 1000, item.event, item.source, item.message, item.length);
+        _queueHead = (_queueHead + 1) % LOG_QUEUE_SIZE;
+    }
+    _queueHead = 0;
+    if (_queueDroppedPending) {
+        char count[11];
+        snprintf(count, sizeof(count), "%lu", (unsigned long) _queueDroppedPending);
+        _append(now, "LOG_DROPPED", "QUEUE", count, strlen(count));
+        _queueDroppedPending = 0;
     }
+    flush();
+}
+
 
-    for (auto &item: _log_queue) {
-        file.printf("%ld %s\n", now - (millis() - item.millis), item.message.c_str());
+void Logger::loop() {
+    LogLock lock(*this);
+    processQueue();
+    if (_bufferLen && millis() - _bufferSince >= LOG_FLUSH_DELAY) {
+        flush();
     }
-    _log_queue.clear();
-    file.close();
-}
\ No newline at end of file
+}
@@ -6,6 +6,7 @@
 #define SMART_GARDEN_LOGGER_H
 
 #include <Arduino.h>
+#include <memory>
 #include <vector>
 #if defined(ESP8266)
 #include <LittleFS.h>
@@ -14,6 +15,49 @@
 #include <SPIFFS.h>
 #define LOG_FS SPIFFS
 #endif
+#include "LogReader.h"
+#if defined(ESP32) && !defined(NATIVE_HOST)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+// The log is a ring of LOG_SEGMENT_COUNT files of LOG_SEGMENT_SIZE bytes (header included). When the
+// newest one is full, the oldest one is truncated and reused.
+#ifndef LOG_SEGMENT_COUNT
+#define LOG_SEGMENT_COUNT 8
+#endif
+
+#ifndef LOG_SEGMENT_SIZE
+#define LOG_SEGMENT_SIZE 16384
+#endif
+
+// Records are collected in RAM and appended to the segment in one write
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE 1024
+#endif
+
+// Longest time a record stays in RAM before loop() writes it (ms)
+#ifndef LOG_FLUSH_DELAY
+#define LOG_FLUSH_DELAY 30000
+#endif
+
+// Entries kept in RAM until the clock is set, reserved up front
+#ifndef LOG_QUEUE_SIZE
+#define LOG_QUEUE_SIZE 16
+#endif
+
+// Longest queued message, longer ones are cut
+#ifndef LOG_QUEUE_MESSAGE_MAX
+#define LOG_QUEUE_MESSAGE_MAX 48
+#endif
+
+/**
+ * @brief What a full queue does with a new entry
+ */
+enum log_queue_policy_t {
+    LOG_QUEUE_DROP_OLDEST, // overwrite the oldest entry
+    LOG_QUEUE_DROP_NEWEST, // keep the first entries, drop the new one
+};
 
 class Logger {
 
@@ -21,11 +65,16 @@ public:
 
     struct log_queue_item {
         uint32_t millis;
-        String message;
+        char event[LOG_NAME_MAX + 1];
+        char source[LOG_NAME_MAX + 1];
+        uint8_t length;
+        char message[LOG_QUEUE_MESSAGE_MAX];
     };
 
     Logger();
 
+    virtual ~Logger();
+
     /**
      * Set maximum log time in days
      * @param days
@@ -46,19 +95,139 @@ public:
 
     virtual void clearAllLogs();
 
+    /**
+     * Log a plain message
+     * @param message
+     * @return
+     */
     virtual bool log(const String& message);
 
+    /**
+     * Log an event as a binary record; the event and source names are stored once per segment
+     * @param event e.g. "VALVE_OPEN"
+     * @param source e.g. "SCHEDULE"
+     * @param message cut to LOG_PAYLOAD_MAX
+     * @return
+     */
+    bool log(const char *event, const char *source, const char *message);
+
     virtual String getLogs();
 
+    /**
+     * Write the buffered records to the active segment
+     * @return false if the file could not be written
+     */
+    bool flush();
+
+    /**
+     * Open a streaming reader over the log lines matching the query. Safe to call from the web server
+     * task, the reader itself only reads the segment files
+     * @param query time range, limit and order
+     * @return
+     */
+    std::shared_ptr<LogReader> read(const log_query_t &query);
+
+    /**
+     * Write the queued entries, backdated from millis(), once the time is set
+     */
     void processQueue();
 
+    void setQueuePolicy(log_queue_policy_t policy) {
+        _queuePolicy = policy;
+    }
+
+    /**
+     * Number of entries waiting for the time to be set
+     * @return
+     */
+    uint8_t getQueueCount() const {
+        return _queueCount;
+    }
+
+    /**
+     * Number of entries dropped because the queue was full, since start
+     * @return
+     */
+    uint32_t getDroppedCount() const {
+        return _queueDropped;
+    }
+
+    /**
+     * Write the queued records once the time is set, and the buffered ones after LOG_FLUSH_DELAY
+     */
+    void loop();
+
+    /**
+     * Number of segment writes (flushes) so far
+     * @return
+     */
+    uint32_t getWriteCount() const {
+        return _writeCount;
+    }
+
+    /**
+     * Path of a segment file, e.g. "/logs_0.seg" for "/logs.txt"
+     * @param index slot 0..LOG_SEGMENT_COUNT-1
+     * @return
+     */
+    String getSegmentPath(uint8_t index) const;
+
 protected:
-    String filePath = "/logs.txt";
+    String filePath = "/logs.txt"; // names the segments; a file at this path (old format) is imported once
     uint16_t _maxLogTime = 365; // days
 
-    std::vector<log_queue_item> _log_queue;
+    log_queue_item _queue[LOG_QUEUE_SIZE]{};
+    uint8_t _queueHead = 0;   // oldest entry
+    uint8_t _queueCount = 0;
+    log_queue_policy_t _queuePolicy = LOG_QUEUE_DROP_OLDEST;
+    uint32_t _queueDropped = 0;
+    uint32_t _queueDroppedPending = 0; // not reported in the log yet
+
+    bool _log(const char *event, const char *source, const char *message, size_t length);
+
+    /**
+     * Keep an entry until the time is set
+     * @return false if it was dropped
+     */
+    bool _enqueue(const char *event, const char *source, const char *message, size_t length);
+
+private:
+    bool _ready = false;
+    log_segment_header_t _segments[LOG_SEGMENT_COUNT]{};
+    uint8_t _active = 0;      // slot being appended to
+    size_t _activeSize = 0;   // bytes of records in the active segment
+    LogDictionary _dictionary; // names of the active segment
+
+    uint8_t _buffer[LOG_BUFFER_SIZE]{};
+    size_t _bufferLen = 0;
+    uint32_t _bufferFirst = 0;
+    uint32_t _bufferLast = 0;
+    uint32_t _bufferLines = 0;
+    uint32_t _bufferSince = 0; // millis() of the oldest buffered record
+    uint32_t _writeCount = 0;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    SemaphoreHandle_t _mutex = nullptr; // recursive, the public methods call each other
+#endif
+
+    friend class LogLock;
+
+    /**
+     * Load the segment headers, on first use since SLog sets filePath after construction
+     */
+    bool _begin();
+
+    bool _append(uint32_t time, const char *event, const char *source, const char *message, size_t length);
+
+    /**
+     * Id of a name in the active segment, buffering its definition record when it is new
+     */
+    uint8_t _intern(uint32_t time, const char *name);
+
+    void _loadDictionary();
+
+    void _createSegment(uint8_t index, uint32_t seq);
 
-    bool _log(const String& message);
+    void _importLegacy();
 };
 
 
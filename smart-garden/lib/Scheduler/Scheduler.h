@@ -1,6 +1,10 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <Arduino.h>
 
 //#define DEBUG_SCHEDULER
@@ -16,6 +20,31 @@
 #endif
 #endif
 
+#if defined(STORE_SCHEDULES_IN_DATABASE) && !defined(USE_FIREBASE_RTDB)
+#undef STORE_SCHEDULES_IN_DATABASE // no database client (e.g. native build), fall back to flash
+#endif
+
+
+// Maximum number of tasks, the next-fire index keeps run() cheap regardless of this value
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 64
+#endif
+
+// A run that comes due while the loop is stalled still fires if the loop catches up within this window
+#ifndef SCHEDULER_GRACE_SECONDS
+#define SCHEDULER_GRACE_SECONDS 120
+#endif
+
+// Args slots per task type: every task plus a few for tasks being built or updated
+#ifndef SCHEDULER_ARGS_POOL_SIZE
+#define SCHEDULER_ARGS_POOL_SIZE (SCHEDULER_MAX_TASKS + 4)
+#endif
+
+// Journal entries appended before the schedule file is rewritten (compacted)
+#ifndef SCHEDULER_JOURNAL_MAX_ENTRIES
+#define SCHEDULER_JOURNAL_MAX_ENTRIES 32
+#endif
+
 
 #ifdef DEBUG_SCHEDULER
 #define DSPrint(...) Serial.print("[Scheduler] "); Serial.printf(__VA_ARGS__)
@@ -42,10 +71,153 @@ class ScheduleTaskArgsBase;
 template<class T = ScheduleTaskArgsBase>
 class Scheduler;
 
+template<class T>
+class ScheduleArgsPool;
+
+/**
+ * @brief Owning handle to task args allocated from ScheduleArgsPool (move only).
+ * The slot goes back to the pool when the handle is destroyed or reassigned
+ */
+template<class T>
+class ScheduleArgsPtr {
+public:
+    ScheduleArgsPtr() = default;
+
+    ScheduleArgsPtr(std::nullptr_t) {}
+
+    ScheduleArgsPtr(ScheduleArgsPtr &&other) noexcept: _ptr(other._ptr) {
+        other._ptr = nullptr;
+    }
+
+    ScheduleArgsPtr &operator=(ScheduleArgsPtr &&other) noexcept {
+        if (this != &other) {
+            reset();
+            _ptr = other._ptr;
+            other._ptr = nullptr;
+        }
+        return *this;
+    }
+
+    ScheduleArgsPtr(const ScheduleArgsPtr &) = delete;
+
+    ScheduleArgsPtr &operator=(const ScheduleArgsPtr &) = delete;
+
+    ~ScheduleArgsPtr() {
+        reset();
+    }
+
+    void reset() {
+        if (_ptr) {
+            ScheduleArgsPool<T>::destroy(_ptr);
+            _ptr = nullptr;
+        }
+    }
+
+    T *get() const { return _ptr; }
+
+    T *operator->() const { return _ptr; }
+
+    T &operator*() const { return *_ptr; }
+
+    explicit operator bool() const { return _ptr != nullptr; }
+
+private:
+    friend class ScheduleArgsPool<T>;
+
+    explicit ScheduleArgsPtr(T *ptr) : _ptr(ptr) {}
+
+    T *_ptr = nullptr;
+};
+
+/**
+ * @brief Fixed-capacity storage for task args, one pool per args type.
+ * Replaces new/delete so reloading schedules never grows or fragments the heap
+ */
+template<class T>
+class ScheduleArgsPool {
+public:
+    /**
+     * @brief Construct args in a free slot
+     * @return handle, empty if the pool is exhausted
+     */
+    template<typename... A>
+    static ScheduleArgsPtr<T> create(A &&... args) {
+        auto &pool = instance();
+        pool._lock();
+        if (pool._freeCount == 0) {
+            pool._unlock();
+            Serial.println("Schedule args pool exhausted");
+            return {};
+        }
+        uint16_t slot = pool._free[--pool._freeCount];
+        pool._unlock();
+        return ScheduleArgsPtr<T>(new(&pool._storage[slot]) T(std::forward<A>(args)...));
+    }
+
+    /**
+     * @brief Number of free slots
+     */
+    static uint16_t available() {
+        return instance()._freeCount;
+    }
+
+    static constexpr uint16_t capacity() {
+        return SCHEDULER_ARGS_POOL_SIZE;
+    }
+
+private:
+    friend class ScheduleArgsPtr<T>;
+
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type slot_t;
+
+    slot_t _storage[SCHEDULER_ARGS_POOL_SIZE];
+    uint16_t _free[SCHEDULER_ARGS_POOL_SIZE];
+    uint16_t _freeCount = SCHEDULER_ARGS_POOL_SIZE;
+#if defined(ESP32) && !defined(NATIVE_HOST)
+    // Web handlers create and destroy args on the async_tcp task, load() / run() on the loop task
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    void _lock() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+        portENTER_CRITICAL(&_mux);
+#endif
+    }
+
+    void _unlock() {
+#if defined(ESP32) && !defined(NATIVE_HOST)
+        portEXIT_CRITICAL(&_mux);
+#endif
+    }
+
+    ScheduleArgsPool() {
+        for (uint16_t i = 0; i < SCHEDULER_ARGS_POOL_SIZE; i++) {
+            _free[i] = SCHEDULER_ARGS_POOL_SIZE - 1 - i;
+        }
+    }
+
+    static ScheduleArgsPool &instance() {
+        static ScheduleArgsPool pool;
+        return pool;
+    }
+
+    static void destroy(T *obj) {
+        auto &pool = instance();
+        obj->~T();
+        pool._lock();
+        pool._free[pool._freeCount++] = reinterpret_cast<slot_t *>(obj) - pool._storage;
+        pool._unlock();
+    }
+};
+
 struct schedule_time_t {
     uint8_t hour;
     uint8_t minute;
+    uint8_t second;
 
+    /**
+     * @brief "HH:MM", or "HH:MM:SS" when seconds are set
+     */
     String toString() const {
         String out = "";
         if (hour < 10)
@@ -54,21 +226,72 @@ struct schedule_time_t {
         if (minute < 10)
             out += "0";
         out += String(minute);
+        if (second) {
+            out += second < 10 ? ":0" : ":";
+            out += String(second);
+        }
         return out;
     }
 };
 
+/**
+ * @brief Weekdays the task repeats on, one bit per day in tm_wday order (bit 0 = Sunday)
+ */
 struct schedule_repeat_t {
-    bool monday;
-    bool tuesday;
-    bool wednesday;
-    bool thursday;
-    bool friday;
-    bool saturday;
-    bool sunday;
+    uint8_t mask;
+
+    enum : uint8_t {
+        SUNDAY = 1 << 0,
+        MONDAY = 1 << 1,
+        TUESDAY = 1 << 2,
+        WEDNESDAY = 1 << 3,
+        THURSDAY = 1 << 4,
+        FRIDAY = 1 << 5,
+        SATURDAY = 1 << 6,
+        EVERYDAY = 0x7F,
+    };
 
+    /**
+     * @brief Check if the task repeats on a day
+     * @param dow 0 = Sunday
+     */
+    bool on(uint8_t dow) const {
+        return dow < 7 && (mask & (1 << dow));
+    }
+
+    /**
+     * @brief Set/clear a repeat day
+     * @param dow 0 = Sunday
+     */
+    void set(uint8_t dow, bool repeat = true) {
+        if (dow >= 7) return;
+        if (repeat)
+            mask |= (1 << dow);
+        else
+            mask &= ~(1 << dow);
+    }
+
+    /**
+     * @brief Text form used by the file/database format: 7 digits, Monday first
+     */
     String toString() const {
-        return String(monday) + String(tuesday) + String(wednesday) + String(thursday) + String(friday) + String(saturday) + String(sunday);
+        char out[8];
+        for (uint8_t i = 0; i < 7; i++) {
+            out[i] = on((i + 1) % 7) ? '1' : '0';
+        }
+        out[7] = '\0';
+        return {out};
+    }
+
+    /**
+     * @brief Parse the text form (7 digits, Monday first)
+     */
+    static schedule_repeat_t fromString(const char *str, size_t len) {
+        schedule_repeat_t result{0};
+        for (uint8_t i = 0; i < 7 && i < len; i++) {
+            result.set((i + 1) % 7, str[i] == '1');
+        }
+        return result;
     }
 };
 
@@ -77,9 +300,115 @@ struct schedule_task_t {
     uint8_t id;
     schedule_time_t time;
     schedule_repeat_t repeat;
-    T *args; // extended from ScheduleTaskArgsBase
+    ScheduleArgsPtr<T> args; // extended from ScheduleTaskArgsBase
     bool enabled;
-    bool executed;
+    uint16_t interval;      // seconds between runs from `time` to `until`, 0 = run once at `time`
+    schedule_time_t until;  // last possible run of the day for interval tasks
+    time_t lastRun;         // runtime state only, never persisted: runs due before boot are not caught up
+};
+
+
+#define SCHEDULE_RECORD_ARGS_SIZE 8
+#define SCHEDULE_FILE_VERSION 2
+
+/**
+ * @brief Fixed-size on-flash task record, args are serialized inline
+ */
+struct __attribute__((packed)) schedule_record_t {
+    uint8_t id;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t repeat;     // schedule_repeat_t::mask
+    uint8_t flags;      // bit 0: enabled
+    uint16_t interval;
+    uint8_t untilHour;
+    uint8_t untilMinute;
+    uint8_t argsLength;
+    uint8_t args[SCHEDULE_RECORD_ARGS_SIZE];
+};
+
+/**
+ * @brief Record of SCHEDULE_FILE_VERSION 1 (minute resolution, no intervals), upgraded on load
+ */
+struct __attribute__((packed)) schedule_record_v1_t {
+    uint8_t id;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t repeat;
+    uint8_t flags;
+    uint8_t argsLength;
+    uint8_t args[SCHEDULE_RECORD_ARGS_SIZE];
+
+    schedule_record_t upgrade() const {
+        schedule_record_t record{};
+        record.id = id;
+        record.hour = hour;
+        record.minute = minute;
+        record.repeat = repeat;
+        record.flags = flags & 0x01;
+        record.argsLength = argsLength;
+        memcpy(record.args, args, sizeof(args));
+        return record;
+    }
+};
+
+/**
+ * @brief Header of the binary schedule file, followed by `count` records
+ */
+struct __attribute__((packed)) schedule_file_header_t {
+    char magic[3];      // "SGS"
+    uint8_t version;
+    uint8_t recordSize;
+    uint8_t count;
+};
+
+/**
+ * @brief Append-only journal entry. Replayed over the schedule file on load
+ */
+struct __attribute__((packed)) schedule_journal_entry_t {
+    enum : uint8_t {
+        UPSERT = 0x01, // add or replace the task with record.id
+        REMOVE = 0x02, // remove the task with record.id
+    };
+
+    uint8_t op;
+    schedule_record_t record;
+    uint8_t checksum;   // detects torn writes at the end of the journal
+
+    uint8_t computeChecksum() const {
+        return checksumOf(this, sizeof(*this) - sizeof(checksum));
+    }
+
+    static uint8_t checksumOf(const void *data, size_t length) {
+        auto *bytes = reinterpret_cast<const uint8_t *>(data);
+        uint8_t sum = 0xA5;
+        for (size_t i = 0; i < length; i++) {
+            sum = (sum << 1 | sum >> 7) ^ bytes[i];
+        }
+        return sum;
+    }
+};
+
+/**
+ * @brief Journal entry written next to a SCHEDULE_FILE_VERSION 1 file
+ */
+struct __attribute__((packed)) schedule_journal_entry_v1_t {
+    uint8_t op;
+    schedule_record_v1_t record;
+    uint8_t checksum;
+
+    uint8_t computeChecksum() const {
+        return schedule_journal_entry_t::checksumOf(this, sizeof(*this) - sizeof(checksum));
+    }
+};
+
+/**
+ * @brief Pending run of a task in the due queue
+ */
+struct schedule_due_t {
+    time_t due;
+    uint8_t taskIndex;
 };
 
 
@@ -91,10 +420,57 @@ class ScheduleTaskArgsBase {
 public:
     ScheduleTaskArgsBase() = default;
 
+    virtual ~ScheduleTaskArgsBase() = default;
+
     virtual void parse(String &args) {}
 
+    /**
+     * @brief Parse the arguments from a span of the task text, without copying it.
+     * Override this for allocation-free loading, the default goes through parse(String &)
+     *
+     * @param args start of the args field
+     * @param length field length (not null terminated)
+     */
+    virtual void parse(const char *args, size_t length) {
+        String str;
+        str.concat(args, length);
+        parse(str);
+    }
+
     virtual String toString() { return "NULL"; }
 
+    /**
+     * @brief Serialize the arguments into a binary record
+     * @param buf output buffer
+     * @param size buffer size (SCHEDULE_RECORD_ARGS_SIZE)
+     * @return number of bytes written
+     */
+    virtual size_t pack(uint8_t *buf, size_t size) { return 0; }
+
+    /**
+     * @brief Read the arguments from a binary record
+     * @param buf data written by pack()
+     * @param size data length
+     */
+    virtual void unpack(const uint8_t *buf, size_t size) {}
+
+    /**
+     * @brief String::toInt() for a span: optional sign followed by digits
+     */
+    static long toInt(const char *str, size_t length) {
+        const char *end = str + length;
+        while (str < end && *str == ' ')
+            str++;
+        bool negative = str < end && *str == '-';
+        if (negative || (str < end && *str == '+'))
+            str++;
+        long value = 0;
+        for (; str < end && *str >= '0' && *str <= '9'; str++) {
+            value = value * 10 + (*str - '0');
+        }
+        return negative ? -value : value;
+    }
+
 };
 
 
@@ -103,9 +479,70 @@ class Scheduler {
 
 private:
 
-    struct tm *_timeinfo = nullptr;
     std::vector<schedule_task_t<T>> tasks;
-    std::function<void(schedule_task_t<T>)> _callbackFn = nullptr;
+    std::function<void(const schedule_task_t<T> &)> _callbackFn = nullptr;
+
+    std::vector<schedule_due_t> _dueQueue; // min-heap on `due`, one pending run per enabled task
+    bool _indexDirty = true;
+    time_t _lastCheck = 0;
+    time_t _bootTime = 0; // epoch of the boot, once the clock is set
+
+    static bool _dueLater(const schedule_due_t &a, const schedule_due_t &b) {
+        return a.due > b.due;
+    }
+
+    /**
+     * @brief Mark the due queue as stale. Must be called after any change to the task list
+     */
+    void _invalidateIndex() {
+        _indexDirty = true;
+    }
+
+    void _pushDue(time_t due, uint8_t taskIndex) {
+        if (!due)
+            return;
+        _dueQueue.push_back({due, taskIndex});
+        std::push_heap(_dueQueue.begin(), _dueQueue.end(), _dueLater);
+    }
+
+    /**
+     * @brief Rebuild the due queue: the next run of each enabled task, runs missed less than
+     * graceSeconds ago included
+     */
+    void _rebuildIndex(time_t now) {
+        _dueQueue.clear();
+        for (size_t i = 0; i < tasks.size(); i++) {
+            auto &task = tasks[i];
+            if (!task.enabled)
+                continue;
+            // lastRun does not survive a restart: a run due before boot may already have fired
+            time_t from = std::max<time_t>(std::max<time_t>(now - graceSeconds, _bootTime), task.lastRun + 1);
+            time_t due = nextRunTime(task, from);
+            if (due)
+                _dueQueue.push_back({due, static_cast<uint8_t>(i)});
+        }
+        std::make_heap(_dueQueue.begin(), _dueQueue.end(), _dueLater);
+        _indexDirty = false;
+        DSPrint("Due queue rebuilt (%d tasks)\n", (int) _dueQueue.size());
+    }
+
+    std::vector<std::pair<uint8_t, time_t>> getLastRuns() const {
+        std::vector<std::pair<uint8_t, time_t>> runs;
+        for (auto &task: tasks) {
+            if (task.lastRun)
+                runs.emplace_back(task.id, task.lastRun);
+        }
+        return runs;
+    }
+
+    void restoreLastRuns(const std::vector<std::pair<uint8_t, time_t>> &runs) {
+        for (auto &task: tasks) {
+            for (auto &run: runs) {
+                if (run.first == task.id)
+                    task.lastRun = run.second;
+            }
+        }
+    }
 
 #ifdef STORE_SCHEDULES_IN_FLASH
     File file;
@@ -159,58 +596,232 @@ private:
     }
 
     /**
-     * @brief Append a task to file
-     * 
-     * @param file file object
-     * @param task task object
-     * @return true 
-     * @return false 
+     * @brief Import tasks from the legacy text file (id|hour|minute|repeat|args|enabled|executed per line),
+     * write them in the binary format and remove the text file
+     *
+     * @return true
+     * @return false
      */
-    bool writeTaskToFile(schedule_task_t<T> *task) {
-        openFile(false, APPEND);
-        if (!file || file.name() == nullptr) {
-            Serial.println("Failed to open file for writing");
+    bool migrateLegacyFile() {
+        DSPrint("Migrating %s to %s\n", legacyFilePath.c_str(), filePath.c_str());
+        File legacy = SCHEDULE_FS.open(legacyFilePath, "r");
+        if (!legacy) {
+            DSPrint("> Failed to open legacy file\n");
+            return false;
+        }
+
+        tasks.clear();
+        _invalidateIndex();
+        String line;
+        while (legacy.available() && tasks.size() < MAX_TASKS) {
+            line = legacy.readStringUntil('\n');
+            if (line.length() > 0) {
+                auto task = parseTask(line);
+                if (task.id)
+                    tasks.push_back(std::move(task));
+            }
+        }
+        legacy.close();
+
+        if (!save()) {
             return false;
         }
+        SCHEDULE_FS.remove(legacyFilePath);
+        DSPrint("> Migrated %d tasks\n", (int) tasks.size());
+        return true;
+    }
 
-        file.printf("%d|%d|%d|%d%d%d%d%d%d%d|%s|%d|%d\n",
-                    task->id,
-                    task->time.hour,
-                    task->time.minute,
-                    task->repeat.monday,
-                    task->repeat.tuesday,
-                    task->repeat.wednesday,
-                    task->repeat.thursday,
-                    task->repeat.friday,
-                    task->repeat.saturday,
-                    task->repeat.sunday,
-                    task->args->toString().c_str(),
-                    task->enabled,
-                    task->executed);
+    uint16_t _journalEntries = 0; // entries in the journal since the last compaction
 
-        closeFile();
+    /**
+     * @brief Append one task mutation to the journal, compact once the journal is full
+     *
+     * @param op schedule_journal_entry_t::UPSERT / REMOVE
+     * @param task
+     * @return true
+     * @return false
+     */
+    bool appendJournal(uint8_t op, const schedule_task_t<T> &task) {
+        if (_journalEntries >= SCHEDULER_JOURNAL_MAX_ENTRIES) {
+            // Task list already holds the mutation, a full rewrite covers it
+            return save();
+        }
+
+        schedule_journal_entry_t entry{};
+        entry.op = op;
+        if (op == schedule_journal_entry_t::REMOVE) {
+            entry.record.id = task.id;
+        } else {
+            toRecord(task, entry.record);
+        }
+        entry.checksum = entry.computeChecksum();
+
+        File journal = SCHEDULE_FS.open(journalFilePath, "a");
+        if (!journal) {
+            DSPrint("Failed to open journal, rewriting file\n");
+            return save();
+        }
+        bool written = journal.write((uint8_t *) &entry, sizeof(entry)) == sizeof(entry);
+        journal.close();
+        if (!written) {
+            DSPrint("Failed to append to journal, rewriting file\n");
+            return save();
+        }
+        _journalEntries++;
+        DSPrint("Journal entry %d appended (op %d, task %d)\n", _journalEntries, op, task.id);
         return true;
     }
+
+    /**
+     * @brief Read `count` records following the file header into `tasks`
+     */
+    template<class Record>
+    bool readRecords(uint8_t count) {
+        // All records in one read
+        std::vector<Record> records(count);
+        size_t length = count * sizeof(Record);
+        if (file.read((uint8_t *) records.data(), length) != length) {
+            Serial.println("Schedule file is truncated");
+            return false;
+        }
+        for (auto &record: records) {
+            if (!record.id)
+                continue;
+            if (tasks.size() >= MAX_TASKS)
+                break;
+            auto task = fromRecord(record);
+            if (task.args)
+                tasks.push_back(std::move(task));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Apply the journal on top of the loaded tasks. Entries are idempotent
+     * (upsert/remove by id), so replaying a journal that is already part of the file is harmless
+     *
+     * @tparam Entry entry layout matching the version of the schedule file
+     * @return number of valid entries
+     */
+    template<class Entry = schedule_journal_entry_t>
+    uint16_t replayJournal() {
+        File journal = SCHEDULE_FS.open(journalFilePath, "r");
+        if (!journal) {
+            return 0;
+        }
+        uint16_t count = 0;
+        Entry entry{};
+        while (journal.read((uint8_t *) &entry, sizeof(entry)) == sizeof(entry)) {
+            if (entry.checksum != entry.computeChecksum() || !entry.record.id) {
+                DSPrint("> Journal entry %d is corrupt, ignoring the rest\n", count);
+                break;
+            }
+            auto it = std::find_if(tasks.begin(), tasks.end(), [&](const schedule_task_t<T> &t) {
+                return t.id == entry.record.id;
+            });
+            if (it != tasks.end()) {
+                it = tasks.erase(it);
+            }
+            if (entry.op == schedule_journal_entry_t::UPSERT && tasks.size() < MAX_TASKS) {
+                auto task = fromRecord(entry.record);
+                if (task.args)
+                    tasks.insert(it, std::move(task)); // replaced tasks keep their position
+            }
+            count++;
+        }
+        journal.close();
+        DSPrint("Replayed %d journal entries\n", count);
+        return count;
+    }
 #elif defined(STORE_SCHEDULES_IN_DATABASE)
 
-    uint8_t MAX_TASKS = 20;
+    uint8_t MAX_TASKS = SCHEDULER_MAX_TASKS;
     String db_path;
     fbrtdb_object *dbObj = nullptr;
     AsyncResult _loadResult; // async result for loading tasks
+    bool _loadPending = false; // load() requested, run() must be called to pick up the result
+
+    /**
+     * @brief Database key of a task. Prefixed so RTDB does not turn the numeric ids into a sparse array
+     */
+    static String taskKey(uint8_t id) {
+        return "t" + String(id);
+    }
+
+    bool databaseReady() const {
+        if (dbObj == nullptr || getPath() == "") {
+            DSPrint("Database is not attached\n");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Upload a single task to <path>/t<id>
+     *
+     * @param task
+     * @return true
+     * @return false
+     */
+    bool syncTask(const schedule_task_t<T> &task) {
+        if (!databaseReady())
+            return false;
+        DSPrint("Syncing task [%d] to database\n", task.id);
+        dbObj->rtdb->set<String>(
+                *dbObj->client,
+                getPath() + "/" + taskKey(task.id),
+                taskToString(task),
+                [](AsyncResult &res) {
+                    if (res.isError()) {
+                        DSPrint("> Failed to sync task to database\n");
+                        DSPrint(">> msg: %s, code: %d\n", res.error().message().c_str(), res.error().code());
+                    }
+                });
+        return true;
+    }
+
+    /**
+     * @brief Remove a single task from <path>/t<id>
+     *
+     * @param id
+     * @return true
+     * @return false
+     */
+    bool syncRemove(uint8_t id) {
+        if (!databaseReady())
+            return false;
+        DSPrint("Removing task [%d] from database\n", id);
+        dbObj->rtdb->remove(
+                *dbObj->client,
+                getPath() + "/" + taskKey(id),
+                [](AsyncResult &res) {
+                    if (res.isError()) {
+                        DSPrint("> Failed to remove task from database\n");
+                        DSPrint(">> msg: %s, code: %d\n", res.error().message().c_str(), res.error().code());
+                    }
+                });
+        return true;
+    }
 
 #endif
 
 public:
 
+    uint16_t graceSeconds = SCHEDULER_GRACE_SECONDS; // how late a run may still fire
+
 #ifdef STORE_SCHEDULES_IN_FLASH
-    String filePath = "/schedules.txt";
-    uint8_t MAX_TASKS = 10;
+    String filePath = "/schedules.bin";
+    String journalFilePath = "/schedules.jnl";
+    String tempFilePath = "/schedules.tmp"; // next schedule file, renamed over filePath once complete
+    String legacyFilePath = "/schedules.txt"; // text format before SCHEDULE_FILE_VERSION 1
+    uint8_t MAX_TASKS = SCHEDULER_MAX_TASKS;
 #endif
 
 
 #ifdef STORE_SCHEDULES_IN_FLASH
 
-    explicit Scheduler(std::function<void(schedule_task_t<T>)> callback = nullptr) {
+    explicit Scheduler(std::function<void(const schedule_task_t<T> &)> callback = nullptr) {
+        _callbackFn = callback;
         SCHEDULE_FS.begin();
         // Load tasks from file
         load();
@@ -220,11 +831,11 @@ public:
 
     Scheduler() = default;
 
-    explicit Scheduler(std::function<void(schedule_task_t<T>)> callback) {
+    explicit Scheduler(std::function<void(const schedule_task_t<T> &)> callback) {
         _callbackFn = callback;
     }
 
-    explicit Scheduler(fbrtdb_object *dbObj, std::function<void(schedule_task_t<T>)> callback = nullptr) {
+    explicit Scheduler(fbrtdb_object *dbObj, std::function<void(const schedule_task_t<T> &)> callback = nullptr) {
         this->dbObj = dbObj;
         _callbackFn = callback;
     }
@@ -234,7 +845,6 @@ public:
 
     ~Scheduler() {
         tasks.clear();
-        _timeinfo = nullptr;
 
 #ifdef STORE_SCHEDULES_IN_FLASH
         closeFile();
@@ -257,32 +867,73 @@ public:
 
 #ifdef STORE_SCHEDULES_IN_FLASH
 
+        // Finish a compaction interrupted between removing the old file and renaming the new one
+        if (SCHEDULE_FS.exists(tempFilePath)) {
+            if (SCHEDULE_FS.exists(filePath))
+                SCHEDULE_FS.remove(tempFilePath);
+            else
+                SCHEDULE_FS.rename(tempFilePath, filePath);
+        }
+
+        if (!SCHEDULE_FS.exists(filePath) && SCHEDULE_FS.exists(legacyFilePath)) {
+            return migrateLegacyFile();
+        }
+
+        // Last runs are not persisted, keep them across reloads so a task can't fire twice for the same time
+        auto lastRuns = getLastRuns();
+
+        // Clear tasks
+        tasks.clear();
+        _invalidateIndex();
+
+        if (!SCHEDULE_FS.exists(filePath)) {
+            // Not compacted yet, everything is in the journal
+            _journalEntries = replayJournal();
+            restoreLastRuns(lastRuns);
+            return true;
+        }
+
         openFile(false, READ_ONLY);
         if (!file || file.name() == nullptr) {
             Serial.println("Failed to open file for reading");
             return false;
         }
 
-        // Clear tasks
-        tasks.clear();
-
         // Read file
         if (file.size() == 0) {
             closeFile();
+            _journalEntries = replayJournal();
+            restoreLastRuns(lastRuns);
             return true;
         }
 
-        String line;
-        while (file.available()) {
-            line = file.readStringUntil('\n');
-            if (line.length() > 0) {
-                auto task = parseTask(line);
-                if (task.id)
-                    tasks.push_back(task);
-            }
+        schedule_file_header_t header{};
+        bool valid = file.read((uint8_t *) &header, sizeof(header)) == sizeof(header) &&
+                     memcmp(header.magic, "SGS", 3) == 0;
+        bool current = valid && header.version == SCHEDULE_FILE_VERSION &&
+                       header.recordSize == sizeof(schedule_record_t);
+        bool v1 = valid && header.version == 1 && header.recordSize == sizeof(schedule_record_v1_t);
+        if (!current && !v1) {
+            Serial.println("Invalid schedule file");
+            closeFile();
+            return false;
         }
 
+        bool ok = current ? readRecords<schedule_record_t>(header.count)
+                            : readRecords<schedule_record_v1_t>(header.count);
         closeFile();
+        if (!ok) {
+            return false;
+        }
+
+        if (current) {
+            _journalEntries = replayJournal();
+        } else {
+            DSPrint("Upgrading schedule file from version %d\n", header.version);
+            replayJournal<schedule_journal_entry_v1_t>();
+            save();
+        }
+        restoreLastRuns(lastRuns);
         return true;
 
 #elif defined(STORE_SCHEDULES_IN_DATABASE)
@@ -299,6 +950,7 @@ public:
         DSPrint("Start loading tasks from database\n");
         DSPrint("> Path: %s\n", getPath().c_str());
         _loadResult.clear();
+        _loadPending = true;
         dbObj->rtdb->get(*dbObj->client, getPath(), _loadResult);
         return true; // always true because it is async
 
@@ -310,9 +962,8 @@ public:
 
 
     /**
- * @brief Overwrite the file with the current tasks
+ * @brief Overwrite the file/database with the current tasks. In flash mode this also compacts the journal
  *
- * @param overwrite
  * @return true
  * @return false
  */
@@ -321,22 +972,50 @@ public:
 #ifdef STORE_SCHEDULES_IN_FLASH
 
         DSPrint("Saving tasks to file\n");
-        openFile(true, WRITE_ONLY);
-        if (!file || file.name() == nullptr) {
+
+        // Header and all records in one contiguous buffer, written with a single write()
+        std::vector<uint8_t> buf(sizeof(schedule_file_header_t) + tasks.size() * sizeof(schedule_record_t));
+        auto *header = reinterpret_cast<schedule_file_header_t *>(buf.data());
+        memcpy(header->magic, "SGS", 3);
+        header->version = SCHEDULE_FILE_VERSION;
+        header->recordSize = sizeof(schedule_record_t);
+        header->count = tasks.size();
+        auto *records = reinterpret_cast<schedule_record_t *>(buf.data() + sizeof(schedule_file_header_t));
+        for (size_t i = 0; i < tasks.size(); i++) {
+            toRecord(tasks[i], records[i]);
+        }
+
+        // Write the new file aside, then swap it in; the journal stays valid until the swap is done
+        closeFile();
+        File tmp = SCHEDULE_FS.open(tempFilePath, "w");
+        if (!tmp) {
             DSPrint("Failed to open file for writing\n");
             return false;
         }
-        closeFile();
-
-        for (auto &task: tasks) {
-            writeTaskToFile(&task);
+        bool written = tmp.write(buf.data(), buf.size()) == buf.size();
+        tmp.close();
+        if (!written) {
+            DSPrint("Failed to write tasks to file\n");
+            SCHEDULE_FS.remove(tempFilePath);
+            return false;
+        }
+        SCHEDULE_FS.remove(filePath);
+        if (!SCHEDULE_FS.rename(tempFilePath, filePath)) {
+            DSPrint("Failed to rename %s\n", tempFilePath.c_str());
+            return false;
         }
+        SCHEDULE_FS.remove(journalFilePath);
+        _journalEntries = 0;
         DSPrint("Tasks saved to file\n");
+        return true;
 
 #elif defined(STORE_SCHEDULES_IN_DATABASE)
 
-        String tasksArrayStr = toArray();
-        if (tasksArrayStr == "[]") {
+        if (!databaseReady())
+            return false;
+
+        String tasksObjectStr = toObject();
+        if (tasksObjectStr == "{}") {
             // Schedule is empty, remove all tasks from database
             DSPrint("Removing all tasks from database\n");
             dbObj->rtdb->remove(
@@ -352,11 +1031,11 @@ public:
                     });
         } else {
             DSPrint("Saving tasks to database\n");
-            DSPrint(">>>>>>>>> \n%s\n", tasksArrayStr.c_str());
+            DSPrint(">>>>>>>>> \n%s\n", tasksObjectStr.c_str());
             dbObj->rtdb->set<object_t>(
                     *dbObj->client,
                     getPath(),
-                    (object_t) tasksArrayStr,
+                    (object_t) tasksObjectStr,
                     [](AsyncResult &res) {
                         if (res.isError()) {
                             DSPrint("> Failed to save tasks to database\n");
@@ -390,12 +1069,16 @@ public:
             DSPrint("Max tasks reached\n");
             return false;
         }
-        tasks.push_back(task);
+        if (!task.args) {
+            DSPrint("Task has no args\n");
+            return false;
+        }
+        tasks.push_back(std::move(task));
+        _invalidateIndex();
 #ifdef STORE_SCHEDULES_IN_FLASH
-        return writeTaskToFile(&task);
+        return appendJournal(schedule_journal_entry_t::UPSERT, tasks.back());
 #elif defined(STORE_SCHEDULES_IN_DATABASE)
-        DSPrint("Syncing task to database\n");
-        return save();
+        return syncTask(tasks.back());
 #endif
 
     }
@@ -412,8 +1095,8 @@ public:
         bool found = false;
         for (auto it = tasks.begin(); it != tasks.end(); ++it) {
             if (it->id == id) {
-                delete it->args;
                 tasks.erase(it);
+                _invalidateIndex();
                 found = true;
                 break;
             }
@@ -422,8 +1105,13 @@ public:
             DSPrint("> Task not found\n");
             return false;
         }
-        DSPrint("> Task removed, syncing to database\n");
-        return save();
+#ifdef STORE_SCHEDULES_IN_FLASH
+        schedule_task_t<T> removed{};
+        removed.id = id;
+        return appendJournal(schedule_journal_entry_t::REMOVE, removed);
+#elif defined(STORE_SCHEDULES_IN_DATABASE)
+        return syncRemove(id);
+#endif
     }
 
     /**
@@ -436,11 +1124,31 @@ public:
      */
     bool updateTask(uint8_t id, schedule_task_t<T> task) {
         DSPrint("Updating task [%d] in schedule\n", id);
-        for (auto t: tasks) {
+        if (!task.args) {
+            DSPrint("> Task has no args\n");
+            return false;
+        }
+        for (auto &t: tasks) {
             if (t.id == id) {
-                t = task;
-                DSPrint("> Task updated, syncing to database\n");
-                return save();
+                // An edit must not make a task that just ran fire again within the grace window
+                time_t lastRun = t.lastRun;
+                t = std::move(task);
+                t.lastRun = lastRun;
+                _invalidateIndex();
+#ifdef STORE_SCHEDULES_IN_FLASH
+                if (t.id != id) {
+                    schedule_task_t<T> removed{};
+                    removed.id = id;
+                    if (!appendJournal(schedule_journal_entry_t::REMOVE, removed))
+                        return false;
+                }
+                return appendJournal(schedule_journal_entry_t::UPSERT, t);
+#elif defined(STORE_SCHEDULES_IN_DATABASE)
+                if (t.id != id) {
+                    syncRemove(id);
+                }
+                return syncTask(t);
+#endif
             }
         }
         DSPrint("> Task not found\n");
@@ -452,15 +1160,16 @@ public:
      * @brief Get the Task By task id
      *
      * @param id
-     * @return schedule_task_t
+     * @return pointer to the task owned by the scheduler, nullptr if not found.
+     * Invalidated by any change to the schedule
      */
-    schedule_task_t<T> getTaskById(uint8_t id) {
-        for (auto task: tasks) {
+    const schedule_task_t<T> *getTaskById(uint8_t id) const {
+        for (auto &task: tasks) {
             if (task.id == id) {
-                return task;
+                return &task;
             }
         }
-        return {};
+        return nullptr;
     }
 
 
@@ -515,7 +1224,7 @@ public:
      *
      * @param callback
      */
-    void setCallback(std::function<void(schedule_task_t<T>)> callback) {
+    void setCallback(std::function<void(const schedule_task_t<T> &)> callback) {
         _callbackFn = callback;
     }
 
@@ -533,48 +1242,30 @@ public:
             DSPrint("Failed to load tasks from database\n");
             DSPrint("> msg: %s, code: %d\n", _loadResult.error().message().c_str(), _loadResult.error().code());
             _loadResult.clear();
+            _loadPending = false;
             return;
         } else if (_loadResult.available()) {
             DSPrint("Got response from database\n");
-            DSPrint("Payload: %s\n", _loadResult.payload().c_str());
+            DSPrint("Payload: %s\n", _loadResult.c_str());
 
-            // Remove [ and ]
-            String tasksString = _loadResult.payload().substring(1, _loadResult.payload().length() - 1);
-            tasksString.replace("\"", "");
+            // Parsed straight from the response buffer, no copy of the payload
+            const char *payload = _loadResult.c_str();
+            bool legacyArray = payload[0] == '[';
 
+            auto lastRuns = getLastRuns();
             tasks.clear();
+            parseTasks(payload, tasks, MAX_TASKS);
 
-            const char *start = tasksString.c_str();
-            const char *ptr = tasksString.c_str();
-            uint32_t index = 0;
-            while (true) {
-                uint32_t cur_index = ptr - start;
-                if (*ptr == ',' || cur_index == tasksString.length()) {
-                    String taskStr = tasksString.substring(index, cur_index);
-                    index = ptr - start + 1;
-
-                    DSPrint("> Parsing task: %s\n", taskStr.c_str());
-
-                    auto task = parseTask(taskStr);
-                    if (task.id) {
-                        tasks.push_back(task);
-                        DSPrint(">> Task parsed successfully\n");
-                        if (tasks.size() >= MAX_TASKS) {
-                            DSPrint(">> Max tasks reached. Stop parsing\n");
-                            break;
-                        }
-                    } else {
-                        DSPrint(">> Task parsing failed\n");
-                    }
-                }
-                if (cur_index == tasksString.length()) {
-                    break;
-                }
-                ptr++;
-            }
-
-            DSPrint("Tasks loaded from database (%d tasks)\n", tasks.size());
+            DSPrint("Tasks loaded from database (%d tasks)\n", (int) tasks.size());
             _loadResult.clear();
+            _loadPending = false;
+            restoreLastRuns(lastRuns);
+            _invalidateIndex();
+
+            if (legacyArray && !tasks.empty()) {
+                DSPrint("Migrating schedules to keyed format\n");
+                save();
+            }
 
 #ifdef DEBUG_SCHEDULER
             printToSerial(Serial);
@@ -593,48 +1284,71 @@ public:
         }
 
         // Get current time
-        if (time(nullptr) <= 1609459200) {
+        time_t now;
+        time(&now);
+        if (now <= 1609459200) {
             // Time is not set (2021-01-01)
             return;
         }
-        time_t now;
-        time(&now);
-        _timeinfo = localtime(&now);
-        uint8_t h = _timeinfo->tm_hour;
-        uint8_t m = _timeinfo->tm_min;
-        uint8_t dow = _timeinfo->tm_wday; // 0 = Sunday
-        bool anychange = false;
+        if (!_bootTime) {
+            _bootTime = now - millis() / 1000;
+        }
 
-        DSPrint("Current time: %d, %02d:%02d\n", dow, h, m);
-        for (auto &task: tasks) {
-            if (task.enabled) {
-                if ((task.repeat.monday && dow == 1) ||
-                    (task.repeat.tuesday && dow == 2) ||
-                    (task.repeat.wednesday && dow == 3) ||
-                    (task.repeat.thursday && dow == 4) ||
-                    (task.repeat.friday && dow == 5) ||
-                    (task.repeat.saturday && dow == 6) ||
-                    (task.repeat.sunday && dow == 0)) {
-                    if (task.time.hour == h && task.time.minute == m) {
-                        if (!task.executed) {
-                            DSPrint("> Executing task [%d]\n", task.id);
-                            task.executed = true;
-                            anychange = true;
-                            if (_callbackFn)
-                                _callbackFn(task);
-                        }
-                    } else if (task.executed) {
-                        DSPrint("> Reset task [%d]\n", task.id);
-                        task.executed = false;
-                        anychange = true;
-                    }
+        // Rebuild after schedule changes, when the clock went backwards, and hourly so DST/timezone
+        // changes are picked up
+        if (_indexDirty || now < _lastCheck || now >= _lastCheck + 3600) {
+            _rebuildIndex(now);
+            _lastCheck = now;
+        }
+
+        // Nothing due: a single comparison
+        while (!_dueQueue.empty() && _dueQueue.front().due <= now) {
+            std::pop_heap(_dueQueue.begin(), _dueQueue.end(), _dueLater);
+            schedule_due_t entry = _dueQueue.back();
+            _dueQueue.pop_back();
+            auto &task = tasks[entry.taskIndex];
+
+            if (now - entry.due > graceSeconds) {
+                // The loop stalled past the grace window, skip this run
+                DSPrint("> Missed task [%d] due %ld s ago\n", task.id, (long) (now - entry.due));
+                _pushDue(nextRunTime(task, std::max<time_t>(entry.due + 1, now - graceSeconds)), entry.taskIndex);
+                continue;
+            }
+
+            // Runs that also came due while stalled are coalesced into this one
+            DSPrint("> Executing task [%d]\n", task.id);
+            task.lastRun = now;
+            _pushDue(nextRunTime(task, now + 1), entry.taskIndex);
+            if (_callbackFn) {
+                // A copy: the callback may add or remove tasks, which moves the vector
+                schedule_task_t<T> run = copyTask(task);
+                if (run.args) {
+                    _callbackFn(run);
+                } else {
+                    DSPrint("> No args slot to run task [%d]\n", run.id);
                 }
             }
+            if (_indexDirty) {
+                // Callback changed the schedule, the queue is no longer valid
+                break;
+            }
         }
+    }
 
-        if (anychange) {
-            save();
-        }
+    /**
+     * @brief Time of the next pending run, so the caller can sleep until then
+     *
+     * @return epoch, 0 if nothing is pending, a database load is in flight or the queue must be
+     * rebuilt by run() first
+     */
+    time_t nextDueTime() const {
+#ifdef STORE_SCHEDULES_IN_DATABASE
+        if (_loadPending)
+            return 0;
+#endif
+        if (_indexDirty || _dueQueue.empty())
+            return 0;
+        return std::min<time_t>(_dueQueue.front().due, _lastCheck + 3600);
     }
 
 
@@ -644,32 +1358,27 @@ public:
      * @param serial 
      */
     void printToSerial(Stream &stream) {
-        stream.printf("Task count: %d\n\n", tasks.size());
+        stream.printf("Task count: %d\n\n", (int) tasks.size());
         for (auto &task: tasks) {
-            stream.printf("Task %d: %02d:%02d\nrepeat: %d|%d|%d|%d|%d|%d|%d\nargs: %s\nenabled: %d\nexecuted: %d\n\n",
+            stream.printf("Task %d: %s\nrepeat: %s\nevery: %d s until %s\nargs: %s\nenabled: %d\nlast run: %ld\n\n",
                           task.id,
-                          task.time.hour,
-                          task.time.minute,
-                          task.repeat.monday,
-                          task.repeat.tuesday,
-                          task.repeat.wednesday,
-                          task.repeat.thursday,
-                          task.repeat.friday,
-                          task.repeat.saturday,
-                          task.repeat.sunday,
+                          task.time.toString().c_str(),
+                          task.repeat.toString().c_str(),
+                          task.interval,
+                          task.until.toString().c_str(),
                           task.args->toString().c_str(),
                           task.enabled,
-                          task.executed);
+                          (long) task.lastRun);
         }
 
 #ifdef STORE_SCHEDULES_IN_FLASH
         Serial.println("======== Read from file ========");
         openFile(false, READ_ONLY);
 
-        Serial.printf("File size: %d\n", file.size());
-        while (file.available()) {
-            Serial.print("[Task] ");
-            Serial.println(file.readStringUntil('\n'));
+        Serial.printf("File size: %d\n", (int) file.size());
+        schedule_file_header_t header{};
+        if (file.read((uint8_t *) &header, sizeof(header)) == sizeof(header)) {
+            Serial.printf("Version: %d, records: %d x %d bytes\n", header.version, header.count, header.recordSize);
         }
 
         Serial.println("=========== End file ===========");
@@ -683,14 +1392,15 @@ public:
 #ifdef STORE_SCHEDULES_IN_FLASH
 
     /**
-         * @brief Get the String object
+         * @brief Get the tasks as text, one task per line
          *
          * @return String
          */
         String getString() {
-            openFile(false, READ_ONLY);
-            String result = file.readString();
-            closeFile();
+            String result = "";
+            for (auto &task: tasks) {
+                result += taskToString(task) + "\n";
+            }
             if (result.length() == 0) {
                 result = "EMPTY";
             }
@@ -704,107 +1414,306 @@ public:
      * @return
      */
     String toArray() {
-        String tasksArrayStr = "";
-        for (auto task: tasks) {
+        String tasksArrayStr = "[";
+        tasksArrayStr.reserve(2 + tasks.size() * 34);
+        for (auto &task: tasks) {
+            if (tasksArrayStr.length() > 1)
+                tasksArrayStr += ",";
             tasksArrayStr += "\"";
-            tasksArrayStr += String(task.id) + "|";
-            tasksArrayStr += String(task.time.hour) + "|";
-            tasksArrayStr += String(task.time.minute) + "|";
+            tasksArrayStr += taskToString(task);
+            tasksArrayStr += "\"";
+        }
+        tasksArrayStr += "]";
+        return tasksArrayStr;
+    }
+
+    /**
+     * @brief Get the schedules as the keyed object stored in database: {"t<id>":"<task>",...}
+     * @return
+     */
+    String toObject() {
+        String out = "{";
+        out.reserve(2 + tasks.size() * 40);
+        for (auto &task: tasks) {
+            if (out.length() > 1)
+                out += ",";
+            out += "\"";
+            out += taskKey(task.id);
+            out += "\":\"";
+            out += taskToString(task);
+            out += "\"";
+        }
+        out += "}";
+        return out;
+    }
+
+#endif
 
-//            tasksArrayStr += task.repeat.monday ? "1" : "0";
-//            tasksArrayStr += task.repeat.tuesday ? "1" : "0";
-//            tasksArrayStr += task.repeat.wednesday ? "1" : "0";
-//            tasksArrayStr += task.repeat.thursday ? "1" : "0";
-//            tasksArrayStr += task.repeat.friday ? "1" : "0";
-//            tasksArrayStr += task.repeat.saturday ? "1" : "0";
-//            tasksArrayStr += String(task.repeat.sunday ? "1" : "0") + "|";
-            tasksArrayStr += task.repeat.toString() + "|";
 
-            tasksArrayStr += task.args->toString() + "|";
-            tasksArrayStr += String(task.enabled ? "1" : "0") + "|";
-            tasksArrayStr += String(task.executed ? "1" : "0") + "\",";
+    /**
+     * @brief Format a task as text: id|hour|minute|repeat|args|enabled|executed, followed by
+     * |second|interval|untilHour|untilMinute for tasks that use them. `executed` is always 0,
+     * it is kept so older firmware can still read the schedule
+     *
+     * @param task
+     * @return String
+     */
+    static String taskToString(const schedule_task_t<T> &task) {
+        String out = "";
+        out.reserve(48);
+        out += String(task.id) + "|";
+        out += String(task.time.hour) + "|";
+        out += String(task.time.minute) + "|";
+        out += task.repeat.toString() + "|";
+        out += task.args->toString() + "|";
+        out += task.enabled ? "1|0" : "0|0";
+        if (task.time.second || task.interval) {
+            out += "|" + String(task.time.second);
+            out += "|" + String(task.interval);
+            out += "|" + String(task.until.hour);
+            out += "|" + String(task.until.minute);
         }
-        if (tasksArrayStr.length() > 0) {
-            // Remove last comma
-            tasksArrayStr = tasksArrayStr.substring(0, tasksArrayStr.length() - 1);
-            tasksArrayStr = "[" + tasksArrayStr + "]";
-            return tasksArrayStr;
+        return out;
+    }
+
+    /**
+     * @brief First run of a task at or after `after`
+     *
+     * @param task
+     * @param after epoch
+     * @return epoch, 0 if the task never runs
+     */
+    static time_t nextRunTime(const schedule_task_t<T> &task, time_t after) {
+        if (!task.repeat.mask)
+            return 0;
+        struct tm day{};
+        localtime_r(&after, &day);
+        // 8 days: today's run may already be over, the same weekday next week is the latest candidate
+        for (uint8_t d = 0; d <= 7; d++) {
+            struct tm t = day;
+            t.tm_mday += d;
+            t.tm_hour = task.time.hour;
+            t.tm_min = task.time.minute;
+            t.tm_sec = task.time.second;
+            t.tm_isdst = -1;
+            time_t start = mktime(&t); // also normalizes tm_wday
+            if (start == (time_t) -1 || !task.repeat.on(t.tm_wday))
+                continue;
+            if (!task.interval) {
+                if (start >= after)
+                    return start;
+                continue;
+            }
+            struct tm u = t;
+            u.tm_hour = task.until.hour;
+            u.tm_min = task.until.minute;
+            u.tm_sec = 0;
+            u.tm_isdst = -1;
+            time_t end = mktime(&u);
+            time_t due = start;
+            if (after > start)
+                due = start + (after - start + task.interval - 1) / task.interval * task.interval;
+            if (due <= end)
+                return due;
         }
-        return "[]";
+        return 0;
     }
 
-#endif
+    /**
+     * @brief Copy a task, its args into a new pool slot
+     *
+     * @param task
+     * @return schedule_task_t, empty args if the pool is exhausted
+     */
+    static schedule_task_t<T> copyTask(const schedule_task_t<T> &task) {
+        schedule_task_t<T> copy{};
+        copy.id = task.id;
+        copy.time = task.time;
+        copy.repeat = task.repeat;
+        copy.enabled = task.enabled;
+        copy.interval = task.interval;
+        copy.until = task.until;
+        copy.lastRun = task.lastRun;
+        if (task.args) {
+            copy.args = ScheduleArgsPool<T>::create(*task.args);
+        }
+        return copy;
+    }
+
+    /**
+     * @brief Pack a task into a fixed-size binary record
+     *
+     * @param task
+     * @param record
+     */
+    static void toRecord(const schedule_task_t<T> &task, schedule_record_t &record) {
+        memset(&record, 0, sizeof(record));
+        record.id = task.id;
+        record.hour = task.time.hour;
+        record.minute = task.time.minute;
+        record.second = task.time.second;
+        record.repeat = task.repeat.mask;
+        record.flags = task.enabled ? 0x01 : 0;
+        record.interval = task.interval;
+        record.untilHour = task.until.hour;
+        record.untilMinute = task.until.minute;
+        if (task.args) {
+            record.argsLength = task.args->pack(record.args, SCHEDULE_RECORD_ARGS_SIZE);
+        }
+    }
+
+    /**
+     * @brief Unpack a task from a binary record
+     *
+     * @param record
+     * @return schedule_task_t
+     */
+    static schedule_task_t<T> fromRecord(const schedule_record_t &record) {
+        schedule_task_t<T> task{};
+        task.id = record.id;
+        task.time.hour = record.hour;
+        task.time.minute = record.minute;
+        task.time.second = record.second;
+        task.repeat.mask = record.repeat & schedule_repeat_t::EVERYDAY;
+        task.enabled = record.flags & 0x01;
+        task.interval = record.interval;
+        task.until = {record.untilHour, record.untilMinute, 0};
+        task.args = ScheduleArgsPool<T>::create();
+        if (task.args)
+            task.args->unpack(record.args, std::min<size_t>(record.argsLength, SCHEDULE_RECORD_ARGS_SIZE));
+        return task;
+    }
 
+    static schedule_task_t<T> fromRecord(const schedule_record_v1_t &record) {
+        return fromRecord(record.upgrade());
+    }
 
     /**
      * @brief Parse a task from string
      * 
      * @param task 
-     * @return schedule_task_t 
+     * @return schedule_task_t, id = 0 if the format is invalid
      */
     static schedule_task_t<T>
     parseTask(const String &task) {
         schedule_task_t<T> result{};
-        result.id = 0;
-        result.args = new T();
-        uint8_t count = 0;
-        int last_pos = 0;
-        std::vector<uint8_t> values;
-        String repeat = "";
-        String args = "";
-
-        // Task format: id|hour|minute|repeat|args|enabled|executed
+        result.args = ScheduleArgsPool<T>::create();
+        if (!result.args || !parseTask(task.c_str(), task.length(), result)) {
+            result.id = 0;
+        }
+        return result;
+    }
 
-        while ((unsigned int) last_pos < task.length()) {
-            int pos = task.indexOf("|", last_pos);
-            if (pos < 0) pos = task.length();
+    /**
+     * @brief Parse a task from a span of text in place, without intermediate copies
+     *
+     * @param str task text: id|hour|minute|repeat|args|enabled|executed[|second|interval|untilHour|untilMinute]
+     * (not null terminated)
+     * @param length
+     * @param result filled in place, `args` must already be allocated
+     * @return true
+     * @return false if the format is invalid
+     */
+    static bool parseTask(const char *str, size_t length, schedule_task_t<T> &result) {
+        const char *fields[11];
+        size_t lengths[11];
+        const char *end = str + length;
+        uint8_t count = 0;
 
-            // repeat part
-            if (count == 3) {
-                repeat = task.substring(last_pos, pos);
-            }
-                // args part
-            else if (count == 4) {
-                args = task.substring(last_pos, pos);
-            }
-                // other parts
-            else {
-                uint8_t num = (uint8_t) task.substring(last_pos, pos).toInt();
-                values.push_back(num);
-            }
-            last_pos = pos + 1;
-            ++count;
+        while (count < 11) {
+            auto *sep = static_cast<const char *>(memchr(str, '|', end - str));
+            fields[count] = str;
+            lengths[count] = (sep ? sep : end) - str;
+            count++;
+            if (sep == nullptr)
+                break;
+            str = sep + 1;
         }
 
-        if (values.size() != 5 || repeat == "" || args == "") {
+        if ((count != 7 && count != 11) || memchr(fields[count - 1], '|', lengths[count - 1]) != nullptr ||
+            !lengths[3] || !lengths[4]) {
             Serial.println("Invalid task format");
-            return result;
+            return false;
         }
 
-        // Parse repeat days
-        result.repeat.monday = repeat.charAt(0) == '1';
-        result.repeat.tuesday = repeat.charAt(1) == '1';
-        result.repeat.wednesday = repeat.charAt(2) == '1';
-        result.repeat.thursday = repeat.charAt(3) == '1';
-        result.repeat.friday = repeat.charAt(4) == '1';
-        result.repeat.saturday = repeat.charAt(5) == '1';
-        result.repeat.sunday = repeat.charAt(6) == '1';
-
-        // Parse args
-        result.args->parse(args);
+        result.id = (uint8_t) ScheduleTaskArgsBase::toInt(fields[0], lengths[0]);
+        result.time.hour = (uint8_t) ScheduleTaskArgsBase::toInt(fields[1], lengths[1]);
+        result.time.minute = (uint8_t) ScheduleTaskArgsBase::toInt(fields[2], lengths[2]);
+        result.time.second = 0;
+        result.repeat = schedule_repeat_t::fromString(fields[3], lengths[3]);
+        result.args->parse(fields[4], lengths[4]);
+        result.enabled = ScheduleTaskArgsBase::toInt(fields[5], lengths[5]) != 0;
+        // fields[6] (executed) is ignored, it is runtime state
+        result.interval = 0;
+        result.until = {};
+        if (count == 11) {
+            result.time.second = (uint8_t) ScheduleTaskArgsBase::toInt(fields[7], lengths[7]);
+            long interval = ScheduleTaskArgsBase::toInt(fields[8], lengths[8]);
+            result.until.hour = (uint8_t) ScheduleTaskArgsBase::toInt(fields[9], lengths[9]);
+            result.until.minute = (uint8_t) ScheduleTaskArgsBase::toInt(fields[10], lengths[10]);
+            if (!isValidInterval(interval, result.time, result.until)) {
+                Serial.println("Invalid task interval");
+                return false;
+            }
+            result.interval = (uint16_t) interval;
+        }
+        return true;
+    }
 
-        // Assign values
-        result.id = values[0];
-        result.time.hour = values[1];
-        result.time.minute = values[2];
-        result.enabled = values[3];
-        result.executed = values[4];
+    /**
+     * @brief Check an interval window. `until` is taken at second 0 and must not be before `time`,
+     * a window past midnight is not supported
+     *
+     * @param interval seconds, 0 for a single run at `time`
+     * @param time first run of the day
+     * @param until last possible run of the day
+     * @return false if the interval does not fit the uint16_t field or the window is empty
+     */
+    static bool isValidInterval(long interval, const schedule_time_t &time, const schedule_time_t &until) {
+        if (interval == 0)
+            return true;
+        if (interval < 0 || interval > UINT16_MAX)
+            return false;
+        uint32_t start = time.hour * 3600UL + time.minute * 60UL + time.second;
+        uint32_t end = until.hour * 3600UL + until.minute * 60UL;
+        return end >= start;
+    }
 
-        return result;
+    /**
+     * @brief Parse all tasks of a database payload in a single pass over the buffer.
+     * Accepts the keyed object {"t<id>":"<task>",...} and the legacy array ["<task>",...]
+     *
+     * @param payload null terminated JSON
+     * @param out tasks are appended in place
+     * @param maxTasks stop once `out` holds this many tasks
+     * @return number of tasks appended
+     */
+    static size_t parseTasks(const char *payload, std::vector<schedule_task_t<T>> &out, size_t maxTasks) {
+        size_t added = 0;
+        const char *ptr = payload;
+        // Every quoted value containing '|' is a task, keys never do
+        while (out.size() < maxTasks && (ptr = strchr(ptr, '"')) != nullptr) {
+            const char *end = strchr(++ptr, '"');
+            if (end == nullptr)
+                break;
+            if (memchr(ptr, '|', end - ptr) != nullptr) {
+                out.emplace_back();
+                auto &task = out.back();
+                task.args = ScheduleArgsPool<T>::create();
+                if (task.args && parseTask(ptr, end - ptr, task) && task.id) {
+                    added++;
+                } else {
+                    DSPrint(">> Task parsing failed\n");
+                    out.pop_back();
+                }
+            }
+            ptr = end + 1;
+        }
+        return added;
     }
 
     /**
-     * @brief Parse time from string format "HH:MM"
+     * @brief Parse time from string format "HH:MM" or "HH:MM:SS"
      * @param time
      * @return schedule_time_t
      */
@@ -816,6 +1725,10 @@ public:
         }
         result.hour = (uint8_t) time.substring(0, pos).toInt();
         result.minute = (uint8_t) time.substring(pos + 1).toInt();
+        int secPos = time.indexOf(":", pos + 1);
+        if (secPos > 0) {
+            result.second = (uint8_t) time.substring(secPos + 1).toInt();
+        }
         return result;
     }
 
@@ -827,7 +1740,7 @@ public:
         uint8_t id = 0;
         do {
             id = static_cast<uint8_t>(rand());
-        } while (getTaskById(id).id != 0);
+        } while (id == 0 || getTaskById(id) != nullptr);
         return id;
     }
 };
\ No newline at end of file
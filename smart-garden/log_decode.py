@@ -0,0 +1,80 @@
+#
+# Decode the binary log segments (lib/Logger/LogRecord.h) into "<epoch> <event>-<source>-<message>" lines
+#
+# usage: python log_decode.py [--from EPOCH] [--to EPOCH] [--iso] FILE...
+#   FILE: segment files (slog_<n>.seg) or the output of /logs?format=raw, "-" for stdin
+#
+import argparse
+import struct
+import sys
+from datetime import datetime, timezone
+
+SEGMENT_MAGIC = 0x32474C53  # "SLG2"
+SEGMENT_HEADER = struct.Struct('<6I')  # magic, seq, firstTime, lastTime, lines, size
+RECORD_HEADER = struct.Struct('<IBBB')  # time, event, source, length
+RECORD_DEFINE = 0xFF
+RECORD_NONE = 0
+
+
+def split_segments(data):
+    """Yield (seq, records) for each segment in a file or a raw stream"""
+    pos = 0
+    while pos + SEGMENT_HEADER.size <= len(data):
+        magic, seq, _, _, _, size = SEGMENT_HEADER.unpack_from(data, pos)
+        if magic != SEGMENT_MAGIC:
+            break
+        start = pos + SEGMENT_HEADER.size
+        end = min(start + size, len(data))
+        yield seq, data[start:end]
+        pos = end
+
+
+def decode_records(records):
+    """Yield (time, line) for the records of one segment, stopping at a damaged one"""
+    names = {}
+    pos = 0
+    while pos + RECORD_HEADER.size + 1 <= len(records):
+        time, event, source, length = RECORD_HEADER.unpack_from(records, pos)
+        end = pos + RECORD_HEADER.size + length
+        if end >= len(records) or records[end] != length:
+            break
+        payload = records[pos + RECORD_HEADER.size:end].decode('utf-8', 'replace')
+        pos = end + 1
+        if event == RECORD_DEFINE:
+            names[source] = payload
+        elif event == RECORD_NONE:
+            yield time, payload
+        else:
+            source_name = names.get(source, '?') if source != RECORD_NONE else ''
+            yield time, '{}-{}-{}'.format(names.get(event, '?'), source_name, payload)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode smart-garden binary log segments')
+    parser.add_argument('files', nargs='+')
+    parser.add_argument('--from', dest='start', type=int, default=0, help='epoch, inclusive')
+    parser.add_argument('--to', dest='end', type=int, default=0xFFFFFFFF, help='epoch, inclusive')
+    parser.add_argument('--iso', action='store_true', help='print UTC dates instead of epochs')
+    args = parser.parse_args()
+
+    segments = {}
+    for name in args.files:
+        if name == '-':
+            data = sys.stdin.buffer.read()
+        else:
+            with open(name, 'rb') as f:
+                data = f.read()
+        for seq, records in split_segments(data):
+            segments[seq] = records
+
+    # Oldest segment first
+    for seq in sorted(segments):
+        for time, line in decode_records(segments[seq]):
+            if time < args.start or time > args.end:
+                continue
+            stamp = datetime.fromtimestamp(time, timezone.utc).isoformat() if args.iso else str(time)
+            print('{} {}'.format(stamp, line))
+
+
+if __name__ == '__main__':
+    main()
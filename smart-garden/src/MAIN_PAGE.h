@@ -1,104 +1,144 @@
-const char *MAINPAGE = R"html(
-<!DOCTYPE html><html lang="en"><head><meta charset="UTF-8"><meta name="viewport" content="width=device-width,initial-scale=1"><title>C21.20 Garden</title><link href="https://cdn.jsdelivr.net/npm/bootstrap@5.3.3/dist/css/bootstrap.min.css" rel="stylesheet" integrity="sha384-QWTKZyjpPEjISv5WaRU9OFeRpok6YctnYmDr5pNlyT2bRjXh0JMhjY6hW+ALEwIH" crossorigin="anonymous"><style>.main-content{margin-top:40px;max-width:600px}.loading{position:fixed;top:0;left:0;width:100%;height:100%;z-index:99999;backdrop-filter:blur(3px);display:flex;justify-content:center;align-items:center}.loading-container{width:max-content;height:max-content;padding:20px;border-radius:18px;display:flex;justify-content:center;align-items:center;background:rgba(0 0 0 / 25%)}.card{border-radius:18px;border-width:0;box-shadow:0 0 10px rgba(0,0,0,.1);margin-bottom:40px}.form-switch input{height:2em!important;width:4em!important}.form-switch label{margin-top:3px!important;margin-left:14px!important;font-size:1.4em!important}.form-range::-webkit-slider-runnable-track{background-color:transparent}.form-range:disabled{visibility:hidden}</style></head><body><div class="d-none loading fade"><div class="loading-container"><span class="text-white fs-4 fade" id="notify-text"></span><div class="spinner-border text-white" style="width:80px;height:80px" role="status"><span class="visually-hidden">Loading...</span></div></div></div><div class="container-fluid"><div class="row justify-content-center"><div class="main-content col"><div class="card"><div class="card-body"><div class="form-check form-switch"><input class="form-check-input" type="checkbox" role="switch" id="VALVE" checked-label="OPEN" uncheck-label="CLOSE"><label class="form-check-label" for="flexSwitchCheckDefault">VALVE</label></div></div></div><div class="card"><div class="card-body"><div class="form-check form-switch"><input class="form-check-input" type="checkbox" role="switch" id="WATER_LEAK" disabled="disabled"><label class="form-check-label" for="flexSwitchCheckDefault">WATER LEAK</label></div></div></div><hr class="my-5"><div class="card"><div class="card-body"><div class="form-check form-switch"><input class="form-check-input" type="checkbox" role="switch" id="R1"><label class="form-check-label" for="flexSwitchCheckDefault">R1</label></div></div></div><div class="card"><div class="card-body"><div class="form-check form-switch"><input class="form-check-input" type="checkbox" role="switch" id="R2"><label class="form-check-label" for="flexSwitchCheckDefault">R2</label></div></div></div><div class="card"><div class="card-body"><div class="form-check form-switch"><input class="form-check-input" type="checkbox" role="switch" id="R3"><label class="form-check-label" for="flexSwitchCheckDefault">R3</label></div></div></div><div class="card"><div class="card-body"><div class="form-check form-switch"><input class="form-check-input" type="checkbox" role="switch" id="R4"><label class="form-check-label" for="flexSwitchCheckDefault">R4</label></div></div></div></div></div></div><script src="https://cdn.jsdelivr.net/npm/bootstrap@5.3.3/dist/js/bootstrap.bundle.min.js" integrity="sha384-YvpcrYf0tY3lHB60NNkmXc5s9fDVZLESaAA55NDzOxhy9GkcIdslK1eN7N6jIeHz" crossorigin="anonymous"></script><script>const LOADING = new class {
-constructor() {
-this.el = document.querySelector('.loading')
-this.spiner = this.el.querySelector('.spinner-border')
-this.text = this.el.querySelector('#notify-text')
-this.showDelay = null
-this.showCB = null
-this.hideDelay = null
-}
-show(timeout = 0, timeoutCB = null) {
-this.el.classList.remove('d-none')
-this.spiner.classList.remove('d-none')
-this.text.innerHTML = ''
-this.text.classList.remove('show')
-clearTimeout(this.showDelay)
-clearTimeout(this.showCB)
-clearTimeout(this.hideDelay)
-this.showDelay = setTimeout(() => this.el.classList.add('show'), 100)
-if (timeout) {
-this.showCB = setTimeout(() => {
-this.hide()
-if (timeoutCB) timeoutCB()
-}, timeout)
-}
-}
-hide() {
-this.el.classList.remove('show')
-clearTimeout(this.showDelay)
-clearTimeout(this.showCB)
-clearTimeout(this.hideDelay)
-this.hideDelay = setTimeout(() => this.el.classList.add('d-none'), 100)
-}
-setText(text, timeout = 0, timeoutCB = null) {
-this.show()
-this.text.innerHTML = text
-this.spiner.classList.add('d-none')
-this.text.classList.add('show')
-if (timeout) {
-this.showCB = setTimeout(() => {
-this.hide()
-if (timeoutCB) timeoutCB()
-}, timeout)
-}
-}
-}
-function setSwitchState(id, state) {
-const el = document.getElementById(id)
-if (!el) return
-['ON', 'OPEN', 'LEAK'].some(s => s == state) ? el.checked = true : el.checked = false
-}</script><script>var ws
-const wsReconnectInterval = 5000
-function connectWS() {
-ws = new WebSocket(`ws://${location.host}/ws`)
-ws.onmessage = (e) => {
-LOADING.hide()
-const message = e.data
-console.log('[WS Received]', message)
-if (!message) return
-message.split('\n')
-.forEach(m => {
-if (!m.includes(':')) return
-const [id, state] = m.split(':')
-setSwitchState(id, state)
-});
-}
-ws.onopen = () => {
-console.log('[WS Opened]')
-LOADING.hide()
-}
-ws.onclose = () => {
-console.log('[WS Closed]')
-LOADING.show(5000, () => {
-LOADING.setText('Mất kết nối. Đang kết nối lại.', 100000)
-setTimeout(connectWS, wsReconnectInterval)
-})
-}
-ws.onerror = () => {
-console.log('[WS Error]')
-LOADING.show(5000, () => {
-LOADING.setText('Lỗi: kết nối thất bại. Đang kết nối lại.', 100000)
-setTimeout(connectWS, wsReconnectInterval)
-})
-}
-}
-LOADING.show(5000, () => setTimeout(connectWS, wsReconnectInterval))
-connectWS()
-document.querySelectorAll('.form-switch input').forEach(i => {
-i.addEventListener('change', e => {
-console.log(e.target.id, e.target.checked)
-LOADING.show(5000, () => {
-LOADING.setText('Lỗi: điều khiển thất bại', 3000)
-e.target.checked = !e.target.checked
-})
-let state = ''
-if (e.target.checked) {
-state = e.target.getAttribute('checked-label') || 'ON'
-} else {
-state = e.target.getAttribute('uncheck-label') || 'OFF'
-}
-ws.send(`${e.target.id}:${state}`)
-})
-})</script></body></html>
-)html";
\ No newline at end of file
+// Generated from src/main.html by web_page.py, do not edit
+#ifndef SMART_GARDEN_MAIN_PAGE_H
+#define SMART_GARDEN_MAIN_PAGE_H
+
+#include <Arduino.h>
+
+#define MAIN_PAGE_ETAG "\"b0299a61cfee4d15\""
+#define MAIN_PAGE_SIZE 6223 // before gzip
+
+const size_t MAIN_PAGE_GZ_LENGTH = 2072;
+const uint8_t MAIN_PAGE_GZ[] PROGMEM = {
+        0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xd5, 0x59, 0xdb, 0x5a, 0x1b, 0xc9,
+        0x11, 0xbe, 0xd7, 0x53, 0x34, 0x13, 0xef, 0x8e, 0xf4, 0x99, 0x19, 0x49, 0x9c, 0x62, 0x4b, 0x88,
+        0x04, 0x83, 0x6c, 0x13, 0xcb, 0xe0, 0x20, 0xd6, 0x2c, 0xeb, 0xf8, 0x8b, 0x5b, 0x33, 0x25, 0x4d,
+        0x43, 0xcf, 0x61, 0xbb, 0x7b, 0x24, 0x64, 0x56, 0x17, 0xfb, 0xed, 0x0b, 0x64, 0xaf, 0x72, 0x9d,
+        0x8b, 0xbc, 0x84, 0x7d, 0x91, 0x9b, 0x7d, 0x11, 0xde, 0x24, 0xd5, 0x73, 0x42, 0x83, 0x00, 0x6f,
+        0xcc, 0xb7, 0x49, 0x6c, 0xcc, 0x48, 0x5d, 0x5d, 0x55, 0x5d, 0xf5, 0xd7, 0x61, 0x6a, 0x86, 0xcd,
+        0xa5, 0xdd, 0x83, 0x9d, 0xa3, 0x93, 0x57, 0x5d, 0xe2, 0x29, 0x9f, 0x6f, 0x6d, 0xea, 0x2b, 0xe1,
+        0x34, 0x18, 0x75, 0x0c, 0x08, 0x0c, 0x5c, 0x03, 0x75, 0xb7, 0x36, 0x7d, 0x50, 0x94, 0x38, 0x1e,
+        0x15, 0x12, 0x54, 0xc7, 0xf8, 0xe6, 0xe8, 0xa9, 0xf5, 0xc8, 0xc8, 0xa8, 0x01, 0xf5, 0xa1, 0x63,
+        0x8c, 0x19, 0x4c, 0xa2, 0x50, 0x28, 0x83, 0x38, 0x61, 0xa0, 0x20, 0x40, 0xae, 0x09, 0x73, 0x95,
+        0xd7, 0x71, 0x61, 0xcc, 0x1c, 0xb0, 0x92, 0xc5, 0x32, 0x61, 0x01, 0x53, 0x8c, 0x72, 0x4b, 0x3a,
+        0x94, 0x43, 0xa7, 0x69, 0x37, 0x50, 0x8b, 0x62, 0x8a, 0xc3, 0xd6, 0xce, 0x4a, 0xd3, 0x5e, 0x69,
+        0x90, 0x67, 0x54, 0xb8, 0x10, 0x6c, 0xd6, 0x53, 0xe2, 0x26, 0x67, 0xc1, 0x19, 0xf1, 0x04, 0x0c,
+        0x3b, 0x86, 0xa7, 0x54, 0x24, 0x5b, 0xf5, 0xba, 0xe3, 0x06, 0xf6, 0xa9, 0x74, 0x81, 0xb3, 0xb1,
+        0xb0, 0x03, 0x50, 0xf5, 0x20, 0xf2, 0xeb, 0x83, 0x30, 0x54, 0x52, 0x09, 0x1a, 0xfd, 0x71, 0xdd,
+        0x5e, 0xb5, 0x57, 0xeb, 0x2e, 0x93, 0xaa, 0xee, 0x48, 0x79, 0xb5, 0x61, 0xfb, 0x2c, 0xb0, 0x91,
+        0x62, 0x10, 0x01, 0xbc, 0x63, 0x48, 0x35, 0xe5, 0x20, 0x3d, 0x00, 0xb4, 0x98, 0xa1, 0xc1, 0x23,
+        0xc1, 0xd4, 0x14, 0xc9, 0x1e, 0x5d, 0x7d, 0xb4, 0x66, 0xfd, 0xf9, 0xf8, 0xe8, 0xc5, 0x77, 0xd3,
+        0xd3, 0xe8, 0x55, 0xf7, 0x74, 0xaf, 0x3f, 0x5e, 0x3f, 0xa6, 0x87, 0xdf, 0x3c, 0x3e, 0x78, 0x0a,
+        0x87, 0x51, 0x78, 0xb6, 0x71, 0xe2, 0xa8, 0xe0, 0xc4, 0xdf, 0x15, 0xeb, 0xd1, 0x3e, 0x9f, 0x1e,
+        0xad, 0x0c, 0x0e, 0x4f, 0xbf, 0xf5, 0x1a, 0x7f, 0x7a, 0xe9, 0x9d, 0x9e, 0x6c, 0x78, 0xc7, 0x0f,
+        0xb7, 0x7b, 0xdd, 0xc9, 0xde, 0x73, 0x44, 0x41, 0x84, 0x52, 0x86, 0x82, 0x8d, 0x58, 0xd0, 0x31,
+        0x68, 0x10, 0x06, 0x53, 0x3f, 0x8c, 0x25, 0x7a, 0x9b, 0x1c, 0xbc, 0x65, 0xfb, 0x94, 0x05, 0x56,
+        0x06, 0x15, 0xb9, 0xf0, 0xa9, 0x40, 0x46, 0x4b, 0x85, 0x51, 0x8b, 0xac, 0x35, 0xa2, 0xf3, 0xb6,
+        0x4f, 0xcf, 0x53, 0xc8, 0x5a, 0x64, 0xa3, 0xa1, 0x09, 0x33, 0x9b, 0x87, 0xd4, 0x65, 0xc1, 0x88,
+        0x5c, 0x44, 0xa1, 0x44, 0x10, 0xc3, 0xa0, 0x45, 0x86, 0xec, 0x1c, 0xdc, 0x76, 0x22, 0xd5, 0x68,
+        0x73, 0x18, 0x2a, 0xfd, 0x99, 0x89, 0x35, 0x1b, 0x8d, 0xaf, 0xda, 0x1e, 0xb0, 0x91, 0xa7, 0xb2,
+        0xc5, 0x7b, 0x8b, 0x05, 0x2e, 0x9c, 0xb7, 0xc8, 0x63, 0xfd, 0xaf, 0x3d, 0xa0, 0xce, 0x99, 0x2b,
+        0xc2, 0xc8, 0x1a, 0x32, 0xae, 0x40, 0xb4, 0xc8, 0x80, 0xc7, 0xa2, 0xba, 0x1a, 0x9d, 0xd7, 0xda,
+        0x88, 0x5e, 0xc4, 0xe9, 0x14, 0x0f, 0xe0, 0x70, 0xde, 0x3e, 0x8d, 0xa5, 0x62, 0xc3, 0x69, 0x6e,
+        0x6d, 0x8b, 0x38, 0x78, 0x05, 0xd1, 0xa6, 0x9c, 0x8d, 0x02, 0x8b, 0x29, 0xf0, 0x65, 0x41, 0x2b,
+        0xcc, 0x4c, 0xb8, 0xd1, 0x47, 0x10, 0xe4, 0x22, 0xb3, 0x48, 0xfb, 0x94, 0xe9, 0x28, 0x0c, 0x9b,
+        0xa7, 0x45, 0xd4, 0xd5, 0x92, 0x2d, 0xb2, 0xa2, 0x1d, 0x1e, 0x84, 0x98, 0x08, 0xc2, 0x12, 0xa8,
+        0x2d, 0x46, 0xfd, 0xcd, 0x47, 0x48, 0xfb, 0x7c, 0xbb, 0xb4, 0xb3, 0x23, 0x11, 0xc6, 0x81, 0xdb,
+        0x22, 0x62, 0x34, 0xa0, 0xd5, 0x06, 0xd1, 0x3f, 0x75, 0xb2, 0xb2, 0xfe, 0x55, 0x0d, 0xad, 0x76,
+        0x30, 0xed, 0xc8, 0xc5, 0x4d, 0x67, 0x66, 0xb4, 0xcc, 0x87, 0x06, 0xae, 0xcf, 0x2d, 0xcc, 0x12,
+        0x37, 0x9c, 0xb4, 0x12, 0x15, 0x4d, 0x34, 0x36, 0x53, 0xb9, 0x4c, 0xb2, 0xff, 0x76, 0xb3, 0xd6,
+        0xce, 0x42, 0x3a, 0x08, 0x95, 0x0a, 0xfd, 0x2c, 0xaa, 0x33, 0x7b, 0x18, 0x0a, 0xdf, 0x92, 0x13,
+        0xa6, 0x1c, 0x0f, 0xd3, 0x2e, 0x8a, 0x31, 0xf6, 0x39, 0x14, 0x2b, 0xe0, 0x93, 0x25, 0xe6, 0xeb,
+        0x22, 0xa2, 0x88, 0x46, 0x76, 0xe0, 0x5a, 0x99, 0x5a, 0xd6, 0xc0, 0xe9, 0x00, 0x78, 0x39, 0x7b,
+        0x30, 0x7e, 0xf3, 0xfc, 0xd9, 0x56, 0x9a, 0x1b, 0xcd, 0xb5, 0xf2, 0xe6, 0x10, 0x81, 0xb3, 0x24,
+        0x7b, 0x0f, 0xb8, 0x65, 0xdf, 0x7c, 0x90, 0xc0, 0x46, 0x00, 0xad, 0x96, 0x35, 0x81, 0xc1, 0x19,
+        0x43, 0x66, 0xce, 0x12, 0x80, 0xe2, 0x20, 0xa0, 0x03, 0x0e, 0x16, 0x16, 0x96, 0x73, 0x86, 0xb8,
+        0x15, 0xe8, 0x62, 0x30, 0x78, 0x88, 0xb9, 0x84, 0x1b, 0x81, 0x8c, 0xa8, 0x80, 0xeb, 0xaa, 0x30,
+        0x84, 0x5a, 0x12, 0xc1, 0x1e, 0x33, 0xc9, 0x06, 0x8c, 0x63, 0xd9, 0xb5, 0x88, 0xc7, 0x5c, 0xac,
+        0xfa, 0xf6, 0x6c, 0xb3, 0x9e, 0x96, 0xc7, 0x66, 0x3d, 0x6d, 0x3b, 0x83, 0xd0, 0x9d, 0x6e, 0x6d,
+        0xba, 0x6c, 0x4c, 0x1c, 0x4e, 0xa5, 0xec, 0x18, 0xae, 0x85, 0xa5, 0x04, 0x24, 0xaf, 0x85, 0x21,
+        0x75, 0xc1, 0x28, 0x31, 0x2c, 0xa4, 0x9f, 0x2e, 0xb9, 0x88, 0x06, 0xf9, 0xbe, 0x82, 0x73, 0x65,
+        0x4d, 0x3c, 0xcc, 0x0e, 0x32, 0x94, 0xd6, 0x5a, 0xaa, 0x81, 0x30, 0xb7, 0x63, 0x04, 0x61, 0x92,
+        0x4d, 0x9a, 0x01, 0x65, 0xea, 0x5a, 0xa8, 0xa4, 0x59, 0x46, 0x2c, 0x40, 0x7d, 0x56, 0x9a, 0x10,
+        0xe4, 0x4a, 0x91, 0x41, 0x12, 0xa3, 0xb3, 0x86, 0xd7, 0x22, 0x8f, 0x74, 0xa8, 0x49, 0x1e, 0xd6,
+        0x64, 0x85, 0x4d, 0x27, 0xd4, 0x1c, 0x52, 0x51, 0x95, 0x76, 0x81, 0x39, 0x93, 0x10, 0x88, 0x98,
+        0x72, 0x3e, 0xb5, 0x52, 0x14, 0x8c, 0xad, 0x5e, 0xea, 0x83, 0x6d, 0xdb, 0xb9, 0x19, 0xd8, 0xcf,
+        0xc6, 0xe5, 0xeb, 0x9c, 0x61, 0x85, 0xab, 0xd6, 0x90, 0xc7, 0xcc, 0x2d, 0xe3, 0x21, 0xc2, 0x09,
+        0xb9, 0x56, 0x28, 0x56, 0x5a, 0x13, 0x65, 0xbe, 0x52, 0x3f, 0xc2, 0x20, 0x96, 0x77, 0x75, 0x79,
+        0x2c, 0x52, 0x2c, 0x1d, 0x9e, 0x32, 0x39, 0x89, 0xb4, 0xe3, 0x01, 0x66, 0xc5, 0x5c, 0xa2, 0x22,
+        0x4f, 0x9a, 0xec, 0x0b, 0x5c, 0x56, 0x42, 0x37, 0x88, 0x9a, 0x46, 0x08, 0x4f, 0x42, 0xc2, 0x02,
+        0x2b, 0xe0, 0x4a, 0xa5, 0x93, 0xf0, 0xbc, 0xde, 0xee, 0xbd, 0xee, 0x62, 0x5f, 0xd5, 0x2c, 0xe0,
+        0x5a, 0x49, 0xea, 0x77, 0x8c, 0x83, 0x57, 0xdd, 0x7d, 0x83, 0xc4, 0x41, 0xaa, 0x2c, 0x23, 0xee,
+        0xf4, 0x0e, 0xfa, 0x5d, 0x3c, 0x33, 0x2d, 0x8f, 0xc5, 0x33, 0x13, 0xba, 0xa1, 0x0d, 0x44, 0x32,
+        0x76, 0x92, 0x7e, 0x72, 0xcc, 0x8e, 0xde, 0xdb, 0x85, 0x21, 0x8d, 0x39, 0x26, 0x40, 0x72, 0xdc,
+        0x66, 0x3d, 0x61, 0xfd, 0x14, 0xfe, 0xff, 0x7b, 0x70, 0x8e, 0xb7, 0x8f, 0xba, 0x87, 0x7f, 0xed,
+        0x75, 0xb7, 0x5f, 0x18, 0x24, 0xaf, 0xb0, 0xfb, 0xf9, 0x9f, 0x68, 0x24, 0x5a, 0xe3, 0x1d, 0x20,
+        0x78, 0xa2, 0x48, 0x9f, 0xa9, 0xb5, 0xfe, 0x7f, 0x97, 0x32, 0x87, 0xcd, 0x7b, 0x26, 0xc1, 0x61,
+        0xf3, 0x8b, 0xc9, 0x80, 0xc3, 0x95, 0xfb, 0xfa, 0xba, 0xf2, 0xe5, 0xf8, 0xba, 0x7a, 0x5f, 0x5f,
+        0x57, 0xbf, 0x1c, 0x5f, 0xd7, 0xee, 0xeb, 0xeb, 0xda, 0x1d, 0xbe, 0x2e, 0x5e, 0xa5, 0x23, 0x58,
+        0xa4, 0x88, 0x14, 0xce, 0xe7, 0x4c, 0xdc, 0xa7, 0xf3, 0x03, 0xf7, 0x00, 0xe7, 0x01, 0x0e, 0xc9,
+        0xdc, 0x7d, 0x2a, 0x8d, 0xca, 0xe2, 0x94, 0x7d, 0x32, 0x8e, 0x1c, 0x71, 0x32, 0x6c, 0xa8, 0x93,
+        0x55, 0xfe, 0xfc, 0xc9, 0x46, 0x63, 0x7f, 0xff, 0xcc, 0xff, 0xd6, 0x59, 0x97, 0x8f, 0x87, 0xbb,
+        0xaf, 0xbf, 0xeb, 0x75, 0xfb, 0x74, 0x7b, 0x7b, 0x7d, 0x7d, 0x7f, 0xf7, 0xfd, 0xc1, 0xb9, 0x37,
+        0x7d, 0xfc, 0xec, 0xcc, 0xd9, 0x73, 0x25, 0x7f, 0xd1, 0x84, 0xfd, 0xdf, 0xef, 0x6f, 0x9c, 0xee,
+        0xc1, 0xf3, 0xf7, 0x46, 0xe5, 0xd6, 0x29, 0xbb, 0x9e, 0xfa, 0x91, 0xfb, 0xb3, 0x55, 0xc1, 0x5b,
+        0x9b, 0x54, 0xa4, 0x77, 0xb0, 0xbd, 0xbb, 0xb7, 0xff, 0x8c, 0x74, 0x48, 0x00, 0x93, 0x14, 0x50,
+        0x72, 0x91, 0xee, 0x89, 0xd8, 0x51, 0xa1, 0xa8, 0xd6, 0x70, 0xad, 0x3c, 0x26, 0x6d, 0x04, 0xbc,
+        0x43, 0xdc, 0xd0, 0x89, 0x7d, 0xbc, 0x23, 0xda, 0xdf, 0xc7, 0x20, 0xa6, 0x7d, 0xe0, 0x90, 0x30,
+        0x99, 0xf9, 0x94, 0x6b, 0xd6, 0x52, 0x66, 0x3d, 0x1b, 0xe0, 0x4c, 0xd0, 0x21, 0x99, 0xe8, 0x02,
+        0x7f, 0x79, 0x78, 0xc8, 0xc5, 0xf4, 0x0c, 0x71, 0xbb, 0xd0, 0xef, 0xe6, 0x26, 0x92, 0xe2, 0x20,
+        0x2f, 0x9c, 0xec, 0x02, 0xce, 0xc0, 0xda, 0x85, 0x98, 0xf3, 0x2b, 0xea, 0xce, 0x93, 0x12, 0x09,
+        0x67, 0x09, 0x28, 0x31, 0xce, 0x2a, 0x9a, 0xab, 0xaa, 0x98, 0x0f, 0x61, 0xac, 0x4f, 0xc5, 0x41,
+        0x35, 0x5b, 0x14, 0xa2, 0x73, 0xce, 0xdb, 0x09, 0x38, 0x3d, 0x0c, 0xaa, 0x2d, 0xc0, 0x0f, 0xc7,
+        0x50, 0x35, 0xd3, 0xd9, 0xab, 0xec, 0xf2, 0x27, 0xd9, 0xb4, 0xf1, 0x76, 0xe2, 0xfb, 0xf3, 0xa3,
+        0x97, 0x3d, 0x3c, 0xc7, 0x34, 0xe7, 0x36, 0x16, 0xa5, 0xb5, 0x91, 0x28, 0xeb, 0x70, 0xa0, 0xe2,
+        0x28, 0x35, 0xaf, 0x5a, 0xf6, 0xfc, 0xb6, 0xcd, 0x9d, 0x27, 0x37, 0xed, 0x14, 0x38, 0xdc, 0x00,
+        0x20, 0x3e, 0xcb, 0xe6, 0xbc, 0x18, 0xf7, 0xce, 0x16, 0x59, 0xf4, 0x1d, 0x1f, 0x49, 0x72, 0x9b,
+        0x96, 0xf5, 0x53, 0x54, 0xad, 0xc2, 0x86, 0x24, 0x07, 0xb1, 0x80, 0xab, 0xc0, 0x7f, 0x41, 0xe3,
+        0xc5, 0x55, 0x34, 0xaa, 0x25, 0x59, 0xb4, 0xf6, 0x0a, 0x7e, 0xdc, 0x9a, 0x15, 0xd1, 0xc0, 0xef,
+        0xf8, 0x93, 0x4a, 0xdc, 0x19, 0x8f, 0xdf, 0x1a, 0xaa, 0xf9, 0x14, 0xfa, 0xb5, 0x50, 0xe5, 0xc1,
+        0xcf, 0xc0, 0xc2, 0xa4, 0x43, 0x41, 0x8c, 0x74, 0x55, 0x87, 0xbb, 0x70, 0xf1, 0x13, 0xd9, 0x97,
+        0x24, 0xea, 0x6d, 0xf9, 0xa3, 0x09, 0xb7, 0x64, 0x60, 0xc9, 0x82, 0x1b, 0xb3, 0x6c, 0x2e, 0x9c,
+        0xff, 0xad, 0x40, 0xce, 0x2a, 0x43, 0x1c, 0x4f, 0xf5, 0xf3, 0xba, 0x56, 0x9a, 0x76, 0xe8, 0x3e,
+        0x3e, 0x06, 0x40, 0x95, 0xb9, 0xcb, 0x44, 0x3f, 0x10, 0x40, 0x2d, 0xef, 0x41, 0xa4, 0xdc, 0x74,
+        0x46, 0xa0, 0xba, 0x1c, 0xf4, 0xd7, 0x27, 0xd3, 0x3d, 0x17, 0xf9, 0xd3, 0x83, 0x97, 0x00, 0xa1,
+        0x12, 0xa0, 0x62, 0x11, 0x54, 0xde, 0x98, 0x07, 0xfb, 0xe6, 0x32, 0x31, 0xf5, 0x1c, 0xac, 0x3f,
+        0xf5, 0xc0, 0x66, 0xbe, 0xb5, 0x65, 0xe8, 0x43, 0x55, 0x6a, 0xbb, 0xf1, 0xd2, 0xc9, 0x4f, 0xf9,
+        0x03, 0xd1, 0x01, 0x4b, 0x07, 0x68, 0x8d, 0xa4, 0x88, 0x81, 0xb4, 0xca, 0xb4, 0x21, 0xe5, 0x12,
+        0xd0, 0xe6, 0xc5, 0x06, 0x3a, 0xa6, 0x82, 0x4c, 0x64, 0x66, 0xe7, 0x44, 0x1e, 0x02, 0x7e, 0x0b,
+        0xb0, 0x53, 0xed, 0xe9, 0x67, 0x89, 0x31, 0xd5, 0x86, 0xaf, 0x37, 0x1a, 0x8d, 0x8c, 0xaf, 0x0f,
+        0xdf, 0x23, 0xc1, 0x6a, 0x5e, 0x39, 0x9f, 0xb1, 0x1f, 0xf7, 0x93, 0xac, 0x9e, 0xc8, 0xac, 0x07,
+        0x1f, 0xc3, 0xa0, 0x1f, 0xe2, 0xe1, 0xaa, 0xfa, 0x6e, 0xa2, 0xef, 0x35, 0x0f, 0x2e, 0x78, 0xe8,
+        0x50, 0x2d, 0x61, 0x7b, 0xa1, 0x54, 0xb3, 0xfa, 0x44, 0xbe, 0xab, 0x55, 0xe6, 0x14, 0x4e, 0xa4,
+        0x1d, 0x06, 0x3e, 0x48, 0x49, 0x47, 0x80, 0x94, 0x2a, 0x64, 0xe1, 0xc9, 0x5a, 0x7b, 0x1e, 0xa1,
+        0xd4, 0xce, 0x2b, 0x3e, 0xb0, 0x5d, 0xaa, 0x68, 0x42, 0xc6, 0x7b, 0x2c, 0xf6, 0xef, 0x51, 0xd5,
+        0x7c, 0x73, 0xdc, 0x27, 0xe8, 0x07, 0xb0, 0x31, 0xb8, 0x6f, 0x11, 0xbd, 0x8c, 0x3b, 0x43, 0x39,
+        0x5f, 0xe5, 0x50, 0x67, 0x6b, 0x4c, 0x3b, 0x7c, 0x66, 0xad, 0x9a, 0x7f, 0x09, 0x30, 0x87, 0xf4,
+        0x93, 0x6d, 0x97, 0x3a, 0x5e, 0xd5, 0x4f, 0x8d, 0x48, 0x05, 0x31, 0x5f, 0x1d, 0x1e, 0xbb, 0x20,
+        0xab, 0x66, 0xcb, 0xac, 0x15, 0x0a, 0x52, 0x93, 0xde, 0x14, 0x61, 0x7f, 0x8b, 0x66, 0xf9, 0xb9,
+        0xba, 0x56, 0x96, 0x91, 0xcc, 0xd5, 0x01, 0x33, 0xfb, 0x66, 0x2e, 0x56, 0x80, 0xf9, 0x30, 0x11,
+        0x9a, 0x67, 0xda, 0x35, 0xaf, 0x32, 0x47, 0x5e, 0xe7, 0x49, 0xc5, 0xb6, 0xb0, 0xd2, 0xc8, 0xd7,
+        0x5f, 0x27, 0xdb, 0x4b, 0x9d, 0x4c, 0xd7, 0x43, 0xd2, 0xac, 0xe1, 0x57, 0x5b, 0x42, 0x80, 0xe5,
+        0xf0, 0xac, 0x7b, 0x84, 0x67, 0x5f, 0x3b, 0x0c, 0xf9, 0xd3, 0xe2, 0xbd, 0x39, 0x61, 0x2b, 0xb3,
+        0x5a, 0x1b, 0xf7, 0x93, 0x58, 0x84, 0x11, 0x04, 0x3a, 0x10, 0x59, 0x1c, 0x16, 0x10, 0x3e, 0xc0,
+        0x7d, 0x8d, 0x6f, 0xed, 0x7a, 0x88, 0x32, 0x79, 0x87, 0x87, 0x12, 0xee, 0x52, 0xb0, 0xa3, 0x19,
+        0x4a, 0x0a, 0x92, 0x06, 0xa1, 0xb3, 0x6d, 0xb9, 0x90, 0x2a, 0xb6, 0xb2, 0x7e, 0x63, 0xbe, 0xbc,
+        0xfc, 0xf0, 0x4f, 0x45, 0xce, 0x2e, 0x3f, 0xfc, 0x4b, 0x91, 0xe0, 0xf2, 0xe3, 0xcf, 0xcc, 0x26,
+        0xbf, 0xfc, 0x8d, 0x06, 0xa3, 0x79, 0x12, 0xe1, 0x97, 0x1f, 0xfe, 0xc1, 0x6c, 0x33, 0xe9, 0x56,
+        0x0d, 0xdd, 0xb0, 0xe6, 0xea, 0xbe, 0x48, 0xd8, 0xe5, 0x9b, 0xd2, 0x5d, 0x43, 0x90, 0x7b, 0x00,
+        0x42, 0x84, 0xe2, 0x2e, 0x0f, 0xba, 0x9a, 0xe1, 0x3f, 0x75, 0xa0, 0x77, 0xf9, 0xf1, 0xef, 0xac,
+        0x55, 0x32, 0x57, 0x79, 0x89, 0x53, 0x83, 0xc4, 0xea, 0xdf, 0xc2, 0x9d, 0xd9, 0xed, 0x16, 0xfe,
+        0x7a, 0x55, 0x49, 0xf1, 0xe5, 0xb5, 0x5e, 0xb9, 0x79, 0x84, 0xda, 0xe6, 0x1c, 0xa7, 0xa2, 0x85,
+        0xb7, 0x61, 0x66, 0xad, 0xa8, 0x28, 0x96, 0x55, 0x94, 0xee, 0xd9, 0xdd, 0x31, 0x2a, 0xd0, 0x0d,
+        0x1c, 0x33, 0x09, 0x07, 0x23, 0xc7, 0xd3, 0xaf, 0x92, 0xd0, 0x4d, 0x58, 0xc4, 0x1b, 0x6c, 0x45,
+        0x05, 0x36, 0x4e, 0x5b, 0x27, 0x6b, 0xb1, 0xc8, 0x1a, 0xdc, 0x67, 0x05, 0xe0, 0x97, 0x9f, 0xd9,
+        0xe5, 0xc7, 0x1f, 0x63, 0x72, 0xe6, 0xe1, 0xe7, 0x4f, 0x41, 0x29, 0x08, 0x68, 0xc3, 0x6a, 0x02,
+        0xf4, 0xf5, 0x93, 0x30, 0x1b, 0x96, 0xae, 0xd3, 0x34, 0xc4, 0x1c, 0x54, 0x5a, 0x42, 0xe9, 0x24,
+        0xa4, 0x0b, 0x75, 0xc1, 0x48, 0xb4, 0x25, 0x67, 0x29, 0xf6, 0xf0, 0x77, 0x5b, 0x29, 0xc1, 0x06,
+        0x31, 0xd6, 0xa1, 0x59, 0x7a, 0x09, 0x82, 0x4d, 0xe0, 0x87, 0x1f, 0x88, 0xbe, 0x0f, 0x54, 0x66,
+        0xd8, 0xcc, 0xb1, 0x96, 0x3e, 0x29, 0x5f, 0x7a, 0x5f, 0x92, 0xcb, 0x3f, 0x7d, 0x6a, 0xa6, 0x09,
+        0x9d, 0xb4, 0x85, 0x77, 0x0f, 0x2e, 0xe6, 0xa0, 0x9c, 0xb5, 0x1e, 0x5c, 0x24, 0x3a, 0x67, 0xef,
+        0xd2, 0x4c, 0xa9, 0xcd, 0xdd, 0x21, 0xea, 0xe9, 0x5b, 0xba, 0x7a, 0xf2, 0xf7, 0x83, 0x7f, 0x03,
+        0x77, 0x5e, 0x08, 0x24, 0x4f, 0x18, 0x00, 0x00,
+};
+
+#endif //SMART_GARDEN_MAIN_PAGE_H
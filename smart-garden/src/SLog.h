@@ -15,7 +15,7 @@
 
 // Debug macro
 #ifdef SLOG_DEBUG
-#define SLOG_P(...) Serial.printf(##__VA_ARGS__)
+#define SLOG_P(...) Serial.printf(__VA_ARGS__)
 #define SLOG_Pln(s) Serial.println(s)
 #else
 #define SLOG_P(...)
@@ -26,13 +26,59 @@
 // Use Telegram log macro
 #ifdef USE_TELEGRAM_LOG
 
-#include <vector>
+#include <atomic>
+#include <list>
+#include <WiFiClientSecure.h>
 
 #define SLOG_PARSE_MODE_HTML 1
 #define SLOG_PARSE_MODE_MARKDOWN 0
 
 static const char SLOG_HTML_ENCODE_LIST[] = ">-={}().!";
 
+// Requests written back to back on the connection before their responses are read
+#ifndef TBOT_PIPELINE_DEPTH
+#define TBOT_PIPELINE_DEPTH 4
+#endif
+
+// Idle time before the TLS connection is closed to give its buffers back to the heap (ms)
+#ifndef TBOT_KEEP_ALIVE
+#define TBOT_KEEP_ALIVE 30000
+#endif
+
+// Delay before reconnecting, doubled after each failed attempt up to TBOT_RECONNECT_MAX (ms)
+#ifndef TBOT_RECONNECT_MIN
+#define TBOT_RECONNECT_MIN 1000
+#endif
+
+#ifndef TBOT_RECONNECT_MAX
+#define TBOT_RECONNECT_MAX 60000
+#endif
+
+// Failed connections in a row before the pending requests are given up
+#ifndef TBOT_CONNECT_ATTEMPTS
+#define TBOT_CONNECT_ATTEMPTS 3
+#endif
+
+// Times a request is tried when it could not be written, or the server closed the connection before
+// reading it. A request written whose response is lost is not sent again: sendMessage is not
+// idempotent, so delivery is at most once
+#ifndef TBOT_SEND_ATTEMPTS
+#define TBOT_SEND_ATTEMPTS 2
+#endif
+
+// Response body kept for the message id, the rest is skipped
+#ifndef TBOT_RESPONSE_MAX
+#define TBOT_RESPONSE_MAX 256
+#endif
+
+// Outgoing bytes collected per TLS write
+#ifndef TBOT_WRITE_BUFFER
+#define TBOT_WRITE_BUFFER 512
+#endif
+
+#ifndef TBOT_TASK_STACK
+#define TBOT_TASK_STACK 6144
+#endif
 
 
 struct TBot_request {
@@ -41,6 +87,8 @@ struct TBot_request {
     uint16_t messageId;
     std::function<void(uint16_t)> callback;
     bool completed;
+    bool sent;        // on the connection, waiting for its response
+    uint8_t attempts;
 };
 
 
@@ -52,11 +100,26 @@ private:
     String _botToken;
     String _chatId;
     uint8_t _parseMode = SLOG_PARSE_MODE_MARKDOWN;
-    WiFiClientSecure *_client = nullptr;
-    TaskHandle_t _reqHandle = nullptr;
-    std::vector<TBot_request> _requestQueue;
+    String _host = "api.telegram.org";
+    uint16_t _port = 443;
+    WiFiClientSecure *_client = nullptr; // owned by the sender task
+    TaskHandle_t _reqHandle = nullptr;   // sender task, started with the first request
+    SemaphoreHandle_t _lock = nullptr;   // _requestQueue, shared with the sender task
+    SemaphoreHandle_t _exited = nullptr; // given by the sender task once it stopped
+    std::atomic<bool> _stopping{false};  // asks the sender task to exit
+    std::list<TBot_request> _requestQueue; // list: the sender keeps pointers while requests are added
     uint32_t _lastReqTime = 0;
     uint32_t _timeout = 6000;
+    uint32_t _retryAt = 0;
+    uint32_t _retryDelay = TBOT_RECONNECT_MIN;
+    uint8_t _connectFailures = 0;
+    std::atomic<uint32_t> _sentCount{0};    // read from the loop task
+    std::atomic<uint32_t> _connectCount{0};
+    char _out[TBOT_WRITE_BUFFER]{};
+    size_t _outLen = 0;
+    uint32_t _outQueued = 0;  // bytes passed to _write() in this batch
+    uint32_t _outWritten = 0; // of them, accepted by the connection, up to the first short write
+    bool _outBroken = false;
 
     static String encodeMarkdown(String &s) {
         if (!s.length()) return "";
@@ -117,31 +180,257 @@ private:
         return url;
     }
 
-    static uint16_t _getMessageId(String & response) {
-        if (!response.length())
+    static uint16_t _getMessageId(const char *response) {
+        if (!*response)
             return 0;
-        if (!response.startsWith("{\"ok\":true")) {
+        if (strncmp(response, "{\"ok\":true", 10) != 0) {
             SLOG_Pln("[Telegram] Fail response");
             SLOG_Pln(response);
             return 0;
         }
-        int msgIdIndex = response.indexOf("\"message_id\":");
-        if (msgIdIndex == -1)
+        const char *msgId = strstr(response, "\"message_id\":");
+        if (msgId == nullptr)
             return 0;
-        int msgIdEndIndex = response.indexOf(",", msgIdIndex);
-        if (msgIdEndIndex == -1)
-            return 0;
-        return response.substring(msgIdIndex + 13, msgIdEndIndex).toInt();
+        return strtoul(msgId + 13, nullptr, 10);
     }
 
-    void endTask() {
-        if (_client) {
-            delete _client;
-            _client = nullptr;
+    void _write(const char *data, size_t length) {
+        _outQueued += length;
+        while (length) {
+            size_t n = sizeof(_out) - _outLen;
+            if (n > length) n = length;
+            memcpy(_out + _outLen, data, n);
+            _outLen += n;
+            data += n;
+            length -= n;
+            if (_outLen == sizeof(_out)) _flushOut();
         }
-        if (_reqHandle) {
-            _reqHandle = nullptr;
-            vTaskDelete(nullptr);
+    }
+
+    void _write(const char *data) {
+        _write(data, strlen(data));
+    }
+
+    void _flushOut() {
+        if (_outLen) {
+            size_t n = _client->write((const uint8_t *) _out, _outLen);
+            // Past a short write the stream is broken, nothing after it counts as written
+            if (!_outBroken) {
+                _outWritten += n;
+                _outBroken = n != _outLen;
+            }
+        }
+        _outLen = 0;
+    }
+
+    /**
+     * Read a header line without its "\r\n", cut to the buffer
+     * @return false on timeout / disconnect
+     */
+    bool _readLine(char *line, size_t size) {
+        size_t n = _client->readBytesUntil('\n', line, size - 1);
+        if (n == 0) return false; // lines end with "\r\n": nothing read is a timeout
+        line[n] = '\0';
+        if (n == size - 1) {
+            // Skip the rest of a long line
+            char c;
+            while (_client->readBytes(&c, 1) == 1 && c != '\n') {}
+        }
+        if (n && line[n - 1] == '\r') line[n - 1] = '\0';
+        return true;
+    }
+
+    /**
+     * Read one response, keeping the start of the body
+     * @param httpCode
+     * @param body TBOT_RESPONSE_MAX + 1 bytes
+     * @param keepAlive false if the server closes the connection after it
+     * @return false on timeout / disconnect
+     */
+    bool _readResponse(uint16_t &httpCode, char *body, bool &keepAlive) {
+        char line[128];
+        body[0] = '\0';
+        keepAlive = true;
+        if (!_readLine(line, sizeof(line)) || strncmp(line, "HTTP/1.", 7) != 0) return false;
+        httpCode = atoi(line + 9);
+
+        long contentLength = -1;
+        while (true) {
+            if (!_readLine(line, sizeof(line))) return false;
+            if (!line[0]) break; // end header
+            if (strncasecmp(line, "Content-Length:", 15) == 0) {
+                contentLength = atol(line + 15);
+            } else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line + 11, "close")) {
+                keepAlive = false;
+            }
+        }
+        if (contentLength < 0) {
+            // Body ends with the connection
+            keepAlive = false;
+            contentLength = 0x7FFFFFFF;
+        }
+
+        size_t kept = 0;
+        char skip[64];
+        while (contentLength > 0) {
+            char *dest = kept < TBOT_RESPONSE_MAX ? body + kept : skip;
+            size_t n = kept < TBOT_RESPONSE_MAX ? TBOT_RESPONSE_MAX - kept : sizeof(skip);
+            if ((long) n > contentLength) n = contentLength;
+            n = _client->readBytes(dest, n);
+            if (n == 0) {
+                if (keepAlive) return false; // timeout before the end of the body
+                break;
+            }
+            if (dest != skip) kept += n;
+            contentLength -= n;
+        }
+        body[kept] = '\0';
+        return true;
+    }
+
+    bool _connect() {
+        if (_client && _client->connected()) {
+            return true;
+        }
+        if (!_client) {
+            _client = new WiFiClientSecure();
+            _client->setInsecure();
+        }
+        _client->stop();
+        _client->setTimeout(_timeout / 1000);
+        _connectCount++;
+        SLOG_P("[Telegram][task] Connecting, free heap: %d\n", esp_get_free_heap_size());
+        return _client->connect(_host.c_str(), _port, 2000L) && _client->connected();
+    }
+
+    bool _hasPending() {
+        bool pending = false;
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        for (auto &req: _requestQueue) {
+            if (!req.completed) {
+                pending = true;
+                break;
+            }
+        }
+        xSemaphoreGive(_lock);
+        return pending;
+    }
+
+    /**
+     * Complete the requests that are not sent yet, e.g. after too many failed connections
+     */
+    void _failPending() {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        for (auto &req: _requestQueue) {
+            if (!req.completed && !req.sent) req.completed = true;
+        }
+        xSemaphoreGive(_lock);
+    }
+
+    /**
+     * Connect if needed, write up to TBOT_PIPELINE_DEPTH requests, then read their responses in order
+     * @return false to wait before retrying
+     */
+    bool _sendBatch() {
+        if ((int32_t) (millis() - _retryAt) < 0) {
+            return false;
+        }
+        if (!_connect()) {
+            SLOG_Pln("[Telegram][task] Unable to connect to telegram server");
+            if (++_connectFailures >= TBOT_CONNECT_ATTEMPTS) {
+                _failPending();
+                _connectFailures = 0;
+            }
+            _retryAt = millis() + _retryDelay;
+            _retryDelay = _retryDelay * 2 > TBOT_RECONNECT_MAX ? TBOT_RECONNECT_MAX : _retryDelay * 2;
+            return false;
+        }
+        _connectFailures = 0;
+        _retryDelay = TBOT_RECONNECT_MIN;
+
+        // The queue is a list: these stay valid while process() adds requests, and it only removes completed ones
+        TBot_request *batch[TBOT_PIPELINE_DEPTH];
+        uint8_t count = 0;
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        for (auto &req: _requestQueue) {
+            if (count == TBOT_PIPELINE_DEPTH) break;
+            if (req.completed) continue;
+            req.sent = true;
+            req.attempts++;
+            batch[count++] = &req;
+        }
+        xSemaphoreGive(_lock);
+        if (!count) {
+            return false;
+        }
+
+        _lastReqTime = millis();
+        uint32_t ends[TBOT_PIPELINE_DEPTH]; // end of each request in the written stream
+        _outQueued = 0;
+        _outWritten = 0;
+        _outBroken = false;
+        for (uint8_t i = 0; i < count; i++) {
+            _write("GET ");
+            _write(batch[i]->url.c_str(), batch[i]->url.length());
+            _write(" HTTP/1.1\r\nHost: ");
+            _write(_host.c_str());
+            _write("\r\nConnection: keep-alive\r\n\r\n");
+            ends[i] = _outQueued;
+        }
+        _flushOut();
+
+        char body[TBOT_RESPONSE_MAX + 1];
+        uint8_t done = 0;
+        bool keepAlive = true;
+        bool lost = false; // the server may have handled the requests whose response was not read
+        for (; done < count && keepAlive; done++) {
+            uint16_t httpCode = 0;
+            if (!_readResponse(httpCode, body, keepAlive)) {
+                SLOG_Pln("[Telegram][task] Request timeout");
+                keepAlive = false;
+                lost = true;
+                break;
+            }
+            if (httpCode != 200) {
+                SLOG_P("[Telegram][task][Error] HTTP code: %d\n", httpCode);
+                SLOG_Pln(body);
+            }
+            uint16_t messageId = _getMessageId(body);
+            xSemaphoreTake(_lock, portMAX_DELAY);
+            batch[done]->httpCode = httpCode;
+            batch[done]->messageId = messageId;
+            batch[done]->completed = true;
+            xSemaphoreGive(_lock);
+            _sentCount++;
+        }
+
+        if (!keepAlive) {
+            _client->stop();
+        }
+        // Responses not read. Sent again only if the server can't have handled them: not fully written,
+        // or behind a response that closed the connection. Otherwise given up, a retry could post twice
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        for (uint8_t i = done; i < count; i++) {
+            batch[i]->sent = false;
+            bool written = ends[i] <= _outWritten;
+            if ((lost && written) || batch[i]->attempts >= TBOT_SEND_ATTEMPTS) batch[i]->completed = true;
+        }
+        xSemaphoreGive(_lock);
+
+        SLOG_P("[Telegram][task] %d/%d requests in %lu ms, free heap: %d\n", done, count,
+               (unsigned long) (millis() - _lastReqTime), esp_get_free_heap_size());
+        return true;
+    }
+
+    void _run() {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        bool pending = _hasPending();
+        if (!pending && _client && _client->connected() && millis() - _lastReqTime > TBOT_KEEP_ALIVE) {
+            SLOG_Pln("[Telegram][task] Closing idle connection");
+            _client->stop();
+        }
+        while (pending && !_stopping && _sendBatch()) {
+            pending = _hasPending();
         }
     }
 
@@ -151,13 +440,24 @@ public:
         _botToken = token;
         _chatId = chatId;
         _parseMode = textMode;
+        _lock = xSemaphoreCreateMutex();
+        _exited = xSemaphoreCreateBinary();
     }
 
     ~TBot() {
+        if (_reqHandle) {
+            // Let the sender finish its batch, it still uses _client and _lock until then
+            _stopping = true;
+            xTaskNotifyGive(_reqHandle);
+            xSemaphoreTake(_exited, portMAX_DELAY);
+            _reqHandle = nullptr;
+        }
         if (_client) {
             delete _client;
             _client = nullptr;
         }
+        vSemaphoreDelete(_exited);
+        vSemaphoreDelete(_lock);
     }
 
     void sendReq(const String& url, const std::function<void(uint16_t)> &callback = nullptr) {
@@ -165,7 +465,9 @@ public:
             return;
 
         // Add to queue, process in loop
-        _requestQueue.push_back({url, 0, 0, callback, false});
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        _requestQueue.push_back({url, 0, 0, callback, false, false, 0});
+        xSemaphoreGive(_lock);
     }
 
     void sendMessage(String &message, const std::function<void(uint16_t)> &callback = nullptr) {
@@ -184,130 +486,74 @@ public:
         sendReq(url, callback);
     }
 
-    void process() {
-        if (_requestQueue.empty())
-            return;
+    /**
+     * Point the bot at another server, e.g. a local stand-in (telegram_stub.py) to measure throughput
+     */
+    void setServer(const String &host, uint16_t port = 443) {
+        _host = host;
+        _port = port;
+    }
 
-        uint8_t cnt = 0;
+    /**
+     * Requests answered so far
+     */
+    uint32_t getSentCount() const {
+        return _sentCount;
+    }
 
-        for (auto req: _requestQueue) {
-            if (req.completed) {
-                if (req.callback) {
-                    SLOG_P("[Telegram][complete] Callback with msgId = %d\n", req.messageId);
-                    req.callback(req.messageId);
-                } else {
-                    SLOG_P("[Telegram][complete] msgId = %d\n", req.messageId);
-                }
-            }
-        }
+    /**
+     * TLS connections opened so far
+     */
+    uint32_t getConnectCount() const {
+        return _connectCount;
+    }
+
+    void process() {
+        // Callbacks run here, on the loop task
+        std::list<TBot_request> completed;
+        xSemaphoreTake(_lock, portMAX_DELAY);
         for (auto it = _requestQueue.begin(); it != _requestQueue.end();) {
+            auto next = std::next(it);
             if (it->completed) {
-                ++cnt;
-                it = _requestQueue.erase(it);
+                completed.splice(completed.end(), _requestQueue, it);
+            }
+            it = next;
+        }
+        bool pending = !_requestQueue.empty();
+        xSemaphoreGive(_lock);
+
+        for (auto &req: completed) {
+            if (req.callback) {
+                SLOG_P("[Telegram][complete] Callback with msgId = %d\n", req.messageId);
+                req.callback(req.messageId);
             } else {
-                ++it;
+                SLOG_P("[Telegram][complete] msgId = %d\n", req.messageId);
             }
         }
 
-        SLOG_P("[Telegram][loop] Processed %d/%d requests\n", cnt, _requestQueue.size());
+        if (!pending)
+            return;
 
         if (_reqHandle != nullptr) {
-            auto status = eTaskGetState(_reqHandle);
-            SLOG_P("[Telegram][loop] Free space: %d, status: %d\n", uxTaskGetStackHighWaterMark(_reqHandle), status);
+            xTaskNotifyGive(_reqHandle);
             return;
         }
 
-        if (_requestQueue.empty())
-            return;
+        SLOG_Pln("[Telegram][loop][start sender]");
 
-        SLOG_Pln("[Telegram][loop][add task]");
-
-        // Process in RTOS task
+        // One sender task for the lifetime of the bot, it keeps the TLS connection open between requests
         xTaskCreate(
             [](void *param) {
-                SLOG_Pln("[Telegram][task][processing]");
                 auto *bot = (TBot *) param;
-
-                if (!bot) {
-                    SLOG_Pln("[Telegram][task] Invalid bot");
-                    vTaskDelete(nullptr);
-                    return;
-                }
-
-                // No task -> exit
-                if (bot->_requestQueue.empty()) {
-                    SLOG_Pln("[Telegram][task] No request");
-                    bot->endTask();
-                    return;
-                }
-
-                bot->_lastReqTime = millis();
-                auto *req = &bot->_requestQueue[0];
-                
-                SLOG_P("[Telegram][task] Got a request\n");
-
-                if (bot->_client) {
-                    delete bot->_client;
-                }
-
-                SLOG_P("Free heap: %d\n", esp_get_free_heap_size());
-
-                bot->_client = new WiFiClientSecure();
-                bot->_client->setInsecure();
-                
-                SLOG_P("[Telegram][task] Sending request: ...%s\n", req->url.substring(req->url.length() - 40).c_str());
-
-                bot->_client->connect("api.telegram.org", 443, 2000L);
-                if (!bot->_client->connected()) {
-                    req->completed = true;
-                    SLOG_Pln("[Telegram][task] Unable to connect to telegram server");
-                    return bot->endTask();
+                while (!bot->_stopping) {
+                    bot->_run();
                 }
-
-                bot->_client->print(String("GET ") + req->url + " HTTP/1.1\r\n" +
-                       "Host: api.telegram.org\r\n" +
-                       "Connection: close\r\n\r\n");
-
-                while (bot->_client->connected()) {
-                    String line = bot->_client->readStringUntil('\n');
-                    if (line.startsWith("HTTP/1.1")) {
-                        req->httpCode = line.substring(9, 12).toInt();
-                    }
-                    if (line == "\r") break; // end header
-                    if (millis() > bot->_lastReqTime + bot->_timeout) {
-                        SLOG_Pln("[Telegram][task] Request timeout");
-                        req->completed = true;
-                        bot->_client->stop();
-                        return bot->endTask();
-                    }
-                }
-
-                SLOG_P("[Telegram][task] HTTP code: %d\n", req->httpCode);
-
-                String response = "";
-                while (bot->_client->available()) {
-                    response += (char)bot->_client->read();
-                    if (millis() > bot->_lastReqTime + bot->_timeout) {
-                        SLOG_Pln("[Telegram][task] Request timeout");
-                        req->completed = true;
-                        bot->_client->stop();
-                        return bot->endTask();
-                    }
-                }
-                bot->_client->stop();
-                if (req->httpCode > 0) {
-                    if (req->httpCode != 200) {
-                        SLOG_P("[Telegram][task][Error] HTTP code: %d\n", req->httpCode);
-                        SLOG_Pln(response);
-                    }
-                    req->messageId = TBot::_getMessageId(response);
-                }
-                req->completed = true;
-                SLOG_P("[Telegram][task] Request completed code = %d, msgId = %d\n", req->httpCode, req->messageId);
-                bot->endTask();
+                // The bot may be freed as soon as this is given
+                xSemaphoreGive(bot->_exited);
+                vTaskDelete(nullptr);
             },
             "TBotReq",
-            3072,
+            TBOT_TASK_STACK,
             this,
             1 | portPRIVILEGE_BIT,
             &_reqHandle);
@@ -354,6 +600,10 @@ public:
     void setChatId(const String& chatId) {
         bot->_chatId = chatId;
     }
+
+    void setTeleServer(const String& host, uint16_t port = 443) {
+        bot->setServer(host, port);
+    }
 #endif // USE_TELEGRAM_LOG
 
     void clearOldLogs() override {
@@ -368,8 +618,8 @@ public:
         return Logger::getLogs();
     }
 
-    bool log(const String &event, const String &source, const String &message = "") {
-        return Logger::log(event + "-" + source + "-" + message);
+    bool log(const char *event, const char *source, const String &message = "") {
+        return Logger::log(event, source, message.c_str());
     }
 
     /**
@@ -390,7 +640,7 @@ public:
     }
 
     void loop() {
-        processQueue();
+        Logger::loop();
 #ifdef USE_TELEGRAM_LOG
         bot->process();
 #endif
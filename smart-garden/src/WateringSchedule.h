@@ -21,13 +21,20 @@ public:
     }
 
     void parse(String& arg) override {
-        int index = arg.indexOf("-");
-        valveOpenLevel = arg.substring(0, index).toInt();
-        arg = arg.substring(index + 1);
-        index = arg.indexOf("-");
-        waterLiters = arg.substring(0, index).toInt();
-        arg = arg.substring(index + 1);
-        duration = arg.toInt();
+        parse(arg.c_str(), arg.length());
+    }
+
+    // Format: valveOpenLevel-waterLiters-duration
+    void parse(const char *arg, size_t length) override {
+        const char *end = arg + length;
+        uint8_t *fields[] = {&valveOpenLevel, &waterLiters, &duration};
+        for (auto field: fields) {
+            auto *sep = static_cast<const char *>(memchr(arg, '-', end - arg));
+            *field = toInt(arg, (sep ? sep : end) - arg);
+            if (sep == nullptr)
+                break;
+            arg = sep + 1;
+        }
     }
 
     String toString() override {
@@ -38,6 +45,21 @@ public:
         return str;
     }
 
+    size_t pack(uint8_t *buf, size_t size) override {
+        if (size < 3) return 0;
+        buf[0] = valveOpenLevel;
+        buf[1] = waterLiters;
+        buf[2] = duration;
+        return 3;
+    }
+
+    void unpack(const uint8_t *buf, size_t size) override {
+        if (size < 3) return;
+        valveOpenLevel = buf[0];
+        waterLiters = buf[1];
+        duration = buf[2];
+    }
+
 };
 
 
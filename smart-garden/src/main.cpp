@@ -36,20 +36,30 @@
 #define DEVICE_NAME "Watering System"
 
 #define FLOW_SENSOR_PIN 35
+#define FLOW_SENSOR_K_FACTOR 450.0f // pulses per litre, see FlowMeter::calibrate()
+// Safety timeout of a volume-only schedule: the valve closes after liters / WATERING_MIN_FLOW_LPM
+// minutes plus WATERING_FLOW_MARGIN_MS even if the sensor never reports the target
+#define WATERING_MIN_FLOW_LPM 2.0f // slowest flow expected with the valve fully open (L/min)
+#define WATERING_FLOW_MARGIN_MS 120000L // pipe filling, valve motor travel
 #define VOLTAGE_PIN 32
 
 #define OUTPUT_ACTIVE_STATE LOW
 
+#define RTDB_QUEUE_LIMIT 4 // async Firebase tasks queued before the state reports wait
+
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <SimpleTimer.h>
 #include "secret.h" // see secret_placeholder.h
 
 #include "GenericOutput.h"
 #include "GenericInput.h"
 #include "VirtualOutput.h"
 #include "VoltageReader.h"
+#include "FlowMeter.h"
+#include "DeviceLoop.h"
+#include "DeviceTimer.h"
+#include "StateSnapshot.h"
 
 #if defined(ENABLE_SERVER)
 
@@ -68,8 +78,10 @@
 
 #include "FirebaseIOT.h"
 #include "FirebaseRTDBIntegrate.h"
+#include "StateReporter.h"
 
 fbrtdb_object *RTDBObj;
+StateReporter stateReporter;
 
 #endif // ENABLE_NFIREBASE
 
@@ -83,14 +95,17 @@ GenericOutput ACPower(4, OUTPUT_ACTIVE_STATE, stdGenericOutput::START_UP_OFF, 18
 VirtualOutput Valve(100, stdGenericOutput::START_UP_LAST_STATE, 60000L /* 1 min */);
 GenericInput WaterLeak(34, INPUT_PULLUP, LOW);
 VoltageReader PowerVoltage(32, 10.0, 2, 0.3, 10.5, 13.5);
+FlowMeter WaterFlow(FLOW_SENSOR_PIN, FLOW_SENSOR_K_FACTOR);
+StateSnapshot stateSnapshot; // "R1:ON\n..." snapshot and deltas for the WebSocket clients
 
-SimpleTimer timer;
+DeviceTimer timer; // one-shot jobs (OTA, Firebase), woken at their deadline
+DeviceLoop deviceLoop;
 
 #if defined(ENABLE_SCHEDULER)
 
 #include "WateringSchedule.h"
 
-void WateringTaskExec(schedule_task_t<WateringTaskArgs> task);
+void WateringTaskExec(const schedule_task_t<WateringTaskArgs> &task);
 
 Scheduler<WateringTaskArgs> scheduler(WateringTaskExec);
 
@@ -114,6 +129,7 @@ struct {
 #if defined(ENABLE_SERVER)
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
+AsyncEventSource voltageEvents("/voltage-events");
 #endif
 
 
@@ -125,42 +141,125 @@ AsyncWebSocket ws("/ws");
  */
 bool connectWiFi();
 
+/**
+ * @brief Save the pending output states and log lines, then restart
+ */
+void restartDevice() {
+    if (LastStateStore *store = GenericOutput::getLastStateStore()) {
+        store->flush();
+    }
+#if defined(ENABLE_LOGGER)
+    logger.flush();
+#endif
+    ESP.restart();
+}
 
-String getInfo() {
-    String info = "{";
-    info += R"("device":")" DEVICE_NAME "\",";
-    info += R"("version":")" DEVICE_VERSION "\",";
-    info += R"("firmware":)" + String(FIRMWARE_VERSION) + ",";
-    info += R"("ip":")" + WiFi.localIP().toString() + "\"";
-//    info += R"("timestamp":)" + String(Time.getUnixTime()) + ",";
-//    info += R"("datetime":")" + Time.getDateTime() + "\"";
-
-//    info += R"("ip":")" + WiFi.localIP().toString() + "\",";
-//    info += R"("voltage":)" + String(PowerVoltage.get()) + ",";
-//    info += R"("valve":")" + Valve.getStateString() + "\",";
-//    info += R"("r1":")" + ValvePower.getStateString() + "\",";
-//    info += R"("r2":")" + ValveDirection.getStateString() + "\",";
-//    info += R"("r3":")" + PumpPower.getStateString() + "\",";
-//    info += R"("r4":")" + ACPower.getStateString() + "\",";
-//    info += R"("r1_auto_off":)" + String(ValvePower.getDuration()) + ",";
-//    info += R"("r4_auto_off":)" + String(ACPower.getDuration()) + ",";
-//    info += R"("valve":")" + Valve.getStateString() + "\",";
-//    info += R"("valve_auto_off":)" + String(Valve.getDuration()) + ",";
-//    info += R"("water_leak":")" + WaterLeak.getStateString() + "\"";
-    info += "}";
+
+/**
+ * @brief Device info JSON for /info and the database, formatted again only when the IP changes
+ */
+const char *getInfo() {
+    static char info[160];
+    static uint32_t infoIP = 0;
+    IPAddress ip = WiFi.localIP();
+    if (!info[0] || (uint32_t) ip != infoIP) {
+        snprintf(info, sizeof(info),
+                 R"({"device":"%s","version":"%s","firmware":%d,"ip":"%u.%u.%u.%u"})",
+                 DEVICE_NAME, DEVICE_VERSION, FIRMWARE_VERSION, ip[0], ip[1], ip[2], ip[3]);
+        infoIP = (uint32_t) ip;
+    }
     return info;
 }
 
 
 /**
- * @brief Notify all clients of the current state
- *
- * @param server
+ * @brief Notify all clients of the state change. Changes within the push window share one delta
  */
 void notifyState();
 
 #if defined(ENABLE_SERVER)
 
+#include "CommandParser.h"
+
+enum ws_command_id_t {
+    WS_CMD_GET,
+    WS_CMD_R1,
+    WS_CMD_R2,
+    WS_CMD_R3,
+    WS_CMD_R4,
+    WS_CMD_VALVE,
+};
+
+const command_def_t WS_COMMANDS[] = {
+        {"GET",    WS_CMD_GET},
+        {"R1:",    WS_CMD_R1},
+        {"R2:",    WS_CMD_R2},
+        {"R3:",    WS_CMD_R3},
+        {"R4:",    WS_CMD_R4},
+        {"VALVE:", WS_CMD_VALVE},
+};
+
+const CommandParser wsParser(WS_COMMANDS, sizeof(WS_COMMANDS) / sizeof(WS_COMMANDS[0]));
+CommandAssembler wsAssembler;
+
+/**
+ * @brief "ON..." / "OFF..." argument of a relay command, as GenericOutput::setState(String) reads it
+ */
+void setOutputState(GenericOutput &output, const command_t &cmd) {
+    if (cmd.argStartsWith("ON")) {
+        output.on();
+    } else if (cmd.argStartsWith("OFF")) {
+        output.off();
+    }
+}
+
+/**
+ * @brief Run a complete WebSocket command
+ *
+ * @param client
+ * @param data message, not '\0' terminated
+ * @param len
+ */
+void WSCommand(AsyncWebSocketClient *client, const char *data, size_t len) {
+    Serial.printf("WS client [%d] message: %.*s\n", client->id(), (int) len, data);
+    command_t cmd;
+    if (!wsParser.parse(data, len, cmd)) return;
+
+    switch (cmd.id) {
+        case WS_CMD_GET:
+            // Also sent by a client that missed a delta
+            stateSnapshot.requestSnapshot(client->id());
+            break;
+        case WS_CMD_R1:
+            setOutputState(ValvePower, cmd);
+            break;
+        case WS_CMD_R2:
+            setOutputState(ValveDirection, cmd);
+            break;
+        case WS_CMD_R3:
+            setOutputState(PumpPower, cmd);
+            break;
+        case WS_CMD_R4:
+            setOutputState(ACPower, cmd);
+            break;
+        case WS_CMD_VALVE:
+            if (cmd.argStartsWith("OPEN")) {
+                Valve.open();
+#if defined(ENABLE_LOGGER)
+                logger.log("VALVE_OPEN", "WEB", client->remoteIP().toString());
+#endif
+            } else if (cmd.argStartsWith("CLOSE")) {
+                Valve.close();
+#if defined(ENABLE_LOGGER)
+                logger.log("VALVE_CLOSE", "WEB", client->remoteIP().toString());
+#endif
+            }
+            break;
+        default:
+            break;
+    }
+}
+
 /**
  * @brief WebSocket event handler
  *
@@ -173,46 +272,27 @@ void notifyState();
  */
 void
 WSHandler(AsyncWebSocket *sv, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len) {
-    String message = (char *) data;
-
     switch (type) {
         case WS_EVT_CONNECT:
             Serial.printf("WS client [%d] connected\n", client->id());
-            timer.setTimeout(100L, notifyState);
+            stateSnapshot.requestSnapshot(client->id());
             break;
         case WS_EVT_DISCONNECT:
             Serial.printf("WS client [%d] disconnected\n", client->id());
+            wsAssembler.release(client->id());
             break;
-        case WS_EVT_DATA:
-            Serial.printf("WS client [%d] message: %s\n", client->id(), message.c_str());
-            if (message.startsWith("GET")) {
-                notifyState();
-            } else if (message.startsWith("R1:")) {
-                ValvePower.setState(message.substring(3));
-            } else if (message.startsWith("R2:")) {
-                ValveDirection.setState(message.substring(3));
-            } else if (message.startsWith("R3:")) {
-                PumpPower.setState(message.substring(3));
-            } else if (message.startsWith("R4:")) {
-                ACPower.setState(message.substring(3));
-            } else if (message.startsWith("VALVE:")) {
-                String cmd = message.substring(6);
-                if (cmd.startsWith("OPEN")) {
-                    cmd = "OPEN";
-                    Valve.open();
-                } else if (cmd.startsWith("CLOSE")) {
-                    cmd = "CLOSE";
-                    Valve.close();
-                } else {
-                    cmd = "";
-                }
-#if defined(ENABLE_LOGGER)
-                if (cmd != "") {
-                    logger.log("VALVE_" + cmd, "WEB", client->remoteIP().toString());
-                }
-#endif
+        case WS_EVT_DATA: {
+            // A message may come in several frames, and a frame in several packets
+            auto *info = (AwsFrameInfo *) arg;
+            bool first = info->num == 0 && info->index == 0;
+            bool last = info->final && info->index + len == info->len;
+            const char *message;
+            size_t length;
+            if (wsAssembler.feed(client->id(), first, last, (const char *) data, len, message, length)) {
+                WSCommand(client, message, length);
             }
             break;
+        }
         case WS_EVT_PONG:
             break;
         case WS_EVT_ERROR:
@@ -237,22 +317,41 @@ void responseError(AsyncWebServerRequest *request, const String &message) {
 #if defined(ENABLE_NFIREBASE)
 
 void syncRTDB() {
-    JsonWriter writer;
-    object_t o1, o2, o3, o4, o5, o6, o7, json;
-    writer.create(o1, "valve", Valve.getState());
-//    writer.create(o2, "r1", ValvePower.getState());
-//    writer.create(o3, "r2", ValveDirection.getState());
-//    writer.create(o4, "r3", PumpPower.getState());
-//    writer.create(o5, "r4", ACPower.getState());
-    writer.create(o6, "water_leak", WaterLeak.getState());
-    writer.create(o7, "restart", false);
-//    writer.join(json, 7, o1, o2, o3, o4, o5, o6, o7);
-    writer.join(json, 3, o1, o6, o7);
-    FirebaseIOT.update("/data", json);
+    // The data node is empty, send everything in one update
+    stateReporter.invalidate();
+    stateReporter.report("/valve", Valve.getState());
+//    stateReporter.report("/r1", ValvePower.getState());
+//    stateReporter.report("/r2", ValveDirection.getState());
+//    stateReporter.report("/r3", PumpPower.getState());
+//    stateReporter.report("/r4", ACPower.getState());
+    stateReporter.report("/water_leak", WaterLeak.getState());
+    stateReporter.report("/restart", false);
+}
+
+/**
+ * @brief Send the batched device states as one multi-path update under /data
+ * @return false while not connected or the async queue is full, the reporter retries later
+ */
+bool sendStateReport(const String &payload) {
+    if (!FirebaseIOT.firstConnected() || aClient.taskCount() >= RTDB_QUEUE_LIMIT) {
+        return false;
+    }
+    FirebaseIOT.update("/data", (object_t) payload, [](AsyncResult &res) {
+        if (res.isError()) {
+            printResult(res);
+            stateReporter.onSent(false);
+        } else if (res.available()) {
+            stateReporter.onSent(true);
+        }
+    }, "stateReportTask");
+    return true;
 }
 
 void updateOTA() {
     Serial.println("Updating firmware...");
+    if (LastStateStore *store = GenericOutput::getLastStateStore()) {
+        store->flush();
+    }
     FirebaseIOT.beginOTA("/firmware/bin", [](AsyncResult &res) {
         if (res.isError()) {
             Serial.printf("OTA error: %s, code: %d\n", res.error().message().c_str(), res.error().code());
@@ -265,7 +364,7 @@ void updateOTA() {
                 timer.setTimeout(100L, []() {
                     FirebaseIOT.set("/data/restart", false, [](AsyncResult &res) {
                         Serial.println("Restarting...");
-                        ESP.restart();
+                        restartDevice();
                     });
                 });
             }
@@ -303,19 +402,84 @@ void checkOTA() {
 #endif
 
 
-void mainLoop() {
-    WaterLeak.loop();
-    ValvePower.loop();
-    ACPower.loop();
-    Valve.loop();
-    PumpPower.loop();
-    PowerVoltage.loop();
+/**
+ * @brief Register the devices to the deadline loop. Outputs and the water leak input only run when
+ * their next event is due; polled housekeeping keeps its own period.
+ */
+void setupDeviceLoop() {
+    WaterLeak.useInterrupt();
+    deviceLoop.add(WaterLeak);
+    deviceLoop.add(ValvePower);
+    deviceLoop.add(ACPower);
+    deviceLoop.add(Valve);
+    deviceLoop.add(PumpPower);
+    WaterFlow.begin();
+    deviceLoop.add([]() {
+        WaterFlow.loop();
+    }, []() {
+        return WaterFlow.getNextDeadline();
+    });
+    deviceLoop.every(500L, []() {
+        PowerVoltage.loop();
+    });
 #if defined(ENABLE_LOGGER)
-    logger.loop();
+    deviceLoop.every(500L, []() {
+        logger.loop();
+    });
 #endif
 #if defined(ENABLE_SERVER)
-    ws.cleanupClients();
+    deviceLoop.every(1000L, []() {
+        ws.cleanupClients();
+    });
+#endif
+#if defined(ENABLE_SCHEDULER)
+    deviceLoop.add([]() {
+        scheduler.run();
+    }, []() -> uint32_t {
+        time_t due = scheduler.nextDueTime();
+        if (!due) return 1000; // clock not set or index must be rebuilt
+        time_t now = time(nullptr);
+        return due <= now ? 0 : (uint32_t) std::min<time_t>(due - now, 3600) * 1000;
+    });
 #endif
+#if defined(ENABLE_NFIREBASE)
+    deviceLoop.add([]() {
+        stateReporter.loop();
+    }, []() {
+        return stateReporter.getNextDeadline();
+    });
+#endif
+#if defined(ENABLE_SERVER)
+    stateSnapshot.onPublish([](const char *text, size_t length) {
+        if (ws.getClients().isEmpty()) return;
+        ws.textAll(text, length);
+    });
+    // Requested from the async_tcp task, sent here so the buffer is not rewritten meanwhile
+    stateSnapshot.onSnapshot([](uint32_t clientId, const char *text, size_t length) {
+        if (clientId == STATE_SNAPSHOT_ALL_CLIENTS) {
+            ws.textAll(text, length);
+        } else {
+            ws.text(clientId, text, length);
+        }
+    });
+#endif
+    deviceLoop.add([]() {
+        stateSnapshot.loop();
+    }, []() {
+        return stateSnapshot.getNextDeadline();
+    });
+    if (LastStateStore *store = GenericOutput::getLastStateStore()) {
+        deviceLoop.add([store]() {
+            store->loop();
+        }, [store]() {
+            return store->getNextDeadline();
+        });
+    }
+    deviceLoop.add([]() {
+        timer.run();
+    }, []() {
+        return timer.getNextDeadline();
+    });
 }
 
 
@@ -326,26 +490,36 @@ void mainLoop() {
  *
  * @param task
  */
-void WateringTaskExec(schedule_task_t<WateringTaskArgs> task) {
+void WateringTaskExec(const schedule_task_t<WateringTaskArgs> &task) {
     if (task.args->waterLiters == 0 && task.args->duration == 0) {
         return;
     }
 
-    // @TODO implement for litters amount
-    if (task.args->waterLiters > 0) {
-    }
-
+    // With a volume target the duration only bounds the run in case the sensor stops counting
     if (task.args->duration > 0) {
         Valve.openOnce(task.args->duration * 60000L, true);
     } else {
-        // open with default duration
-        Valve.open(true);
+        // Volume only: bounded by the time the volume takes at the slowest expected flow
+        uint32_t timeout = (uint32_t) (task.args->waterLiters / WATERING_MIN_FLOW_LPM * 60000.0f) +
+                           WATERING_FLOW_MARGIN_MS;
+        Valve.openOnce(timeout, true);
     }
 
     // if specified, open the valve to a certain level
     if (task.args->valveOpenLevel > 0) {
         ValvePower.onPercentage(task.args->valveOpenLevel * 10);
     }
+
+    // Close on the measured volume
+    if (task.args->waterLiters > 0 && Valve.getState()) {
+        WaterFlow.reset();
+        WaterFlow.startTarget(task.args->waterLiters, []() {
+            Valve.close();
+#if defined(ENABLE_LOGGER)
+            logger.log("VALVE_CLOSE", "FLOW_TARGET", String(WaterFlow.getLiters()));
+#endif
+        });
+    }
 #if defined(ENABLE_LOGGER)
     logger.log("VALVE_OPEN", "SCHEDULE", task.args->toString());
 #endif
@@ -367,10 +541,13 @@ void setup() {
 
 //    logger.setTeleLogPrefix("🌱 Vườn cây");
 
-    timer.setInterval(1000L, []() {
-        Serial.print(".");
-        // Serial.printf("Free heap: %d\n", esp_get_free_heap_size());
-    });
+    stateSnapshot.add("R1", []() { return ValvePower.getState(); });
+    stateSnapshot.add("R2", []() { return ValveDirection.getState(); });
+    stateSnapshot.add("R3", []() { return PumpPower.getState(); });
+    stateSnapshot.add("R4", []() { return ACPower.getState(); });
+    // Same labels as Valve / WaterLeak state strings, the page matches on them
+    stateSnapshot.add("VALVE", []() { return Valve.getState(); }, "OPEN", "CLOSE");
+    stateSnapshot.add("WATER_LEAK", []() { return WaterLeak.getState(); }, "LEAK", "NONE");
 
     ACPower.onPowerOn([]() {
         delay(1000); // wait for power to stabilize
@@ -439,6 +616,10 @@ void setup() {
         });
 #endif
     });
+    Valve.onPowerOff([]() {
+        // Closed by hand, timeout or leak: drop the volume target
+        WaterFlow.cancelTarget();
+    });
     Valve.onAutoOff([]() {
 #if defined(ENABLE_LOGGER)
         logger.log("VALVE_CLOSE", "AUTO_TIMEOUT", "");
@@ -478,18 +659,32 @@ void setup() {
     server.onNotFound([](AsyncWebServerRequest *request) { request->send(404, "text/plain", "Not found"); });
 
 #if defined(ENABLE_WEB_INTERFACE)
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) { request->send(200, "text/html", MAINPAGE); });
+    // Gzipped at build time (web_page.py). The ETag changes with the page, so browsers revalidate on each load
+    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
+        AsyncWebHeader *match = request->getHeader("If-None-Match");
+        AsyncWebServerResponse *response;
+        if (match != nullptr && match->value() == MAIN_PAGE_ETAG) {
+            response = request->beginResponse(304);
+        } else {
+            response = request->beginResponse_P(200, "text/html", MAIN_PAGE_GZ, MAIN_PAGE_GZ_LENGTH);
+            response->addHeader("Content-Encoding", "gzip");
+        }
+        response->addHeader("ETag", MAIN_PAGE_ETAG);
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    });
 #endif // ENABLE_WEB_INTERFACE
 
     server.on("/info", HTTP_ANY, [](AsyncWebServerRequest *request) {
-        request->send(200, "application/json", getInfo());
+        const char *info = getInfo();
+        request->send_P(200, "application/json", (const uint8_t *) info, strlen(info));
     });
 
 
     server.on("/restart", HTTP_GET, [](AsyncWebServerRequest *request) {
         responseSuccess(request, "Restarting...");
         delay(1000);
-        ESP.restart();
+        restartDevice();
     });
 
     server.on("/reset", HTTP_GET, [](AsyncWebServerRequest *request) {
@@ -524,8 +719,30 @@ void setup() {
     });
 
 #if defined(ENABLE_LOGGER)
+    // ?from=<epoch>&to=<epoch>&limit=<lines>&reverse=1, streamed in chunks so the log size does not matter.
+    // ?format=raw returns the binary segments for log_decode.py
     server.on("/logs", HTTP_GET, [](AsyncWebServerRequest *request) {
-        responseSuccess(request, logger.getLogs());
+        log_query_t query;
+        if (request->hasParam("from")) {
+            query.from = request->getParam("from")->value().toInt();
+        }
+        if (request->hasParam("to")) {
+            query.to = request->getParam("to")->value().toInt();
+        }
+        if (request->hasParam("limit")) {
+            query.limit = request->getParam("limit")->value().toInt();
+        }
+        if (request->hasParam("reverse")) {
+            query.reverse = request->getParam("reverse")->value() != "0";
+        }
+        if (request->hasParam("format")) {
+            query.raw = request->getParam("format")->value() == "raw";
+        }
+        std::shared_ptr<LogReader> reader = logger.read(query);
+        const char *contentType = query.raw ? "application/octet-stream" : "text/plain";
+        request->send(request->beginChunkedResponse(contentType, [reader](uint8_t *buffer, size_t maxLen, size_t index) {
+            return reader->read(buffer, maxLen);
+        }));
     });
 #endif // ENABLE_LOGGER
 
@@ -545,75 +762,79 @@ void setup() {
             return responseError(request, "missing time");
         }
         bool isRepeatSet = false;
-        schedule_task_t<WateringTaskArgs> task = {
-                .enabled = true,
-                .executed = false,
-        };
+        schedule_task_t<WateringTaskArgs> task{};
+        task.enabled = true;
         task.id = scheduler.generateUid();
         task.time = scheduler.parseTime(request->getParam("time")->value());
         task.repeat = {};
-        task.args = new WateringTaskArgs();
-        if (request->hasParam("r1")) {
-            task.repeat.sunday = true;
-            isRepeatSet = true;
+        task.args = ScheduleArgsPool<WateringTaskArgs>::create();
+        if (!task.args) {
+            return responseError(request, "Failed to add schedule");
         }
-        if (request->hasParam("r2")) {
-            task.repeat.monday = true;
-            isRepeatSet = true;
-        }
-        if (request->hasParam("r3")) {
-            task.repeat.tuesday = true;
-            isRepeatSet = true;
-        }
-        if (request->hasParam("r4")) {
-            task.repeat.wednesday = true;
-            isRepeatSet = true;
+        // r1 = Sunday ... r7 = Saturday
+        for (uint8_t dow = 0; dow < 7; dow++) {
+            if (request->hasParam("r" + String(dow + 1))) {
+                task.repeat.set(dow);
+                isRepeatSet = true;
+            }
         }
-        if (request->hasParam("r5")) {
-            task.repeat.thursday = true;
-            isRepeatSet = true;
+        if (!isRepeatSet) {
+            task.repeat.mask = schedule_repeat_t::EVERYDAY;
         }
-        if (request->hasParam("r6")) {
-            task.repeat.friday = true;
-            isRepeatSet = true;
+        // Optional: run every `interval` minutes from `time` until `until` (HH:MM)
+        if (request->hasParam("interval") && request->hasParam("until")) {
+            long interval = request->getParam("interval")->value().toInt() * 60L;
+            task.until = scheduler.parseTime(request->getParam("until")->value());
+            // 1 - 1092 minutes, and not past midnight
+            if (interval <= 0 || !scheduler.isValidInterval(interval, task.time, task.until)) {
+                return responseError(request, "Invalid interval or until");
+            }
+            task.interval = interval;
         }
-        if (request->hasParam("r7")) {
-            task.repeat.saturday = true;
-            isRepeatSet = true;
+        // At least one of them: a volume target alone still closes on the flow-based safety timeout
+        bool hasDuration = request->hasParam("duration");
+        bool hasLiters = request->hasParam("water_liters");
+        if (!hasDuration && !hasLiters) {
+            return responseError(request, "missing duration or water_liters");
         }
-        if (!isRepeatSet) {
-            task.repeat = {
-                    .monday = true,
-                    .tuesday = true,
-                    .wednesday = true,
-                    .thursday = true,
-                    .friday = true,
-                    .saturday = true,
-                    .sunday = true,
-            };
+        if (hasDuration) {
+            long duration = request->getParam("duration")->value().toInt();
+            if (duration <= 0 || duration > UINT8_MAX) {
+                return responseError(request, "Invalid duration");
+            }
+            task.args->duration = duration;
+        } else {
+            task.args->duration = 0;
         }
-        if (request->hasParam("duration")) {
-            task.args->duration = request->getParam("duration")->value().toInt();
+        if (hasLiters) {
+            long liters = request->getParam("water_liters")->value().toInt();
+            if (liters <= 0 || liters > UINT8_MAX) {
+                return responseError(request, "Invalid water_liters");
+            }
+            task.args->waterLiters = liters;
         }
-//        if (request->hasParam("water_liters")) {
-//            task.args->waterLiters = request->getParam("water_liters")->value().toInt();
-//        }
         if (request->hasParam("valve_level")) {
             task.args->valveOpenLevel = request->getParam("valve_level")->value().toInt();
         }
-        if (scheduler.addTask(task)) {
+        uint8_t id = task.id;
+        if (scheduler.addTask(std::move(task))) {
             responseSuccess(request, "Schedule added");
 #if defined(ENABLE_LOGGER)
+            auto added = scheduler.getTaskById(id);
             String log = "*🌱 Đã thêm 1 hẹn giờ mới*\n";
-            log += "ID: `" + String(task.id) + "`\n";
-            log += "Thời gian: " + task.time.toString() + "\n";
-            log += "Thời lượng: " + String(task.args->duration) + " phút\n";
-            log += "Mức mở van: " + String(task.args->valveOpenLevel * 10) + "%\n";
-            log += "Lặp lại: " + task.repeat.toString() + "\n";
+            log += "ID: `" + String(added->id) + "`\n";
+            log += "Thời gian: " + added->time.toString() + "\n";
+            if (added->args->duration) {
+                log += "Thời lượng: " + String(added->args->duration) + " phút\n";
+            }
+            if (added->args->waterLiters) {
+                log += "Lượng nước: " + String(added->args->waterLiters) + " lít\n";
+            }
+            log += "Mức mở van: " + String(added->args->valveOpenLevel * 10) + "%\n";
+            log += "Lặp lại: " + added->repeat.toString() + "\n";
             logger.logTele(log);
 #endif // ENABLE_LOGGER
         } else {
-            delete task.args;
             responseError(request, "Failed to add schedule");
         }
     });
@@ -633,10 +854,67 @@ void setup() {
     });
 #endif // ENABLE_SCHEDULER
 
+    // Rolling min/avg/max, e.g. battery or solar sag under pump load
+    server.on("/voltage-stats", HTTP_GET, [](AsyncWebServerRequest *request) {
+        const char *names[] = {"1m", "1h", "24h"};
+        char json[256];
+        int len = snprintf(json, sizeof(json), R"({"voltage":%.2f)", PowerVoltage.get());
+        for (uint8_t i = 0; i < 3; i++) {
+            stats_bucket_t stats = PowerVoltage.getStats((voltage_window_t) i);
+            len += snprintf(json + len, sizeof(json) - len, R"(,"%s":{"min":%.2f,"avg":%.2f,"max":%.2f,"n":%u})",
+                            names[i], stats.min, stats.avg(), stats.max, (unsigned) stats.count);
+        }
+        snprintf(json + len, sizeof(json) - len, "}");
+        request->send(200, "application/json", json);
+    });
+
+    // Sample ring as CSV (uptime ms, volt), streamed in chunks without building the body in RAM
+    server.on("/voltage-samples", HTTP_GET, [](AsyncWebServerRequest *request) {
+        // Copied once here, the loop task keeps writing the ring while the response streams
+        struct snapshot_t {
+            voltage_sample_t samples[VOLTAGE_READER_SAMPLE_RING];
+            uint16_t count;
+            uint16_t next;
+        };
+        std::shared_ptr<snapshot_t> snapshot = std::make_shared<snapshot_t>();
+        snapshot->count = PowerVoltage.copySamples(snapshot->samples);
+        snapshot->next = 0;
+        AsyncWebServerResponse *response = request->beginChunkedResponse(
+                "text/csv", [snapshot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                    size_t len = 0;
+                    for (; snapshot->next < snapshot->count; snapshot->next++) {
+                        const voltage_sample_t &sample = snapshot->samples[snapshot->next];
+                        char row[24];
+                        int n = snprintf(row, sizeof(row), "%u,%.3f\n", (unsigned) sample.time, sample.volt);
+                        if (len + n > maxLen) break;
+                        memcpy(buffer + len, row, n);
+                        len += n;
+                    }
+                    return len;
+                });
+        request->send(response);
+    });
+
     server.on("/voltage", HTTP_GET, [](AsyncWebServerRequest *request) {
         responseSuccess(request, String(PowerVoltage.get()));
     });
 
+    // Live 1 s min/avg/max over Server-Sent Events
+    PowerVoltage.onSecond([](const stats_bucket_t &bucket) {
+        if (!voltageEvents.count()) return;
+        char data[48];
+        snprintf(data, sizeof(data), "%.2f,%.2f,%.2f", bucket.min, bucket.avg(), bucket.max);
+        voltageEvents.send(data, "voltage", millis());
+    });
+    server.addHandler(&voltageEvents);
+
+    server.on("/flow", HTTP_GET, [](AsyncWebServerRequest *request) {
+        char json[96];
+        snprintf(json, sizeof(json), R"({"liters":%.2f,"rate":%.2f,"remaining":%.2f})",
+                 WaterFlow.getLiters(), WaterFlow.getFlowRate(), WaterFlow.getRemainingLiters());
+        request->send(200, "application/json", json);
+    });
+
     /* ===================== */
 
     ws.onEvent(WSHandler);
@@ -649,19 +927,15 @@ void setup() {
     logger.log("START", "SYSTEM", String(FIRMWARE_VERSION));
 #endif // ENABLE_LOGGER
 
-    timer.setInterval(500L, mainLoop);
-
-#if defined(ENABLE_SCHEDULER)
-    timer.setInterval(3000L, []() {
-        scheduler.run();
-    });
-#endif
+    setupDeviceLoop();
 
 
 #if defined(ENABLE_NFIREBASE)
     RTDBObj = new fbrtdb_object();
     RTDBObj->client = &aClient;
     RTDBObj->rtdb = &Database;
+    RTDBObj->reporter = &stateReporter;
+    stateReporter.setSender(sendStateReport);
 
     // The path should be set after user is authenticated
     // <user_id>/<device_id>/data
@@ -710,7 +984,11 @@ void setup() {
                 syncRTDB();
             } else if (RTDB.dataPath() == "/" && RTDB.type() == realtime_database_data_type_json) {
                 JSON::JsonParser parser(RTDB.to<String>());
-                Valve.syncState(parser.get<bool>("valve"));
+                // A batched report comes back as a patch with only the changed keys
+                String valve = parser.get("valve");
+                if (valve.length()) {
+                    Valve.syncState(valve == "true");
+                }
                 // if (parser.get<bool>("water_leak") != WaterLeak.getState()) {
                 //     FirebaseIOT.set("/data/water_leak", WaterLeak.getState());
                 // }
@@ -722,7 +1000,7 @@ void setup() {
                 } else if (v == "true") {
                     FirebaseIOT.set("/data/restart", false, [](AsyncResult &res) {
                         Serial.println("Restarting...");
-                        ESP.restart();
+                        restartDevice();
                     });
                 } else if (v == "schedules") {
                     FirebaseIOT.set("/data/restart", false, [](AsyncResult &res) {
@@ -751,7 +1029,7 @@ void setup() {
 
 
 void loop() {
-    timer.run();
+    deviceLoop.run();
 }
 
 bool connectWiFi() {
@@ -774,16 +1052,5 @@ bool connectWiFi() {
 
 
 void notifyState() {
-
-#if defined(ENABLE_SERVER)
-    if (ws.getClients().isEmpty()) return;
-    String message = "R1:" + ValvePower.getStateString() + "\n";
-    message += "R2:" + ValveDirection.getStateString() + "\n";
-    message += "R3:" + PumpPower.getStateString() + "\n";
-    message += "R4:" + ACPower.getStateString() + "\n";
-    message += "VALVE:" + Valve.getStateString() + "\n";
-    message += "WATER_LEAK:" + WaterLeak.getStateString() + "\n";
-    ws.textAll(message);
-#endif
-
+    stateSnapshot.markChanged();
 }
\ No newline at end of file
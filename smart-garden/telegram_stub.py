@@ -0,0 +1,79 @@
+#
+# Local stand-in for api.telegram.org to measure the TBot sender (SLog.h): messages/sec and connections.
+#
+# usage: python telegram_stub.py [--port 8443] [--cert cert.pem --key key.pem] [--plain]
+#   A self-signed certificate is enough, TBot does not verify it:
+#   openssl req -x509 -newkey rsa:2048 -nodes -days 365 -subj /CN=stub -keyout key.pem -out cert.pem
+#   On the device: logger.setTeleServer("<pc ip>", 8443)
+#
+import argparse
+import http.server
+import socketserver
+import ssl
+import threading
+import time
+
+stats = {'requests': 0, 'connections': 0}
+stats_lock = threading.Lock()
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'  # keep-alive
+    disable_nagle_algorithm = True
+
+    def setup(self):
+        super().setup()
+        with stats_lock:
+            stats['connections'] += 1
+
+    def do_GET(self):
+        with stats_lock:
+            stats['requests'] += 1
+            message_id = stats['requests']
+        body = ('{"ok":true,"result":{"message_id":%d,"chat":{"id":1},"date":%d,"text":"stub"}}'
+                % (message_id, int(time.time()))).encode()
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format, *args):
+        pass
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+
+
+def report():
+    last = 0
+    while True:
+        time.sleep(1)
+        with stats_lock:
+            requests, connections = stats['requests'], stats['connections']
+        if requests != last:
+            print('{} msg/s, {} requests, {} connections'.format(requests - last, requests, connections))
+            last = requests
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Telegram Bot API stand-in')
+    parser.add_argument('--port', type=int, default=8443)
+    parser.add_argument('--cert', default='cert.pem')
+    parser.add_argument('--key', default='key.pem')
+    parser.add_argument('--plain', action='store_true', help='no TLS')
+    args = parser.parse_args()
+
+    server = Server(('', args.port), Handler)
+    if not args.plain:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.cert, args.key)
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+    threading.Thread(target=report, daemon=True).start()
+    print('Listening on port {}'.format(args.port))
+    server.serve_forever()
+
+
+if __name__ == '__main__':
+    main()
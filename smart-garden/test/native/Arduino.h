@@ -0,0 +1,405 @@
+//
+// Host stand-in for the ESP32 Arduino core (native env only).
+//
+// Provides String, Print/Stream, Serial, millis()/delay(), digital/analog IO and
+// time() backed by an in-memory board model that tests can drive through the
+// `native` namespace (fake clock, pin levels, ADC values).
+//
+
+#ifndef SMART_GARDEN_NATIVE_ARDUINO_H
+#define SMART_GARDEN_NATIVE_ARDUINO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "WString.h"
+
+using std::abs;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define PROGMEM
+#define PGM_P const char *
+#define IRAM_ATTR
+
+#define NATIVE_NUM_PINS 256
+
+
+/* ========= Board model ========= */
+
+namespace native {
+
+    struct board_t {
+        bool manualClock = false;
+        uint32_t manualMillis = 0;
+        time_t manualTime = 0; // 0 = use the host wall clock
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint8_t pinMode[NATIVE_NUM_PINS]{};
+        uint8_t pinLevel[NATIVE_NUM_PINS]{};
+        uint16_t analogValue[NATIVE_NUM_PINS]{};
+        void (*isr[NATIVE_NUM_PINS])(void *){};
+        void *isrArg[NATIVE_NUM_PINS]{};
+        uint8_t isrMode[NATIVE_NUM_PINS]{};
+        std::function<uint16_t(uint8_t)> analogSource = nullptr;
+        bool serialEcho = false;
+    };
+
+    inline board_t &board() {
+        static board_t b;
+        return b;
+    }
+
+    /**
+     * @brief Freeze millis() at the given value. delay() then advances the fake clock instead of sleeping
+     */
+    inline void setMillis(uint32_t ms) {
+        board().manualClock = true;
+        board().manualMillis = ms;
+    }
+
+    inline void advanceMillis(uint32_t ms) {
+        board().manualClock = true;
+        board().manualMillis += ms;
+    }
+
+    /**
+     * @brief Go back to the host monotonic clock
+     */
+    inline void useRealClock() {
+        board().manualClock = false;
+    }
+
+    /**
+     * @brief Fix the epoch returned by time(). Pass 0 to use the host wall clock
+     */
+    inline void setTime(time_t t) {
+        board().manualTime = t;
+    }
+
+    inline time_t clockTime(time_t *out) {
+        time_t t = board().manualTime ? board().manualTime : ::time(nullptr);
+        if (out) *out = t;
+        return t;
+    }
+
+    /**
+     * @brief Drive an input pin level as seen by digitalRead(). Fires the attached interrupt on a matching edge
+     */
+    inline void setPinLevel(uint8_t pin, uint8_t level) {
+        uint8_t previous = board().pinLevel[pin];
+        board().pinLevel[pin] = level ? HIGH : LOW;
+        uint8_t mode = board().isrMode[pin];
+        if (board().isr[pin] == nullptr || previous == board().pinLevel[pin]) return;
+        if (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level)) {
+            board().isr[pin](board().isrArg[pin]);
+        }
+    }
+
+    inline uint8_t getPinLevel(uint8_t pin) {
+        return board().pinLevel[pin];
+    }
+
+    inline void setAnalogValue(uint8_t pin, uint16_t value) {
+        board().analogValue[pin] = value;
+    }
+
+    /**
+     * @brief Feed analogRead() from a function, e.g. a recorded ADC trace
+     */
+    inline void setAnalogSource(std::function<uint16_t(uint8_t)> source) {
+        board().analogSource = std::move(source);
+    }
+
+    /**
+     * @brief Print Serial output to stdout (muted by default to keep benchmark output readable)
+     */
+    inline void setSerialEcho(bool echo) {
+        board().serialEcho = echo;
+    }
+
+    /**
+     * @brief Reset clock, pins and ADC to power-on defaults
+     */
+    inline void reset() {
+        board() = board_t();
+    }
+
+} // namespace native
+
+// Route time() through the board model so tests can move the wall clock
+#define time(t) native::clockTime(t)
+
+
+/* ========= Timing ========= */
+
+inline unsigned long millis() {
+    if (native::board().manualClock) {
+        return native::board().manualMillis;
+    }
+    return (unsigned long) std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - native::board().start).count();
+}
+
+inline unsigned long micros() {
+    if (native::board().manualClock) {
+        return native::board().manualMillis * 1000UL;
+    }
+    return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - native::board().start).count();
+}
+
+inline void delay(uint32_t ms) {
+    if (native::board().manualClock) {
+        native::board().manualMillis += ms;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {}
+
+inline void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1,
+                       const char *server2 = nullptr, const char *server3 = nullptr) {}
+
+
+/* ========= IO ========= */
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    native::board().pinMode[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+        native::board().pinLevel[pin] = HIGH;
+    } else if (mode == INPUT_PULLDOWN) {
+        native::board().pinLevel[pin] = LOW;
+    }
+}
+
+inline int digitalRead(uint8_t pin) {
+    return native::board().pinLevel[pin];
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+    native::board().pinLevel[pin] = val ? HIGH : LOW;
+}
+
+inline uint16_t analogRead(uint8_t pin) {
+    if (native::board().analogSource) {
+        return native::board().analogSource(pin);
+    }
+    return native::board().analogValue[pin];
+}
+
+inline uint8_t digitalPinToInterrupt(uint8_t pin) {
+    return pin;
+}
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode) {
+    native::board().isr[pin] = isr;
+    native::board().isrArg[pin] = arg;
+    native::board().isrMode[pin] = mode;
+}
+
+inline void detachInterrupt(uint8_t pin) {
+    native::board().isr[pin] = nullptr;
+    native::board().isrArg[pin] = nullptr;
+}
+
+/**
+ * @brief Linear 0 - 3.3 V conversion, the eFuse correction of the chip is not modelled
+ */
+inline uint32_t analogReadMilliVolts(uint8_t pin) {
+    return analogRead(pin) * 3300UL / 4095;
+}
+
+inline long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+inline long random(long min, long max) {
+    return max > min ? min + rand() % (max - min) : min;
+}
+
+
+/* ========= Print / Stream ========= */
+
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t n = 0;
+        while (size--) {
+            if (!write(*buffer++)) break;
+            n++;
+        }
+        return n;
+    }
+
+    size_t write(const char *str) {
+        return str ? write((const uint8_t *) str, strlen(str)) : 0;
+    }
+
+    size_t write(const char *buffer, size_t size) {
+        return write((const uint8_t *) buffer, size);
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        char tmp[128];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(tmp, sizeof(tmp), format, args);
+        va_end(args);
+        if (len < 0) return 0;
+        if ((size_t) len < sizeof(tmp)) {
+            return write((const uint8_t *) tmp, len);
+        }
+        std::vector<char> big(len + 1);
+        va_start(args, format);
+        vsnprintf(big.data(), big.size(), format, args);
+        va_end(args);
+        return write((const uint8_t *) big.data(), len);
+    }
+
+    size_t print(const String &s) { return write((const uint8_t *) s.c_str(), s.length()); }
+
+    size_t print(const char *s) { return write(s); }
+
+    size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+
+    size_t print(char c) { return write((uint8_t) c); }
+
+    size_t print(unsigned char n, int base = 10) { return print(String(n, base)); }
+
+    size_t print(int n, int base = 10) { return print(String(n, base)); }
+
+    size_t print(unsigned int n, int base = 10) { return print(String(n, base)); }
+
+    size_t print(long n, int base = 10) { return print(String(n, base)); }
+
+    size_t print(unsigned long n, int base = 10) { return print(String(n, base)); }
+
+    size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+
+    size_t println() { return write("\r\n"); }
+
+    template<typename V>
+    size_t println(const V &v) {
+        size_t n = print(v);
+        return n + println();
+    }
+
+    size_t println(unsigned long n, int base) { return print(n, base) + println(); }
+
+    size_t println(double n, int digits) { return print(n, digits) + println(); }
+
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+
+    virtual int read() = 0;
+
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+    virtual size_t readBytes(char *buffer, size_t length) {
+        size_t n = 0;
+        while (n < length) {
+            int c = read();
+            if (c < 0) break;
+            *buffer++ = (char) c;
+            n++;
+        }
+        return n;
+    }
+
+    size_t readBytes(uint8_t *buffer, size_t length) {
+        return readBytes((char *) buffer, length);
+    }
+
+    virtual String readString() {
+        String ret;
+        int c;
+        while ((c = read()) >= 0) {
+            ret += (char) c;
+        }
+        return ret;
+    }
+
+    virtual String readStringUntil(char terminator) {
+        String ret;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) {
+            ret += (char) c;
+        }
+        return ret;
+    }
+
+protected:
+    unsigned long _timeout = 1000;
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {}
+
+    void end() {}
+
+    explicit operator bool() const { return true; }
+
+    int available() override { return 0; }
+
+    int read() override { return -1; }
+
+    int peek() override { return -1; }
+
+    size_t write(uint8_t c) override {
+        if (native::board().serialEcho) fputc(c, stdout);
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        if (native::board().serialEcho) fwrite(buffer, 1, size, stdout);
+        return size;
+    }
+
+    using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+#endif //SMART_GARDEN_NATIVE_ARDUINO_H
@@ -0,0 +1,255 @@
+//
+// Host stand-in for the ESP32 fs::FS / fs::File API (native env only).
+// Each file system is mapped to a directory on the host, so SPIFFS/LittleFS
+// code paths run unchanged against real files.
+//
+
+#ifndef SMART_GARDEN_NATIVE_FS_H
+#define SMART_GARDEN_NATIVE_FS_H
+
+#include <Arduino.h>
+#include <filesystem>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+    enum SeekMode {
+        SeekSet = 0,
+        SeekCur = 1,
+        SeekEnd = 2
+    };
+
+    class File : public Stream {
+    public:
+        File() = default;
+
+        File(FILE *fp, const String &name, const String &path) : _impl(std::make_shared<impl_t>()) {
+            _impl->fp = fp;
+            _impl->name = name;
+            _impl->path = path;
+        }
+
+        explicit operator bool() const { return _impl && _impl->fp; }
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+
+        size_t write(const uint8_t *buf, size_t size) override {
+            if (!*this) return 0;
+            return fwrite(buf, 1, size, _impl->fp);
+        }
+
+        using Print::write;
+
+        int available() override {
+            if (!*this) return 0;
+            return (int) (size() - position());
+        }
+
+        int read() override {
+            if (!*this) return -1;
+            return fgetc(_impl->fp);
+        }
+
+        size_t read(uint8_t *buf, size_t size) {
+            if (!*this) return 0;
+            return fread(buf, 1, size, _impl->fp);
+        }
+
+        size_t readBytes(char *buffer, size_t length) override {
+            return read((uint8_t *) buffer, length);
+        }
+
+        int peek() override {
+            if (!*this) return -1;
+            int c = fgetc(_impl->fp);
+            if (c >= 0) ungetc(c, _impl->fp);
+            return c;
+        }
+
+        void flush() override {
+            if (*this) fflush(_impl->fp);
+        }
+
+        bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+            if (!*this) return false;
+            int whence = mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END;
+            return fseek(_impl->fp, (long) pos, whence) == 0;
+        }
+
+        size_t position() const {
+            if (!*this) return 0;
+            long pos = ftell(_impl->fp);
+            return pos < 0 ? 0 : (size_t) pos;
+        }
+
+        size_t size() const {
+            if (!*this) return 0;
+            fflush(_impl->fp);
+            std::error_code ec;
+            auto sz = std::filesystem::file_size(_impl->path.c_str(), ec);
+            return ec ? 0 : (size_t) sz;
+        }
+
+        void close() {
+            if (*this) {
+                fclose(_impl->fp);
+                _impl->fp = nullptr;
+            }
+        }
+
+        const char *name() const {
+            return _impl ? _impl->name.c_str() : nullptr;
+        }
+
+        const char *path() const {
+            return _impl ? _impl->path.c_str() : nullptr;
+        }
+
+        bool isFile() const { return (bool) *this; }
+
+        bool isDirectory() const { return false; }
+
+    private:
+        struct impl_t {
+            FILE *fp = nullptr;
+            String name;
+            String path;
+
+            ~impl_t() {
+                if (fp) fclose(fp);
+            }
+        };
+
+        std::shared_ptr<impl_t> _impl;
+    };
+
+    class FS {
+    public:
+        /**
+         * @param label sub directory of the host root ($NATIVE_FS_ROOT or <tmp>/smart-garden-fs)
+         */
+        explicit FS(const char *label) : _label(label) {}
+
+        bool begin(bool formatOnFail = false, const char *basePath = "", uint8_t maxOpenFiles = 10,
+                   const char *partitionLabel = nullptr) {
+            std::error_code ec;
+            std::filesystem::create_directories(root(), ec);
+            _mounted = !ec;
+            return _mounted;
+        }
+
+        void end() {
+            _mounted = false;
+        }
+
+        bool format() {
+            std::error_code ec;
+            std::filesystem::remove_all(root(), ec);
+            std::filesystem::create_directories(root(), ec);
+            return !ec;
+        }
+
+        File open(const char *path, const char *mode = FILE_READ, bool create = false) {
+            std::string p = _hostPath(path);
+            bool writing = mode[0] == 'w' || mode[0] == 'a';
+            if (writing || create) {
+                std::error_code ec;
+                std::filesystem::create_directories(std::filesystem::path(p).parent_path(), ec);
+            } else if (!std::filesystem::exists(p)) {
+                return {};
+            }
+            // Always open in binary mode so seek()/size() match the on-device byte offsets
+            std::string m = mode;
+            if (m.find('b') == std::string::npos) m += "b";
+            FILE *fp = fopen(p.c_str(), m.c_str());
+            if (!fp) return {};
+            const char *name = strrchr(path, '/');
+            return {fp, name ? name + 1 : path, p};
+        }
+
+        File open(const String &path, const char *mode = FILE_READ, bool create = false) {
+            return open(path.c_str(), mode, create);
+        }
+
+        bool exists(const char *path) const {
+            return std::filesystem::exists(_hostPath(path));
+        }
+
+        bool exists(const String &path) const {
+            return exists(path.c_str());
+        }
+
+        bool remove(const char *path) {
+            std::error_code ec;
+            return std::filesystem::remove(_hostPath(path), ec);
+        }
+
+        bool remove(const String &path) {
+            return remove(path.c_str());
+        }
+
+        bool rename(const char *pathFrom, const char *pathTo) {
+            std::error_code ec;
+            std::filesystem::rename(_hostPath(pathFrom), _hostPath(pathTo), ec);
+            return !ec;
+        }
+
+        bool rename(const String &pathFrom, const String &pathTo) {
+            return rename(pathFrom.c_str(), pathTo.c_str());
+        }
+
+        bool mkdir(const char *path) {
+            std::error_code ec;
+            return std::filesystem::create_directories(_hostPath(path), ec);
+        }
+
+        bool mkdir(const String &path) {
+            return mkdir(path.c_str());
+        }
+
+        bool rmdir(const char *path) {
+            std::error_code ec;
+            return std::filesystem::remove(_hostPath(path), ec);
+        }
+
+        size_t totalBytes() const { return 512 * 1024; }
+
+        size_t usedBytes() const {
+            size_t used = 0;
+            std::error_code ec;
+            for (auto &entry: std::filesystem::recursive_directory_iterator(root(), ec)) {
+                if (entry.is_regular_file()) used += entry.file_size();
+            }
+            return used;
+        }
+
+        std::string root() const {
+            const char *env = getenv("NATIVE_FS_ROOT");
+            std::filesystem::path base = env ? std::filesystem::path(env)
+                                             : std::filesystem::temp_directory_path() / "smart-garden-fs";
+            return (base / _label).string();
+        }
+
+    private:
+        const char *_label;
+        bool _mounted = false;
+
+        std::string _hostPath(const char *path) const {
+            while (*path == '/') path++;
+            return (std::filesystem::path(root()) / path).string();
+        }
+    };
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif //SMART_GARDEN_NATIVE_FS_H
@@ -0,0 +1,12 @@
+//
+// Host stand-in for the LittleFS instance (native env only).
+//
+
+#ifndef SMART_GARDEN_NATIVE_LITTLEFS_H
+#define SMART_GARDEN_NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+inline fs::FS LittleFS("littlefs");
+
+#endif //SMART_GARDEN_NATIVE_LITTLEFS_H
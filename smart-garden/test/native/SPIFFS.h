@@ -0,0 +1,14 @@
+//
+// Host stand-in for the ESP32 SPIFFS instance (native env only).
+//
+
+#ifndef SMART_GARDEN_NATIVE_SPIFFS_H
+#define SMART_GARDEN_NATIVE_SPIFFS_H
+
+#include "FS.h"
+
+#define _SPIFFS_H_
+
+inline fs::FS SPIFFS("spiffs");
+
+#endif //SMART_GARDEN_NATIVE_SPIFFS_H
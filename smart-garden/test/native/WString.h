@@ -0,0 +1,339 @@
+//
+// Host stand-in for the Arduino String class (native env only).
+// Implements the subset of the ESP32 core API used by the firmware libraries.
+//
+
+#ifndef SMART_GARDEN_NATIVE_WSTRING_H
+#define SMART_GARDEN_NATIVE_WSTRING_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+class __FlashStringHelper;
+
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+class String {
+public:
+    String() = default;
+
+    String(const char *cstr) : _buf(cstr ? cstr : "") {}
+
+    String(const char *cstr, unsigned int length) : _buf(cstr ? cstr : "", cstr ? length : 0) {}
+
+    String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+
+    String(const std::string &str) : _buf(str) {}
+
+    explicit String(char c) : _buf(1, c) {}
+
+    explicit String(unsigned char value, unsigned char base = 10) : String((unsigned long) value, base) {}
+
+    explicit String(int value, unsigned char base = 10) : String((long) value, base) {}
+
+    explicit String(unsigned int value, unsigned char base = 10) : String((unsigned long) value, base) {}
+
+    explicit String(long value, unsigned char base = 10) {
+        if (base == 10) {
+            _buf = std::to_string(value);
+        } else if (value < 0) {
+            _buf = "-" + _toBase((unsigned long) -value, base);
+        } else {
+            _buf = _toBase((unsigned long) value, base);
+        }
+    }
+
+    explicit String(unsigned long value, unsigned char base = 10) : _buf(_toBase(value, base)) {}
+
+    explicit String(long long value, unsigned char base = 10) : String((long) value, base) {}
+
+    explicit String(unsigned long long value, unsigned char base = 10) : String((unsigned long) value, base) {}
+
+    explicit String(float value, unsigned int decimalPlaces = 2) : String((double) value, decimalPlaces) {}
+
+    explicit String(double value, unsigned int decimalPlaces = 2) {
+        char tmp[64];
+        snprintf(tmp, sizeof(tmp), "%.*f", decimalPlaces, value);
+        _buf = tmp;
+    }
+
+    /* ========= Memory ========= */
+
+    bool reserve(unsigned int size) {
+        _buf.reserve(size);
+        return true;
+    }
+
+    unsigned int length() const { return _buf.length(); }
+
+    bool isEmpty() const { return _buf.empty(); }
+
+    const char *c_str() const { return _buf.c_str(); }
+
+    char *begin() { return &_buf[0]; }
+
+    char *end() { return &_buf[0] + _buf.length(); }
+
+    const char *begin() const { return _buf.c_str(); }
+
+    const char *end() const { return _buf.c_str() + _buf.length(); }
+
+    /* ========= Concat ========= */
+
+    bool concat(const String &str) {
+        _buf += str._buf;
+        return true;
+    }
+
+    bool concat(const char *cstr) {
+        if (cstr) _buf += cstr;
+        return true;
+    }
+
+    bool concat(const char *cstr, unsigned int length) {
+        if (cstr) _buf.append(cstr, length);
+        return true;
+    }
+
+    bool concat(char c) {
+        _buf += c;
+        return true;
+    }
+
+    bool concat(unsigned char c) { return concat(String(c)); }
+
+    bool concat(int num) { return concat(String(num)); }
+
+    bool concat(unsigned int num) { return concat(String(num)); }
+
+    bool concat(long num) { return concat(String(num)); }
+
+    bool concat(unsigned long num) { return concat(String(num)); }
+
+    bool concat(float num) { return concat(String(num)); }
+
+    bool concat(double num) { return concat(String(num)); }
+
+    template<typename V>
+    String &operator+=(const V &rhs) {
+        concat(rhs);
+        return *this;
+    }
+
+    String &operator+=(const __FlashStringHelper *str) {
+        concat(reinterpret_cast<const char *>(str));
+        return *this;
+    }
+
+    /* ========= Comparison ========= */
+
+    int compareTo(const String &s) const { return _buf.compare(s._buf); }
+
+    bool equals(const String &s) const { return _buf == s._buf; }
+
+    bool equals(const char *cstr) const { return _buf == (cstr ? cstr : ""); }
+
+    bool equalsIgnoreCase(const String &s) const {
+        if (s.length() != length()) return false;
+        for (unsigned int i = 0; i < length(); i++) {
+            if (tolower((unsigned char) _buf[i]) != tolower((unsigned char) s._buf[i])) return false;
+        }
+        return true;
+    }
+
+    bool operator==(const String &rhs) const { return equals(rhs); }
+
+    bool operator==(const char *cstr) const { return equals(cstr); }
+
+    bool operator!=(const String &rhs) const { return !equals(rhs); }
+
+    bool operator!=(const char *cstr) const { return !equals(cstr); }
+
+    bool operator<(const String &rhs) const { return _buf < rhs._buf; }
+
+    bool operator>(const String &rhs) const { return _buf > rhs._buf; }
+
+    bool startsWith(const String &prefix) const { return startsWith(prefix, 0); }
+
+    bool startsWith(const String &prefix, unsigned int offset) const {
+        if (offset > length() || prefix.length() > length() - offset) return false;
+        return _buf.compare(offset, prefix.length(), prefix._buf) == 0;
+    }
+
+    bool endsWith(const String &suffix) const {
+        if (suffix.length() > length()) return false;
+        return _buf.compare(length() - suffix.length(), suffix.length(), suffix._buf) == 0;
+    }
+
+    /* ========= Character access ========= */
+
+    char charAt(unsigned int index) const { return index < length() ? _buf[index] : 0; }
+
+    void setCharAt(unsigned int index, char c) {
+        if (index < length()) _buf[index] = c;
+    }
+
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    char &operator[](unsigned int index) {
+        static char dummy;
+        if (index >= length()) {
+            dummy = 0;
+            return dummy;
+        }
+        return _buf[index];
+    }
+
+    void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const {
+        if (!bufsize || !buf) return;
+        if (index >= length()) {
+            buf[0] = 0;
+            return;
+        }
+        unsigned int n = std::min<unsigned int>(bufsize - 1, length() - index);
+        memcpy(buf, _buf.c_str() + index, n);
+        buf[n] = 0;
+    }
+
+    void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const {
+        getBytes((unsigned char *) buf, bufsize, index);
+    }
+
+    /* ========= Search ========= */
+
+    int indexOf(char ch, unsigned int fromIndex = 0) const { return _pos(_buf.find(ch, fromIndex)); }
+
+    int indexOf(const String &str, unsigned int fromIndex = 0) const { return _pos(_buf.find(str._buf, fromIndex)); }
+
+    int indexOf(const char *str, unsigned int fromIndex = 0) const { return _pos(_buf.find(str, fromIndex)); }
+
+    int lastIndexOf(char ch) const { return _pos(_buf.rfind(ch)); }
+
+    int lastIndexOf(char ch, unsigned int fromIndex) const { return _pos(_buf.rfind(ch, fromIndex)); }
+
+    int lastIndexOf(const String &str) const { return _pos(_buf.rfind(str._buf)); }
+
+    int lastIndexOf(const String &str, unsigned int fromIndex) const { return _pos(_buf.rfind(str._buf, fromIndex)); }
+
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+
+    String substring(unsigned int left, unsigned int right) const {
+        if (left > right) std::swap(left, right);
+        if (left >= length()) return {};
+        if (right > length()) right = length();
+        return String(_buf.substr(left, right - left));
+    }
+
+    /* ========= Modification ========= */
+
+    void replace(char find, char replace) {
+        for (auto &c: _buf) {
+            if (c == find) c = replace;
+        }
+    }
+
+    void replace(const String &find, const String &replace) {
+        if (find.isEmpty()) return;
+        std::string out;
+        out.reserve(_buf.length());
+        size_t pos = 0, hit;
+        while ((hit = _buf.find(find._buf, pos)) != std::string::npos) {
+            out.append(_buf, pos, hit - pos);
+            out += replace._buf;
+            pos = hit + find.length();
+        }
+        out.append(_buf, pos, std::string::npos);
+        _buf.swap(out);
+    }
+
+    void remove(unsigned int index) { remove(index, (unsigned int) -1); }
+
+    void remove(unsigned int index, unsigned int count) {
+        if (index >= length()) return;
+        _buf.erase(index, count);
+    }
+
+    void toLowerCase() {
+        for (auto &c: _buf) c = (char) tolower((unsigned char) c);
+    }
+
+    void toUpperCase() {
+        for (auto &c: _buf) c = (char) toupper((unsigned char) c);
+    }
+
+    void trim() {
+        size_t first = 0;
+        while (first < _buf.length() && isspace((unsigned char) _buf[first])) ++first;
+        size_t last = _buf.length();
+        while (last > first && isspace((unsigned char) _buf[last - 1])) --last;
+        _buf = _buf.substr(first, last - first);
+    }
+
+    /* ========= Parsing ========= */
+
+    long toInt() const { return atol(_buf.c_str()); }
+
+    float toFloat() const { return (float) atof(_buf.c_str()); }
+
+    double toDouble() const { return atof(_buf.c_str()); }
+
+private:
+    std::string _buf;
+
+    static int _pos(size_t pos) { return pos == std::string::npos ? -1 : (int) pos; }
+
+    static std::string _toBase(unsigned long value, unsigned char base) {
+        if (base < 2 || base > 36) base = 10;
+        char tmp[72];
+        char *p = tmp + sizeof(tmp) - 1;
+        *p = 0;
+        do {
+            unsigned long d = value % base;
+            *--p = (char) (d < 10 ? '0' + d : 'a' + d - 10);
+            value /= base;
+        } while (value);
+        return p;
+    }
+};
+
+inline String operator+(const String &lhs, const String &rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+
+inline String operator+(const String &lhs, const char *rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+
+inline String operator+(const char *lhs, const String &rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+
+inline String operator+(const String &lhs, char rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+
+inline String operator+(const String &lhs, const __FlashStringHelper *rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+
+inline bool operator==(const char *lhs, const String &rhs) { return rhs == lhs; }
+
+inline bool operator!=(const char *lhs, const String &rhs) { return rhs != lhs; }
+
+#endif //SMART_GARDEN_NATIVE_WSTRING_H
@@ -0,0 +1,128 @@
+//
+// Minimal benchmark runner for the native env.
+//
+// Usage (inside a Unity test):
+//     auto r = bench::measure("Scheduler::parseTask", 10000, [&]() { ... });
+//     TEST_ASSERT_TRUE(r.nsPerOp > 0);
+//
+// Results are printed as "[bench] <name> <ns/op> ns/op (<iterations> iterations)" so CI can grep and
+// compare them between runs.
+//
+// Heap allocations are counted with bench::countAllocations() when exactly one test file defines
+// BENCH_COUNT_ALLOCATIONS before including this header (it replaces the global operator new).
+//
+
+#ifndef SMART_GARDEN_NATIVE_BENCH_H
+#define SMART_GARDEN_NATIVE_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace bench {
+
+    struct result_t {
+        const char *name;
+        uint32_t iterations;
+        double nsPerOp;
+    };
+
+    /**
+     * @brief Prevent the compiler from optimising away a benchmarked value
+     */
+    template<typename T>
+    inline void doNotOptimize(T const &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * @brief Run fn() `iterations` times (after one warm-up call) and report the mean cost per call.
+     * Uses the host steady clock, so it is not affected by native::setMillis()
+     */
+    template<typename Fn>
+    inline result_t measure(const char *name, uint32_t iterations, Fn &&fn) {
+        if (iterations == 0) iterations = 1;
+        fn();
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            fn();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result_t result{name, iterations, elapsed / iterations};
+        printf("[bench] %-48s %12.1f ns/op (%u iterations)\n", name, result.nsPerOp, iterations);
+        fflush(stdout);
+        return result;
+    }
+
+    inline size_t &allocationCounter() {
+        static size_t count = 0;
+        return count;
+    }
+
+    /**
+     * @brief Run fn() `iterations` times (after one warm-up call) and report the mean number of heap
+     * allocations per call. Needs BENCH_COUNT_ALLOCATIONS, see above
+     */
+    template<typename Fn>
+    inline double countAllocations(const char *name, uint32_t iterations, Fn &&fn) {
+        if (iterations == 0) iterations = 1;
+        fn();
+        size_t start = allocationCounter();
+        for (uint32_t i = 0; i < iterations; i++) {
+            fn();
+        }
+        double perOp = (double) (allocationCounter() - start) / iterations;
+        printf("[bench] %-48s %12.2f allocs/op (%u iterations)\n", name, perOp, iterations);
+        fflush(stdout);
+        return perOp;
+    }
+
+} // namespace bench
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+
+// Every form of new / delete goes through malloc / free, so each pointer is released by its own allocator.
+// GCC still flags free() once a replaced delete is inlined into a new-expression's cleanup: it pairs the
+// pointer with the built-in operator new, not with this one. The pairing is correct, silence it here only
+
+void *operator new(size_t size) {
+    bench::allocationCounter()++;
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // BENCH_COUNT_ALLOCATIONS
+
+#endif //SMART_GARDEN_NATIVE_BENCH_H
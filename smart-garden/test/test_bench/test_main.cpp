@@ -0,0 +1,269 @@
+//
+// Host benchmarks for the firmware libraries: `pio test -e native -f test_bench -v`
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#define BENCH_COUNT_ALLOCATIONS
+#include "bench.h"
+
+#include "DeviceLoop.h"
+#include "GenericInput.h"
+#include "GenericOutput.h"
+#include "Logger.h"
+#include "StateSnapshot.h"
+#include "VirtualOutput.h"
+#include "WateringSchedule.h"
+#include "json_parser.h"
+
+static const char *TASK_LINE = "123|6|30|1010101|10-0-5|1|0";
+
+void setUp() {
+    native::reset();
+    native::setTime(1721000000); // 2024-07-14
+    SPIFFS.format();
+}
+
+void tearDown() {}
+
+static void fillScheduler(Scheduler<WateringTaskArgs> &scheduler, uint8_t count) {
+    scheduler.MAX_TASKS = count;
+    for (int i = 1; i <= count; i++) {
+        schedule_task_t<WateringTaskArgs> task{};
+        task.id = static_cast<uint8_t>(i);
+        task.time = {static_cast<uint8_t>(i % 24), static_cast<uint8_t>(i % 60)};
+        task.repeat = {schedule_repeat_t::MONDAY | schedule_repeat_t::WEDNESDAY | schedule_repeat_t::FRIDAY};
+        task.args = ScheduleArgsPool<WateringTaskArgs>::create(10, 0, 5);
+        task.enabled = true;
+        TEST_ASSERT_TRUE(scheduler.addTask(std::move(task)));
+    }
+}
+
+void test_bench_json_get_property() {
+    String body = R"({"valve":true,"water_leak":false,"restart":"schedules","info":{"version":445}})";
+    auto r = bench::measure("JSON::getProperty", 20000, [&]() {
+        bench::doNotOptimize(JSON::getProperty(body, "restart"));
+    });
+    TEST_ASSERT_EQUAL_STRING("schedules", JSON::getProperty(body, "restart").c_str());
+    TEST_ASSERT_TRUE(r.nsPerOp > 0);
+}
+
+void test_bench_scheduler_parse_task() {
+    String line = TASK_LINE;
+    auto r = bench::measure("Scheduler::parseTask", 20000, [&]() {
+        auto task = Scheduler<WateringTaskArgs>::parseTask(line);
+        bench::doNotOptimize(task.id);
+    });
+    auto task = Scheduler<WateringTaskArgs>::parseTask(line);
+    TEST_ASSERT_EQUAL_UINT8(123, task.id);
+    TEST_ASSERT_EQUAL_UINT8(6, task.time.hour);
+    TEST_ASSERT_EQUAL_UINT8(30, task.time.minute);
+    TEST_ASSERT_EQUAL_UINT8(5, task.args->duration);
+    TEST_ASSERT_TRUE(r.nsPerOp > 0);
+}
+
+void test_bench_scheduler_parse_payload() {
+    const uint8_t counts[] = {8, 64, 255};
+    const char *names[] = {
+            "Scheduler::parseTasks (8 tasks payload)",
+            "Scheduler::parseTasks (64 tasks payload)",
+            "Scheduler::parseTasks (255 tasks payload)",
+    };
+    for (uint8_t i = 0; i < 3; i++) {
+        // Keyed RTDB payload: {"t1":"1|1|1|1010101|10-0-5|1|0",...}
+        String payload = "{";
+        for (int id = 1; id <= counts[i]; id++) {
+            if (id > 1) payload += ",";
+            payload += "\"t" + String(id) + "\":\"" + String(id) + "|" + String(id % 24) + "|" + String(id % 60) +
+                       "|1010101|10-0-5|1|0\"";
+        }
+        payload += "}";
+
+        std::vector<schedule_task_t<WateringTaskArgs>> tasks;
+        tasks.reserve(counts[i]);
+        bench::measure(names[i], 2000, [&]() {
+            tasks.clear();
+            Scheduler<WateringTaskArgs>::parseTasks(payload.c_str(), tasks, 255);
+        });
+        TEST_ASSERT_EQUAL(counts[i], tasks.size());
+        TEST_ASSERT_EQUAL_UINT8(counts[i], tasks.back().id);
+    }
+}
+
+void test_bench_scheduler_save_load() {
+    Scheduler<WateringTaskArgs> scheduler;
+    fillScheduler(scheduler, 32);
+    bench::measure("Scheduler::save (32 tasks)", 200, [&]() {
+        scheduler.save();
+    });
+    bench::measure("Scheduler::load (32 tasks)", 200, [&]() {
+        scheduler.load();
+    });
+    TEST_ASSERT_EQUAL_UINT8(32, scheduler.getTaskCount());
+}
+
+void test_bench_scheduler_update() {
+    Scheduler<WateringTaskArgs> scheduler;
+    fillScheduler(scheduler, 32);
+    scheduler.save();
+    uint8_t minute = 0;
+    bench::measure("Scheduler::updateTask (32 tasks, journaled)", 200, [&]() {
+        schedule_task_t<WateringTaskArgs> task{};
+        task.id = 16;
+        task.time = {16, static_cast<uint8_t>(minute++ % 60)};
+        task.repeat = scheduler.getTaskById(16)->repeat;
+        task.args = ScheduleArgsPool<WateringTaskArgs>::create(10, 0, 5);
+        task.enabled = true;
+        scheduler.updateTask(16, std::move(task));
+    });
+    TEST_ASSERT_EQUAL_UINT8(32, scheduler.getTaskCount());
+}
+
+void test_bench_scheduler_run() {
+    const uint8_t counts[] = {8, 64, 255};
+    const char *names[] = {
+            "Scheduler::run (8 tasks, none due)",
+            "Scheduler::run (64 tasks, none due)",
+            "Scheduler::run (255 tasks, none due)",
+    };
+    for (uint8_t i = 0; i < 3; i++) {
+        SPIFFS.format();
+        Scheduler<WateringTaskArgs> scheduler;
+        fillScheduler(scheduler, counts[i]);
+        bench::measure(names[i], 100000, [&]() {
+            scheduler.run();
+        });
+        TEST_ASSERT_EQUAL_UINT8(counts[i], scheduler.getTaskCount());
+    }
+}
+
+void test_bench_logger_log() {
+    Logger logger;
+    logger.clearAllLogs();
+    auto r = bench::measure("Logger::log", 2000, [&]() {
+        logger.log("VALVE_OPEN", "SCHEDULE", "10-0-5");
+    });
+    TEST_ASSERT_TRUE(logger.getLogs().length() > 0);
+    TEST_ASSERT_TRUE(r.nsPerOp > 0);
+
+    // No allocation per record, only when a batch is flushed (file open)
+    double allocs = bench::countAllocations("Logger::log", 2000, [&]() {
+        logger.log("VALVE_OPEN", "SCHEDULE", "10-0-5");
+    });
+    TEST_ASSERT_TRUE(allocs < 1);
+
+    // Before NTP the entries go to the fixed queue
+    native::setTime(1000);
+    double queued = bench::countAllocations("Logger::log (time not set)", 2000, [&]() {
+        logger.log("VALVE_OPEN", "SCHEDULE", "10-0-5");
+    });
+    TEST_ASSERT_EQUAL_FLOAT(0, queued);
+    TEST_ASSERT_EQUAL_UINT8(LOG_QUEUE_SIZE, logger.getQueueCount());
+}
+
+void test_bench_generic_output_loop() {
+    GenericOutput output(19, LOW, stdGenericOutput::START_UP_OFF, 8000L);
+    output.on();
+    bench::measure("GenericOutput::loop", 100000, [&]() {
+        output.loop();
+    });
+    TEST_ASSERT_TRUE(output.getState());
+}
+
+void test_bench_generic_input_loop() {
+    GenericInput input(34, INPUT_PULLUP, LOW);
+    input.onHoldState(true, 5000L, []() {});
+    bench::measure("GenericInput::loop", 100000, [&]() {
+        input.loop();
+    });
+    TEST_ASSERT_FALSE(input.getState());
+}
+
+void test_bench_device_loop_idle() {
+    native::setMillis(1000);
+    DeviceLoop deviceLoop;
+    GenericInput input(34, INPUT_PULLUP, LOW);
+    GenericOutput outputs[4] = {GenericOutput(19), GenericOutput(18), GenericOutput(16), GenericOutput(4)};
+    input.useInterrupt();
+    deviceLoop.add(input);
+    for (auto &output: outputs) {
+        deviceLoop.add(output);
+    }
+    outputs[0].setDuration(8000);
+    outputs[0].on();
+    uint32_t next = 0;
+    bench::measure("DeviceLoop::runOnce (5 devices, none due)", 100000, [&]() {
+        next = deviceLoop.runOnce();
+    });
+    TEST_ASSERT_EQUAL_UINT32(8000, next);
+}
+
+static GenericOutput *snapshotRelay = nullptr;
+static GenericInput *snapshotLeak = nullptr;
+
+void test_bench_state_snapshot() {
+    GenericOutput relay1(19, LOW, stdGenericOutput::START_UP_OFF);
+    GenericOutput relay2(18, LOW, stdGenericOutput::START_UP_OFF);
+    VirtualOutput valve(100, stdGenericOutput::START_UP_OFF);
+    GenericInput leak(34, INPUT_PULLUP, LOW);
+    snapshotRelay = &relay1;
+    snapshotLeak = &leak;
+
+    // The notifyState() text before the snapshot
+    auto concat = [&]() {
+        String message = "R1:" + relay1.getStateString() + "\n";
+        message += "R2:" + relay2.getStateString() + "\n";
+        message += "VALVE:" + valve.getStateString() + "\n";
+        message += "WATER_LEAK:" + leak.getStateString() + "\n";
+        return message;
+    };
+
+    StateSnapshot snapshot;
+    snapshot.add("R1", []() { return snapshotRelay->getState(); });
+    snapshot.add("R2", []() { return false; });
+    snapshot.add("VALVE", []() { return false; });
+    snapshot.add("WATER_LEAK", []() { return snapshotLeak->getState(); }, "ACTIVE", "NONE");
+    TEST_ASSERT_EQUAL_STRING(("S:0\n" + concat()).c_str(), snapshot.c_str());
+
+    double concatAllocs = bench::countAllocations("notifyState String concat", 1000, [&]() {
+        bench::doNotOptimize(concat().length());
+    });
+    double snapshotAllocs = bench::countAllocations("StateSnapshot::c_str", 1000, [&]() {
+        bench::doNotOptimize(snapshot.length());
+    });
+    TEST_ASSERT_TRUE(concatAllocs > 0);
+    TEST_ASSERT_TRUE(snapshotAllocs == 0);
+
+    bench::measure("notifyState String concat", 20000, [&]() {
+        bench::doNotOptimize(concat().length());
+    });
+    bench::measure("StateSnapshot::c_str", 20000, [&]() {
+        bench::doNotOptimize(snapshot.c_str());
+    });
+
+    // Rendered again only on an actual change, still without allocation
+    uint32_t renders = snapshot.getRenderCount();
+    size_t allocs = bench::allocationCounter();
+    relay1.on();
+    snapshot.c_str();
+    snapshot.c_str();
+    TEST_ASSERT_EQUAL_UINT32(renders + 1, snapshot.getRenderCount());
+    TEST_ASSERT_EQUAL(allocs, bench::allocationCounter());
+    TEST_ASSERT_EQUAL_STRING(("S:0\n" + concat()).c_str(), snapshot.c_str());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_json_get_property);
+    RUN_TEST(test_bench_scheduler_parse_task);
+    RUN_TEST(test_bench_scheduler_parse_payload);
+    RUN_TEST(test_bench_scheduler_save_load);
+    RUN_TEST(test_bench_scheduler_update);
+    RUN_TEST(test_bench_scheduler_run);
+    RUN_TEST(test_bench_logger_log);
+    RUN_TEST(test_bench_generic_output_loop);
+    RUN_TEST(test_bench_generic_input_loop);
+    RUN_TEST(test_bench_device_loop_idle);
+    RUN_TEST(test_bench_state_snapshot);
+    return UNITY_END();
+}
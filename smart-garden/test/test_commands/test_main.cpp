@@ -0,0 +1,128 @@
+//
+// WebSocket command parser tests: `pio test -e native -f test_commands`
+//
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "CommandParser.h"
+
+enum {
+    CMD_GET,
+    CMD_R1,
+    CMD_VALVE,
+    CMD_VALVE_POWER,
+};
+
+static const command_def_t COMMANDS[] = {
+        {"GET",     CMD_GET},
+        {"R1:",     CMD_R1},
+        {"VALVEP:", CMD_VALVE_POWER},
+        {"VALVE:",  CMD_VALVE},
+};
+
+static const CommandParser parser(COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0]));
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_parse_resolves_prefix_and_argument() {
+    command_t cmd;
+    TEST_ASSERT_TRUE(parser.parse("R1:ON", 5, cmd));
+    TEST_ASSERT_EQUAL_UINT8(CMD_R1, cmd.id);
+    TEST_ASSERT_EQUAL(2, cmd.argLength);
+    TEST_ASSERT_TRUE(cmd.argStartsWith("ON"));
+    TEST_ASSERT_FALSE(cmd.argStartsWith("OFF"));
+
+    TEST_ASSERT_TRUE(parser.parse("VALVE:close", 11, cmd));
+    TEST_ASSERT_EQUAL_UINT8(CMD_VALVE, cmd.id);
+    TEST_ASSERT_TRUE(cmd.argStartsWith("CLOSE"));
+
+    TEST_ASSERT_TRUE(parser.parse("VALVEP:OFF", 10, cmd));
+    TEST_ASSERT_EQUAL_UINT8(CMD_VALVE_POWER, cmd.id);
+
+    TEST_ASSERT_TRUE(parser.parse("GET", 3, cmd));
+    TEST_ASSERT_EQUAL_UINT8(CMD_GET, cmd.id);
+    TEST_ASSERT_EQUAL(0, cmd.argLength);
+
+    TEST_ASSERT_FALSE(parser.parse("R9:ON", 5, cmd));
+    TEST_ASSERT_EQUAL_UINT8(COMMAND_UNKNOWN, cmd.id);
+    TEST_ASSERT_FALSE(parser.parse("", 0, cmd));
+}
+
+void test_parse_is_bounded_by_length() {
+    // Not terminated: the frame buffer continues with unrelated bytes
+    const char frame[] = {'R', '1', ':', 'O', 'N', 'Z', 'Z'};
+    command_t cmd;
+    TEST_ASSERT_FALSE(parser.parse(frame, 2, cmd));
+    TEST_ASSERT_TRUE(parser.parse(frame, 4, cmd));
+    TEST_ASSERT_FALSE(cmd.argStartsWith("ON"));
+    TEST_ASSERT_TRUE(parser.parse(frame, 5, cmd));
+    TEST_ASSERT_TRUE(cmd.argStartsWith("ON"));
+}
+
+void test_assembler_passes_whole_messages_through() {
+    CommandAssembler assembler;
+    const char data[] = "R1:ON";
+    const char *message = nullptr;
+    size_t length = 0;
+    TEST_ASSERT_TRUE(assembler.feed(1, true, true, data, 5, message, length));
+    TEST_ASSERT_EQUAL_PTR(data, message);
+    TEST_ASSERT_EQUAL(5, length);
+}
+
+void test_assembler_joins_fragments_per_client() {
+    CommandAssembler assembler;
+    const char *message = nullptr;
+    size_t length = 0;
+
+    // Two clients interleaving their fragments
+    TEST_ASSERT_FALSE(assembler.feed(1, true, false, "VAL", 3, message, length));
+    TEST_ASSERT_FALSE(assembler.feed(2, true, false, "R1", 2, message, length));
+    TEST_ASSERT_FALSE(assembler.feed(1, false, false, "VE:", 3, message, length));
+    TEST_ASSERT_TRUE(assembler.feed(2, false, true, ":OFF", 4, message, length));
+    TEST_ASSERT_EQUAL(6, length);
+    TEST_ASSERT_EQUAL_INT(0, memcmp("R1:OFF", message, length));
+    TEST_ASSERT_TRUE(assembler.feed(1, false, true, "OPEN", 4, message, length));
+    TEST_ASSERT_EQUAL(10, length);
+    TEST_ASSERT_EQUAL_INT(0, memcmp("VALVE:OPEN", message, length));
+
+    // Continuation without a start is ignored
+    TEST_ASSERT_FALSE(assembler.feed(3, false, true, "ON", 2, message, length));
+}
+
+void test_assembler_drops_oversized_and_released_messages() {
+    CommandAssembler assembler;
+    const char *message = nullptr;
+    size_t length = 0;
+    char chunk[COMMAND_MAX_LENGTH];
+    memset(chunk, 'x', sizeof(chunk));
+
+    TEST_ASSERT_FALSE(assembler.feed(1, true, false, chunk, sizeof(chunk), message, length));
+    TEST_ASSERT_FALSE(assembler.feed(1, false, true, "!", 1, message, length));
+    // The slot is free again
+    TEST_ASSERT_FALSE(assembler.feed(1, true, false, "GE", 2, message, length));
+    TEST_ASSERT_TRUE(assembler.feed(1, false, true, "T", 1, message, length));
+    TEST_ASSERT_EQUAL(3, length);
+
+    // A client leaving in the middle of a message frees its slot
+    for (uint32_t id = 10; id < 10 + COMMAND_ASSEMBLER_SLOTS; id++) {
+        assembler.feed(id, true, false, "R1", 2, message, length);
+    }
+    TEST_ASSERT_FALSE(assembler.feed(99, true, false, "R1", 2, message, length));
+    TEST_ASSERT_FALSE(assembler.feed(99, false, true, ":ON", 3, message, length));
+    assembler.release(10);
+    TEST_ASSERT_FALSE(assembler.feed(99, true, false, "R1", 2, message, length));
+    TEST_ASSERT_TRUE(assembler.feed(99, false, true, ":ON", 3, message, length));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_resolves_prefix_and_argument);
+    RUN_TEST(test_parse_is_bounded_by_length);
+    RUN_TEST(test_assembler_passes_whole_messages_through);
+    RUN_TEST(test_assembler_joins_fragments_per_client);
+    RUN_TEST(test_assembler_drops_oversized_and_released_messages);
+    return UNITY_END();
+}
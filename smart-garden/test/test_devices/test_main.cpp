@@ -0,0 +1,759 @@
+//
+// DeviceLib unit tests: `pio test -e native -f test_devices`
+//
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "DeviceLoop.h"
+#include "DeviceTimer.h"
+#include "FlowMeter.h"
+#include "GenericInput.h"
+#include "GenericOutput.h"
+#include "LastStateStore.h"
+#include "StateReporter.h"
+#include "StateSnapshot.h"
+#include <SPIFFS.h>
+
+static const uint8_t VALVE_PIN = 19;
+static const uint8_t LEAK_PIN = 34;
+static const uint8_t FLOW_PIN = 35;
+
+void setUp() {
+    native::reset();
+    native::setMillis(1000);
+    SPIFFS.format();
+}
+
+void tearDown() {}
+
+void test_output_reports_auto_off_deadline() {
+    GenericOutput output(VALVE_PIN, LOW, stdGenericOutput::START_UP_OFF, 8000L);
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, output.getNextDeadline());
+
+    output.on();
+    TEST_ASSERT_EQUAL_UINT32(8000, output.getNextDeadline());
+    native::advanceMillis(7999);
+    output.loop();
+    TEST_ASSERT_TRUE(output.getState());
+    TEST_ASSERT_EQUAL_UINT32(1, output.getNextDeadline());
+
+    native::advanceMillis(1);
+    TEST_ASSERT_EQUAL_UINT32(0, output.getNextDeadline());
+    output.loop();
+    TEST_ASSERT_FALSE(output.getState());
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, output.getNextDeadline());
+}
+
+void test_output_once_duration_and_power_on_delay() {
+    GenericOutput output(VALVE_PIN, LOW, stdGenericOutput::START_UP_OFF, 8000L);
+    output.onOnce(2000);
+    TEST_ASSERT_EQUAL_UINT32(2000, output.getNextDeadline());
+    output.off();
+
+    output.setPowerOnDelay(300);
+    output.on();
+    TEST_ASSERT_FALSE(output.getState());
+    TEST_ASSERT_EQUAL_UINT32(300, output.getNextDeadline());
+    native::advanceMillis(300);
+    output.loop();
+    TEST_ASSERT_TRUE(output.getState());
+    TEST_ASSERT_EQUAL_UINT32(8000, output.getNextDeadline());
+}
+
+void test_output_auto_off_survives_millis_rollover() {
+    native::setMillis(0xFFFFF000UL);
+    GenericOutput output(VALVE_PIN, LOW, stdGenericOutput::START_UP_OFF, 8000L);
+    output.on();
+    native::advanceMillis(7999); // wraps past 0
+    output.loop();
+    TEST_ASSERT_TRUE(output.getState());
+    native::advanceMillis(1);
+    output.loop();
+    TEST_ASSERT_FALSE(output.getState());
+}
+
+void test_loop_sleeps_until_output_deadline() {
+    DeviceLoop deviceLoop;
+    GenericOutput output(VALVE_PIN, LOW, stdGenericOutput::START_UP_OFF, 8000L);
+    uint32_t offAt = 0;
+    output.onPowerOff([&]() { offAt = millis(); });
+    deviceLoop.add(output);
+
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_MAX_SLEEP_MS, deviceLoop.runOnce());
+
+    uint32_t onAt = millis();
+    output.on();
+    uint32_t wakeUps = 0;
+    while (output.getState() && wakeUps < 100) {
+        deviceLoop.run();
+        wakeUps++;
+    }
+    TEST_ASSERT_FALSE(output.getState());
+    TEST_ASSERT_EQUAL_UINT32(8000, offAt - onAt);
+    TEST_ASSERT_TRUE(wakeUps <= 3);
+}
+
+void test_loop_runs_periodic_entries() {
+    DeviceLoop deviceLoop;
+    uint32_t runs = 0;
+    deviceLoop.every(500, [&]() { runs++; });
+    for (int i = 0; i < 10; i++) {
+        deviceLoop.run();
+    }
+    // The first pass starts the period, every run() after that waits exactly one period
+    TEST_ASSERT_EQUAL_UINT32(9, runs);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 10 * 500, millis());
+}
+
+void test_input_interrupt_wakes_loop() {
+    DeviceLoop deviceLoop;
+    GenericInput input(LEAK_PIN, INPUT_PULLUP, LOW);
+    uint32_t activeAt = 0;
+    input.onActive([&]() { activeAt = millis(); });
+    input.useInterrupt();
+    deviceLoop.add(input);
+
+    // Nothing pending: the loop sleeps for the maximum time
+    deviceLoop.runOnce();
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, input.getNextDeadline());
+
+    uint32_t edgeAt = millis();
+    native::setPinLevel(LEAK_PIN, LOW);
+    TEST_ASSERT_EQUAL_UINT32(0, input.getNextDeadline());
+    // A pending wake-up makes wait() return right away
+    deviceLoop.wait(DEVICE_LOOP_MAX_SLEEP_MS);
+    TEST_ASSERT_EQUAL_UINT32(edgeAt, millis());
+
+    TEST_ASSERT_EQUAL_UINT32(50, deviceLoop.runOnce());
+    deviceLoop.run();
+    deviceLoop.runOnce();
+    TEST_ASSERT_TRUE(input.getState());
+    TEST_ASSERT_EQUAL_UINT32(edgeAt + 50, activeAt);
+}
+
+void test_input_without_interrupt_polls_at_debounce_period() {
+    GenericInput input(LEAK_PIN, INPUT_PULLUP, LOW, 40);
+    input.loop();
+    TEST_ASSERT_EQUAL_UINT32(40, input.getNextDeadline());
+}
+
+struct edge_t {
+    uint32_t at;
+    uint8_t level;
+};
+
+/**
+ * @brief Replay an edge sequence on the pin as the ISR would see it, without running loop()
+ */
+static void injectEdges(uint8_t pin, std::initializer_list<edge_t> edges) {
+    for (auto &edge: edges) {
+        native::setMillis(edge.at);
+        native::setPinLevel(pin, edge.level);
+    }
+}
+
+void test_input_ignores_glitch_shorter_than_debounce() {
+    GenericInput input(LEAK_PIN, INPUT_PULLUP, LOW);
+    uint32_t changes = 0;
+    input.onChange([&]() { changes++; });
+    input.useInterrupt();
+
+    injectEdges(LEAK_PIN, {{1000, LOW}, {1030, HIGH}});
+    native::setMillis(1500);
+    input.loop();
+    TEST_ASSERT_EQUAL_UINT32(0, changes);
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, input.getNextDeadline());
+}
+
+void test_input_catches_pulse_shorter_than_loop_period() {
+    GenericInput input(LEAK_PIN, INPUT_PULLUP, LOW);
+    std::vector<std::pair<bool, uint32_t>> events;
+    input.onActive([&]() { events.emplace_back(true, millis()); });
+    input.onInactive([&]() { events.emplace_back(false, millis()); });
+    input.useInterrupt();
+
+    // 200 ms leak pulse with contact bounce, drained once 500 ms later
+    injectEdges(LEAK_PIN, {{1000, LOW}, {1003, HIGH}, {1006, LOW}, {1200, HIGH}, {1202, LOW}, {1204, HIGH}});
+    native::setMillis(1700);
+    input.loop();
+    TEST_ASSERT_EQUAL(2, events.size());
+    TEST_ASSERT_TRUE(events[0].first);
+    TEST_ASSERT_FALSE(events[1].first);
+    TEST_ASSERT_FALSE(input.getState());
+}
+
+void test_input_reacts_within_debounce_time() {
+    DeviceLoop deviceLoop;
+    GenericInput input(LEAK_PIN, INPUT_PULLUP, LOW, 30);
+    uint32_t activeAt = 0;
+    input.onActive([&]() { activeAt = millis(); });
+    input.useInterrupt();
+    deviceLoop.add(input);
+    deviceLoop.runOnce();
+
+    injectEdges(LEAK_PIN, {{2000, LOW}, {2004, HIGH}, {2009, LOW}});
+    for (int i = 0; i < 5 && !activeAt; i++) {
+        deviceLoop.run();
+    }
+    TEST_ASSERT_EQUAL_UINT32(2009 + 30, activeAt);
+}
+
+void test_input_hold_state_from_edge_timestamps() {
+    GenericInput input(LEAK_PIN, INPUT_PULLUP, LOW);
+    uint32_t heldAt = 0;
+    input.onHoldState(true, 1000, [&]() { heldAt = millis(); });
+    input.useInterrupt();
+
+    injectEdges(LEAK_PIN, {{1000, LOW}});
+    // Drained late: the hold time counts from the debounced edge, not from the drain
+    native::setMillis(1400);
+    input.loop();
+    TEST_ASSERT_EQUAL_UINT32(1000 + 50 + 1000 - 1400, input.getNextDeadline());
+    native::setMillis(2049);
+    input.loop();
+    TEST_ASSERT_EQUAL_UINT32(0, heldAt);
+    native::setMillis(2050);
+    input.loop();
+    TEST_ASSERT_EQUAL_UINT32(2050, heldAt);
+}
+
+void test_input_resyncs_after_queue_overflow() {
+    GenericInput input(LEAK_PIN, INPUT_PULLUP, LOW);
+    input.useInterrupt();
+    for (uint32_t i = 0; i < GENERIC_INPUT_EDGE_QUEUE_SIZE * 2 + 1; i++) {
+        injectEdges(LEAK_PIN, {{1000 + i, (uint8_t) (i % 2 ? HIGH : LOW)}});
+    }
+    TEST_ASSERT_TRUE(input.getDroppedEdges() > 0);
+    native::setMillis(1100);
+    input.loop();
+    native::setMillis(1200);
+    input.loop();
+    TEST_ASSERT_TRUE(input.getState());
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, input.getNextDeadline());
+}
+
+/**
+ * @brief Synthetic flow sensor output: `count` falling edges at `hz`
+ */
+static void pulseTrain(uint8_t pin, uint32_t count, uint32_t hz) {
+    for (uint32_t i = 0; i < count; i++) {
+        native::setPinLevel(pin, LOW);
+        native::advanceMillis(1000 / hz / 2);
+        native::setPinLevel(pin, HIGH);
+        native::advanceMillis(1000 / hz - 1000 / hz / 2);
+    }
+}
+
+void test_flow_meter_counts_liters_and_rate() {
+    native::setPinLevel(FLOW_PIN, HIGH);
+    FlowMeter flow(FLOW_PIN, 450.0f);
+    flow.begin();
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, flow.getNextDeadline());
+
+    // 2 L/min = 15 Hz for 60 s
+    for (int s = 0; s < 60; s++) {
+        pulseTrain(FLOW_PIN, 15, 15);
+        flow.loop();
+    }
+    TEST_ASSERT_EQUAL_UINT32(900, flow.getPulses());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f, flow.getLiters());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 2.0f, flow.getFlowRate());
+
+    // Flow stopped: the rate drops to 0 and the meter goes idle
+    native::advanceMillis(FLOW_METER_RATE_PERIOD);
+    flow.loop();
+    TEST_ASSERT_EQUAL_FLOAT(0, flow.getFlowRate());
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, flow.getNextDeadline());
+}
+
+void test_flow_meter_closes_at_target_volume() {
+    native::setPinLevel(FLOW_PIN, HIGH);
+    DeviceLoop deviceLoop;
+    FlowMeter flow(FLOW_PIN, 450.0f);
+    flow.begin();
+    deviceLoop.add([&]() { flow.loop(); }, [&]() { return flow.getNextDeadline(); });
+
+    uint32_t closedAtPulse = 0;
+    flow.reset();
+    flow.startTarget(1.5f, [&]() { closedAtPulse = flow.getPulses(); });
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.5f, flow.getRemainingLiters());
+
+    // Drive the loop the way the firmware does: run when due, pulses arrive while it sleeps
+    for (int i = 0; i < 2000 && !closedAtPulse; i++) {
+        pulseTrain(FLOW_PIN, 1, 20);
+        if (flow.getNextDeadline() == 0) deviceLoop.runOnce();
+    }
+    TEST_ASSERT_EQUAL_UINT32(675, closedAtPulse);
+    TEST_ASSERT_FALSE(flow.hasTarget());
+    TEST_ASSERT_EQUAL_FLOAT(0, flow.getRemainingLiters());
+
+    // A cancelled target never fires
+    bool fired = false;
+    flow.startTarget(0.01f, [&]() { fired = true; });
+    flow.cancelTarget();
+    pulseTrain(FLOW_PIN, 10, 20);
+    flow.loop();
+    TEST_ASSERT_FALSE(fired);
+}
+
+void test_flow_meter_calibration() {
+    native::setPinLevel(FLOW_PIN, HIGH);
+    FlowMeter flow(FLOW_PIN, 450.0f);
+    flow.begin();
+    flow.reset();
+    pulseTrain(FLOW_PIN, 1000, 50);
+    // 1000 pulses actually filled 2.5 L
+    TEST_ASSERT_TRUE(flow.calibrate(2.5f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 400.0f, flow.getKFactor());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.5f, flow.getLiters());
+    TEST_ASSERT_FALSE(flow.calibrate(0));
+}
+
+static size_t fileSize(const char *path) {
+    File file = SPIFFS.open(path, "r");
+    size_t size = file ? file.size() : 0;
+    if (file) file.close();
+    return size;
+}
+
+static const size_t LAST_STATE_FILE_SIZE = sizeof(last_state_header_t) + 2 * sizeof(last_state_record_t);
+
+void test_last_state_store_round_trip() {
+    {
+        LastStateStore store(SPIFFS);
+        TEST_ASSERT_TRUE(store.begin());
+        TEST_ASSERT_EQUAL_INT8(-1, store.get(19));
+        store.set(19, true);
+        store.set(100, true);
+        store.set(100, false);
+        TEST_ASSERT_EQUAL_INT8(0, store.get(100));
+        TEST_ASSERT_TRUE(store.flush());
+    }
+    TEST_ASSERT_EQUAL(LAST_STATE_FILE_SIZE, fileSize("/gpiols.bin"));
+
+    LastStateStore reloaded(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(1, reloaded.get(19));
+    TEST_ASSERT_EQUAL_INT8(0, reloaded.get(100));
+    TEST_ASSERT_EQUAL_INT8(-1, reloaded.get(18));
+    TEST_ASSERT_EQUAL_UINT32(0, reloaded.getWriteCount());
+}
+
+void test_last_state_store_coalesces_writes() {
+    LastStateStore store(SPIFFS);
+    store.begin();
+    uint32_t writes = store.getWriteCount();
+
+    // onOnce / power-on-delay style burst on two pins
+    for (int i = 0; i < 10; i++) {
+        store.set(19, i % 2 == 0);
+        store.set(16, true);
+        native::advanceMillis(200);
+        store.loop();
+    }
+    TEST_ASSERT_EQUAL_UINT32(writes, store.getWriteCount());
+    TEST_ASSERT_EQUAL_UINT32(LAST_STATE_FLUSH_DELAY - 200, store.getNextDeadline());
+
+    native::advanceMillis(LAST_STATE_FLUSH_DELAY - 200);
+    store.loop();
+    TEST_ASSERT_EQUAL_UINT32(writes + 1, store.getWriteCount());
+    TEST_ASSERT_FALSE(store.isDirty());
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, store.getNextDeadline());
+
+    // Flipped back before the flush: nothing to write
+    store.set(19, true);
+    store.set(19, false);
+    native::advanceMillis(LAST_STATE_FLUSH_DELAY);
+    store.loop();
+    TEST_ASSERT_EQUAL_UINT32(writes + 1, store.getWriteCount());
+
+    LastStateStore reloaded(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(0, reloaded.get(19));
+    TEST_ASSERT_EQUAL_INT8(1, reloaded.get(16));
+}
+
+void test_last_state_store_bounds_flush_delay() {
+    LastStateStore store(SPIFFS);
+    store.begin();
+    uint32_t writes = store.getWriteCount();
+    // Never quiet: the first change is still saved within the max delay
+    for (uint32_t t = 0; t < LAST_STATE_MAX_FLUSH_DELAY; t += 1000) {
+        store.set(19, (t / 1000) % 2);
+        native::advanceMillis(1000);
+        store.loop();
+    }
+    TEST_ASSERT_EQUAL_UINT32(writes + 1, store.getWriteCount());
+}
+
+void test_last_state_store_survives_torn_flush() {
+    {
+        LastStateStore store(SPIFFS);
+        store.set(19, true);
+        store.flush();
+        store.set(19, false);
+        store.set(18, true);
+        store.flush();
+    }
+    // Reset while writing the next record: it lands in the older copy and is cut short
+    File file = SPIFFS.open("/gpiols.bin", "r+");
+    last_state_record_t records[2];
+    file.seek(sizeof(last_state_header_t));
+    file.read((uint8_t *) records, sizeof(records));
+    uint8_t older = records[0].seq < records[1].seq ? 0 : 1;
+    file.seek(sizeof(last_state_header_t) + older * sizeof(last_state_record_t) + 4);
+    uint8_t torn[40];
+    memset(torn, 1, sizeof(torn));
+    file.write(torn, sizeof(torn));
+    file.close();
+
+    LastStateStore reloaded(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(0, reloaded.get(19));
+    TEST_ASSERT_EQUAL_INT8(1, reloaded.get(18));
+
+    // Both copies broken: start over
+    file = SPIFFS.open("/gpiols.bin", "r+");
+    file.seek(sizeof(last_state_header_t) + (older ^ 1) * sizeof(last_state_record_t) + 4);
+    file.write(torn, sizeof(torn));
+    file.close();
+    LastStateStore reset(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(-1, reset.get(19));
+}
+
+void test_last_state_store_upgrades_version_1_file() {
+    File file = SPIFFS.open("/gpiols.bin", "w", true);
+    last_state_header_t header{{'G', 'L', 'S'}, 1};
+    uint8_t slots[LAST_STATE_SLOTS];
+    memset(slots, LAST_STATE_UNKNOWN, sizeof(slots));
+    slots[19] = 1;
+    slots[100] = 0;
+    file.write((const uint8_t *) &header, sizeof(header));
+    file.write(slots, sizeof(slots));
+    file.close();
+
+    LastStateStore store(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(1, store.get(19));
+    TEST_ASSERT_EQUAL_INT8(0, store.get(100));
+    TEST_ASSERT_EQUAL(LAST_STATE_FILE_SIZE, fileSize("/gpiols.bin"));
+}
+
+void test_last_state_store_migrates_legacy_text() {
+    // "1:" is a prefix of "11:" and "101:" in the text format
+    File legacy = SPIFFS.open("/gpiols", "w", true);
+    legacy.print("11:1\n101:1\n1:0\n19:1\n");
+    legacy.close();
+
+    LastStateStore store(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(0, store.get(1));
+    TEST_ASSERT_EQUAL_INT8(1, store.get(11));
+    TEST_ASSERT_EQUAL_INT8(1, store.get(101));
+    TEST_ASSERT_EQUAL_INT8(1, store.get(19));
+    TEST_ASSERT_FALSE(SPIFFS.exists("/gpiols"));
+
+    store.set(1, true);
+    store.flush();
+    LastStateStore reloaded(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(1, reloaded.get(1));
+    TEST_ASSERT_EQUAL_INT8(1, reloaded.get(11));
+}
+
+void test_last_state_store_resets_invalid_file() {
+    File file = SPIFFS.open("/gpiols.bin", "w", true);
+    file.print("garbage");
+    file.close();
+
+    LastStateStore store(SPIFFS);
+    TEST_ASSERT_EQUAL_INT8(-1, store.get(19));
+    TEST_ASSERT_EQUAL(LAST_STATE_FILE_SIZE, fileSize("/gpiols.bin"));
+}
+
+struct report_sink_t {
+    std::vector<String> payloads;
+    bool busy = false;
+};
+
+static void attachSink(StateReporter &reporter, report_sink_t &sink) {
+    reporter.setSender([&sink](const String &payload) {
+        if (sink.busy) return false;
+        sink.payloads.push_back(payload);
+        return true;
+    });
+}
+
+void test_state_reporter_coalesces_devices() {
+    StateReporter reporter;
+    report_sink_t sink;
+    attachSink(reporter, sink);
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, reporter.getNextDeadline());
+
+    // Valve opening: power, direction, pump and AC within a few ms
+    reporter.report("/r1", true);
+    native::advanceMillis(5);
+    reporter.report("/r2", true);
+    reporter.report("/r3", true);
+    reporter.report("/r4", true);
+    TEST_ASSERT_EQUAL_UINT32(STATE_REPORTER_WINDOW - 5, reporter.getNextDeadline());
+    reporter.loop();
+    TEST_ASSERT_EQUAL(0, sink.payloads.size());
+
+    native::advanceMillis(STATE_REPORTER_WINDOW);
+    reporter.loop();
+    TEST_ASSERT_EQUAL(1, sink.payloads.size());
+    TEST_ASSERT_EQUAL_STRING("{\"r1\":true,\"r2\":true,\"r3\":true,\"r4\":true}", sink.payloads[0].c_str());
+
+    // Only one update in flight, the next change waits for the answer
+    reporter.report("/r1", false);
+    native::advanceMillis(STATE_REPORTER_WINDOW);
+    reporter.loop();
+    TEST_ASSERT_EQUAL(1, sink.payloads.size());
+    reporter.onSent(true);
+    TEST_ASSERT_EQUAL_UINT32(0, reporter.getNextDeadline());
+    reporter.loop();
+    TEST_ASSERT_EQUAL(2, sink.payloads.size());
+    TEST_ASSERT_EQUAL_STRING("{\"r1\":false}", sink.payloads[1].c_str());
+}
+
+void test_state_reporter_drops_flapping_values() {
+    StateReporter reporter;
+    report_sink_t sink;
+    attachSink(reporter, sink);
+    reporter.report("/valve", false);
+    native::advanceMillis(STATE_REPORTER_WINDOW);
+    reporter.loop();
+    reporter.onSent(true);
+
+    // Flipped back within the window: the database already holds it
+    reporter.report("/valve", true);
+    reporter.report("/valve", false);
+    TEST_ASSERT_FALSE(reporter.isPending());
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, reporter.getNextDeadline());
+
+    // Last value wins
+    reporter.report("/water_leak", true);
+    reporter.report("/water_leak", false);
+    reporter.report("/water_leak", true);
+    native::advanceMillis(STATE_REPORTER_WINDOW);
+    reporter.loop();
+    TEST_ASSERT_EQUAL(2, sink.payloads.size());
+    TEST_ASSERT_EQUAL_STRING("{\"water_leak\":true}", sink.payloads[1].c_str());
+
+    // invalidate() sends again what the database used to hold
+    reporter.onSent(true);
+    reporter.invalidate();
+    reporter.report("/valve", false);
+    TEST_ASSERT_TRUE(reporter.isPending());
+}
+
+void test_state_reporter_backpressure_and_retry() {
+    StateReporter reporter;
+    report_sink_t sink;
+    attachSink(reporter, sink);
+    sink.busy = true;
+
+    reporter.report("/valve", true);
+    native::advanceMillis(STATE_REPORTER_WINDOW);
+    reporter.loop();
+    TEST_ASSERT_EQUAL(0, sink.payloads.size());
+    TEST_ASSERT_EQUAL_UINT32(STATE_REPORTER_RETRY_DELAY, reporter.getNextDeadline());
+
+    // Still coalescing while the queue is full
+    reporter.report("/water_leak", true);
+    sink.busy = false;
+    native::advanceMillis(STATE_REPORTER_RETRY_DELAY);
+    reporter.loop();
+    TEST_ASSERT_EQUAL(1, sink.payloads.size());
+    TEST_ASSERT_EQUAL_STRING("{\"valve\":true,\"water_leak\":true}", sink.payloads[0].c_str());
+
+    // Failed update: queued again, a newer value replaces the failed one
+    reporter.report("/valve", false);
+    reporter.onSent(false);
+    native::advanceMillis(STATE_REPORTER_RETRY_DELAY);
+    reporter.loop();
+    TEST_ASSERT_EQUAL(2, sink.payloads.size());
+    TEST_ASSERT_EQUAL_STRING("{\"valve\":false,\"water_leak\":true}", sink.payloads[1].c_str());
+
+    // No answer at all
+    native::advanceMillis(STATE_REPORTER_ACK_TIMEOUT);
+    reporter.loop();
+    TEST_ASSERT_FALSE(reporter.isInFlight());
+    native::advanceMillis(STATE_REPORTER_RETRY_DELAY);
+    reporter.loop();
+    TEST_ASSERT_EQUAL(3, sink.payloads.size());
+    TEST_ASSERT_EQUAL_UINT32(3, reporter.getSendCount());
+}
+
+static bool snapshotStates[3];
+
+void test_state_snapshot_pushes_coalesced_deltas() {
+    memset(snapshotStates, 0, sizeof(snapshotStates));
+    StateSnapshot snapshot;
+    snapshot.add("R1", []() { return snapshotStates[0]; });
+    snapshot.add("R2", []() { return snapshotStates[1]; });
+    snapshot.add("WATER_LEAK", []() { return snapshotStates[2]; }, "ACTIVE", "NONE");
+    std::vector<String> pushed;
+    snapshot.onPublish([&](const char *text, size_t length) {
+        TEST_ASSERT_EQUAL(strlen(text), length);
+        pushed.push_back(text);
+    });
+    TEST_ASSERT_EQUAL_STRING("S:0\nR1:OFF\nR2:OFF\nWATER_LEAK:NONE\n", snapshot.c_str());
+
+    // First delta carries every device
+    snapshot.markChanged();
+    native::advanceMillis(STATE_SNAPSHOT_PUSH_WINDOW);
+    snapshot.loop();
+    TEST_ASSERT_EQUAL(1, pushed.size());
+    TEST_ASSERT_EQUAL_STRING("D:1\nR1:OFF\nR2:OFF\nWATER_LEAK:NONE\n", pushed[0].c_str());
+
+    // Burst of relay changes: one delta with the changed devices only
+    snapshotStates[0] = true;
+    snapshot.markChanged();
+    native::advanceMillis(10);
+    snapshotStates[1] = true;
+    snapshot.markChanged();
+    snapshotStates[1] = false;
+    snapshotStates[2] = true;
+    snapshot.markChanged();
+    TEST_ASSERT_EQUAL_UINT32(STATE_SNAPSHOT_PUSH_WINDOW - 10, snapshot.getNextDeadline());
+    snapshot.loop();
+    TEST_ASSERT_EQUAL(1, pushed.size());
+    native::advanceMillis(STATE_SNAPSHOT_PUSH_WINDOW);
+    snapshot.loop();
+    TEST_ASSERT_EQUAL(2, pushed.size());
+    TEST_ASSERT_EQUAL_STRING("D:2\nR1:ON\nWATER_LEAK:ACTIVE\n", pushed[1].c_str());
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, snapshot.getNextDeadline());
+
+    // Nothing changed in the end: no message, the sequence stays
+    snapshotStates[0] = false;
+    snapshot.markChanged();
+    snapshotStates[0] = true;
+    native::advanceMillis(STATE_SNAPSHOT_PUSH_WINDOW);
+    snapshot.loop();
+    TEST_ASSERT_EQUAL(2, pushed.size());
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.getSeq());
+
+    // A client resyncing gets the full state with the last sequence number
+    TEST_ASSERT_EQUAL_STRING("S:2\nR1:ON\nR2:OFF\nWATER_LEAK:ACTIVE\n", snapshot.c_str());
+}
+
+void test_state_snapshot_sends_requested_snapshots_from_loop() {
+    memset(snapshotStates, 0, sizeof(snapshotStates));
+    StateSnapshot snapshot;
+    snapshot.add("R1", []() { return snapshotStates[0]; });
+    std::vector<std::pair<uint32_t, String>> sent;
+    snapshot.onSnapshot([&](uint32_t clientId, const char *text, size_t length) {
+        sent.emplace_back(clientId, String(text));
+    });
+    snapshot.onPublish([](const char *, size_t) {});
+
+    snapshot.requestSnapshot(3);
+    snapshot.requestSnapshot(3);
+    snapshot.requestSnapshot(5);
+    TEST_ASSERT_EQUAL(0, sent.size());
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.getNextDeadline());
+
+    // A pending delta goes out first, the snapshot carries its sequence number
+    snapshotStates[0] = true;
+    snapshot.markChanged();
+    native::advanceMillis(STATE_SNAPSHOT_PUSH_WINDOW);
+    snapshot.loop();
+    TEST_ASSERT_EQUAL(2, sent.size());
+    TEST_ASSERT_EQUAL_UINT32(3, sent[0].first);
+    TEST_ASSERT_EQUAL_UINT32(5, sent[1].first);
+    TEST_ASSERT_EQUAL_STRING("S:1\nR1:ON\n", sent[1].second.c_str());
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, snapshot.getNextDeadline());
+
+    // Too many at once: one snapshot for every client
+    sent.clear();
+    for (uint32_t id = 1; id <= STATE_SNAPSHOT_MAX_PENDING + 1; id++) {
+        snapshot.requestSnapshot(id);
+    }
+    snapshot.loop();
+    TEST_ASSERT_EQUAL(1, sent.size());
+    TEST_ASSERT_EQUAL_UINT32(STATE_SNAPSHOT_ALL_CLIENTS, sent[0].first);
+}
+
+static uint8_t timerRuns[3];
+
+void test_timer_reports_earliest_deadline() {
+    native::setMillis(0);
+    memset(timerRuns, 0, sizeof(timerRuns));
+    DeviceTimer timer;
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, timer.getNextDeadline());
+
+    timer.setTimeout(300, []() { timerRuns[0]++; });
+    int interval = timer.setInterval(250, []() { timerRuns[1]++; });
+    TEST_ASSERT_EQUAL_UINT32(250, timer.getNextDeadline());
+
+    native::advanceMillis(250);
+    timer.run();
+    TEST_ASSERT_EQUAL(0, timerRuns[0]);
+    TEST_ASSERT_EQUAL(1, timerRuns[1]);
+    TEST_ASSERT_EQUAL_UINT32(50, timer.getNextDeadline());
+
+    native::advanceMillis(50);
+    timer.run();
+    TEST_ASSERT_EQUAL(1, timerRuns[0]);
+    TEST_ASSERT_EQUAL(1, timer.getNumTimers());
+    TEST_ASSERT_EQUAL_UINT32(200, timer.getNextDeadline());
+
+    // A stalled loop runs a missed interval once, then keeps the period
+    native::advanceMillis(1000);
+    timer.run();
+    TEST_ASSERT_EQUAL(2, timerRuns[1]);
+    TEST_ASSERT_EQUAL_UINT32(250, timer.getNextDeadline());
+
+    timer.deleteTimer(interval);
+    TEST_ASSERT_EQUAL_UINT32(DEVICE_LOOP_IDLE, timer.getNextDeadline());
+}
+
+void test_timer_timeout_may_set_another() {
+    native::setMillis(0);
+    memset(timerRuns, 0, sizeof(timerRuns));
+    static DeviceTimer timer;
+    timer.setTimeout(100, []() {
+        timerRuns[0]++;
+        timer.setTimeout(100, []() { timerRuns[2]++; });
+    });
+    native::advanceMillis(100);
+    timer.run();
+    TEST_ASSERT_EQUAL(1, timerRuns[0]);
+    TEST_ASSERT_EQUAL(0, timerRuns[2]);
+    TEST_ASSERT_EQUAL_UINT32(100, timer.getNextDeadline());
+    native::advanceMillis(100);
+    timer.run();
+    TEST_ASSERT_EQUAL(1, timerRuns[2]);
+    TEST_ASSERT_EQUAL(0, timer.getNumTimers());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_output_reports_auto_off_deadline);
+    RUN_TEST(test_output_once_duration_and_power_on_delay);
+    RUN_TEST(test_output_auto_off_survives_millis_rollover);
+    RUN_TEST(test_loop_sleeps_until_output_deadline);
+    RUN_TEST(test_loop_runs_periodic_entries);
+    RUN_TEST(test_timer_reports_earliest_deadline);
+    RUN_TEST(test_timer_timeout_may_set_another);
+    RUN_TEST(test_input_interrupt_wakes_loop);
+    RUN_TEST(test_input_without_interrupt_polls_at_debounce_period);
+    RUN_TEST(test_input_ignores_glitch_shorter_than_debounce);
+    RUN_TEST(test_input_catches_pulse_shorter_than_loop_period);
+    RUN_TEST(test_input_reacts_within_debounce_time);
+    RUN_TEST(test_input_hold_state_from_edge_timestamps);
+    RUN_TEST(test_input_resyncs_after_queue_overflow);
+    RUN_TEST(test_flow_meter_counts_liters_and_rate);
+    RUN_TEST(test_flow_meter_closes_at_target_volume);
+    RUN_TEST(test_flow_meter_calibration);
+    RUN_TEST(test_last_state_store_round_trip);
+    RUN_TEST(test_last_state_store_coalesces_writes);
+    RUN_TEST(test_last_state_store_bounds_flush_delay);
+    RUN_TEST(test_last_state_store_survives_torn_flush);
+    RUN_TEST(test_last_state_store_upgrades_version_1_file);
+    RUN_TEST(test_last_state_store_migrates_legacy_text);
+    RUN_TEST(test_last_state_store_resets_invalid_file);
+    RUN_TEST(test_state_reporter_coalesces_devices);
+    RUN_TEST(test_state_reporter_drops_flapping_values);
+    RUN_TEST(test_state_reporter_backpressure_and_retry);
+    RUN_TEST(test_state_snapshot_pushes_coalesced_deltas);
+    RUN_TEST(test_state_snapshot_sends_requested_snapshots_from_loop);
+    return UNITY_END();
+}
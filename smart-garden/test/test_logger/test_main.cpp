@@ -0,0 +1,422 @@
+//
+// Logger tests: `pio test -e native -f test_logger`
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#include <SPIFFS.h>
+
+#include "Logger.h"
+
+static const uint32_t LOG_START = 1721000000; // 2024-07-14
+
+void setUp() {
+    native::reset();
+    native::setTime(LOG_START);
+    SPIFFS.format();
+}
+
+void tearDown() {}
+
+/**
+ * @brief One line per minute: "<epoch> EVENT-<i>"
+ */
+static void writeLog(const char *path, uint32_t lines) {
+    File file = SPIFFS.open(path, "w", true);
+    for (uint32_t i = 0; i < lines; i++) {
+        file.printf("%u EVENT-%u\n", (unsigned) (LOG_START + i * 60), (unsigned) i);
+    }
+    file.close();
+}
+
+/**
+ * @brief Drain a reader the way the chunked response does
+ */
+static String drain(LogReader &reader, size_t chunk) {
+    String out;
+    uint8_t buffer[64];
+    size_t n;
+    while ((n = reader.read(buffer, chunk)) > 0) {
+        out += String((const char *) buffer, n);
+    }
+    return out;
+}
+
+/**
+ * @brief One event per minute, "VALVE_OPEN-SCHEDULE-<i>" and "VALVE_CLOSE-SCHEDULE-<i>" in turn
+ * @return the text /logs returns for them
+ */
+static String logEvents(Logger &logger, uint32_t lines) {
+    String expected;
+    for (uint32_t i = 0; i < lines; i++) {
+        uint32_t time = LOG_START + i * 60;
+        const char *event = i % 2 ? "VALVE_CLOSE" : "VALVE_OPEN";
+        native::setTime(time);
+        logger.log(event, "SCHEDULE", String(i).c_str());
+        expected += String(time) + " " + event + "-SCHEDULE-" + String(i) + "\n";
+    }
+    return expected;
+}
+
+static size_t fileSize(const String &path) {
+    File file = SPIFFS.open(path, "r");
+    size_t size = file.size();
+    file.close();
+    return size;
+}
+
+void test_reader_streams_whole_log() {
+    Logger logger;
+    String expected = logEvents(logger, 100);
+
+    for (size_t chunk: {7, 64}) {
+        log_query_t query;
+        auto reader = logger.read(query);
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), drain(*reader, chunk).c_str());
+        TEST_ASSERT_EQUAL_UINT32(100, reader->getCount());
+    }
+}
+
+void test_reader_filters_time_range_and_limit() {
+    Logger logger;
+    logEvents(logger, 100);
+    log_query_t query;
+    query.from = LOG_START + 10 * 60;
+    query.to = LOG_START + 12 * 60;
+    auto reader = logger.read(query);
+    TEST_ASSERT_EQUAL_STRING("1721000600 VALVE_OPEN-SCHEDULE-10\n1721000660 VALVE_CLOSE-SCHEDULE-11\n"
+                             "1721000720 VALVE_OPEN-SCHEDULE-12\n", drain(*reader, 64).c_str());
+
+    query.to = 0xFFFFFFFF;
+    query.limit = 2;
+    auto limited = logger.read(query);
+    TEST_ASSERT_EQUAL_STRING("1721000600 VALVE_OPEN-SCHEDULE-10\n1721000660 VALVE_CLOSE-SCHEDULE-11\n",
+                             drain(*limited, 64).c_str());
+}
+
+void test_reader_tails_in_reverse() {
+    Logger logger;
+    logEvents(logger, 100);
+    log_query_t query;
+    query.reverse = true;
+    query.limit = 3;
+    auto reader = logger.read(query);
+    TEST_ASSERT_EQUAL_STRING("1721005940 VALVE_CLOSE-SCHEDULE-99\n1721005880 VALVE_OPEN-SCHEDULE-98\n"
+                             "1721005820 VALVE_CLOSE-SCHEDULE-97\n", drain(*reader, 5).c_str());
+
+    query.limit = 0;
+    query.from = LOG_START + 98 * 60;
+    auto ranged = logger.read(query);
+    TEST_ASSERT_EQUAL_STRING("1721005940 VALVE_CLOSE-SCHEDULE-99\n1721005880 VALVE_OPEN-SCHEDULE-98\n",
+                             drain(*ranged, 64).c_str());
+}
+
+void test_reader_stops_at_damaged_record() {
+    Logger logger;
+    logger.log("FIRST");
+    logger.log("SECOND");
+    String longMessage;
+    for (int i = 0; i < LOG_PAYLOAD_MAX + 10; i++) longMessage += 'x';
+    logger.log(longMessage);
+    logger.flush();
+    String path = logger.getSegmentPath(0);
+
+    // An interrupted write past the size in the header is ignored
+    File file = SPIFFS.open(path, "a");
+    file.print("garbage");
+    file.close();
+    log_query_t query;
+    auto reader = logger.read(query);
+    String last = "1721000000 " + longMessage.substring(0, LOG_PAYLOAD_MAX) + "\n";
+    String expected = "1721000000 FIRST\n1721000000 SECOND\n" + last;
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), drain(*reader, 64).c_str());
+
+    // A bad length ends the segment, in both directions
+    file = SPIFFS.open(path, "r+");
+    file.seek(sizeof(log_segment_header_t) + LOG_RECORD_SIZE(5) + LOG_RECORD_SIZE(6) - 1);
+    file.write((uint8_t) 0xEE);
+    file.close();
+    auto damaged = logger.read(query);
+    TEST_ASSERT_EQUAL_STRING("1721000000 FIRST\n", drain(*damaged, 64).c_str());
+    query.reverse = true;
+    auto backward = logger.read(query);
+    TEST_ASSERT_EQUAL_STRING(last.c_str(), drain(*backward, 64).c_str());
+}
+
+void test_records_are_smaller_than_text() {
+    Logger logger;
+    for (uint32_t i = 0; i < 200; i++) {
+        native::setTime(LOG_START + i * 60);
+        logger.log("VALVE_OPEN", "SCHEDULE", "10-0-5");
+    }
+    String text = logger.getLogs();
+    size_t binary = fileSize(logger.getSegmentPath(0)) - sizeof(log_segment_header_t);
+    TEST_ASSERT_EQUAL_UINT32(200 * LOG_RECORD_SIZE(6) + LOG_RECORD_SIZE(10) + LOG_RECORD_SIZE(8), binary);
+    TEST_ASSERT_TRUE(text.length() > 2 * binary);
+}
+
+void test_logger_reloads_dictionary() {
+    {
+        Logger logger;
+        logger.log("VALVE_OPEN", "WEB", "1");
+        logger.flush();
+    }
+    size_t size = fileSize("/logs_0.seg");
+    Logger reopened;
+    native::setTime(LOG_START + 60);
+    reopened.log("VALVE_OPEN", "WEB", "2");
+    reopened.flush();
+    // No new definitions
+    TEST_ASSERT_EQUAL_UINT32(size + LOG_RECORD_SIZE(1), fileSize("/logs_0.seg"));
+    TEST_ASSERT_EQUAL_STRING("1721000000 VALVE_OPEN-WEB-1\n1721000060 VALVE_OPEN-WEB-2\n", reopened.getLogs().c_str());
+}
+
+void test_full_dictionary_starts_new_segment() {
+    Logger logger;
+    String expected;
+    for (uint32_t i = 0; i < LOG_DICTIONARY_SIZE + 5; i++) {
+        String event = "EVENT_" + String(i);
+        logger.log(event.c_str(), "SENSOR", "");
+        expected = expected + "1721000000 " + event + "-SENSOR-\n";
+    }
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), logger.getLogs().c_str());
+    TEST_ASSERT_TRUE(SPIFFS.exists(logger.getSegmentPath(1)));
+
+    // The names of each segment are loaded before reading it from its end
+    log_query_t query;
+    query.reverse = true;
+    query.limit = LOG_DICTIONARY_SIZE;
+    auto reader = logger.read(query);
+    String out = drain(*reader, 64);
+    TEST_ASSERT_TRUE(out.indexOf("?") < 0);
+    String last = "1721000000 EVENT_" + String(LOG_DICTIONARY_SIZE + 4) + "-SENSOR-\n";
+    TEST_ASSERT_TRUE(out.startsWith(last));
+}
+
+void test_reader_raw_returns_segments() {
+    Logger logger;
+    logEvents(logger, 10);
+    log_query_t query;
+    query.raw = true;
+    query.reverse = true; // ignored
+    auto reader = logger.read(query);
+    std::vector<uint8_t> out;
+    uint8_t buffer[64];
+    size_t n;
+    while ((n = reader->read(buffer, 7)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+
+    File file = SPIFFS.open(logger.getSegmentPath(0), "r");
+    std::vector<uint8_t> stored(file.size());
+    file.read(stored.data(), stored.size());
+    file.close();
+    TEST_ASSERT_EQUAL_UINT32(stored.size(), out.size());
+    TEST_ASSERT_TRUE(memcmp(stored.data(), out.data(), out.size()) == 0);
+}
+
+void test_logger_read_uses_its_file() {
+    Logger logger;
+    logger.clearAllLogs();
+    logger.log("VALVE_OPEN-WEB-");
+    logger.log("VALVE_CLOSE-WEB-");
+    log_query_t query;
+    query.reverse = true;
+    query.limit = 1;
+    auto reader = logger.read(query);
+    TEST_ASSERT_EQUAL_STRING("1721000000 VALVE_CLOSE-WEB-\n", drain(*reader, 64).c_str());
+}
+
+/**
+ * @brief Log `lines` messages one minute apart, starting at `start`
+ */
+static void logMinutes(Logger &logger, uint32_t start, uint32_t lines) {
+    for (uint32_t i = 0; i < lines; i++) {
+        native::setTime(start + i * 60);
+        logger.log("EVENT-" + String(i));
+    }
+}
+
+static uint8_t countSegments(Logger &logger) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < LOG_SEGMENT_COUNT; i++) {
+        if (SPIFFS.exists(logger.getSegmentPath(i))) count++;
+    }
+    return count;
+}
+
+void test_logger_batches_writes() {
+    // Manual clock, so the flush delay can't elapse while the test runs
+    native::setMillis(0);
+    Logger logger;
+    logger.clearAllLogs();
+    logMinutes(logger, LOG_START, 10);
+    TEST_ASSERT_EQUAL_UINT32(0, logger.getWriteCount());
+
+    logger.loop();
+    TEST_ASSERT_EQUAL_UINT32(0, logger.getWriteCount());
+    native::advanceMillis(LOG_FLUSH_DELAY);
+    logger.loop();
+    TEST_ASSERT_EQUAL_UINT32(1, logger.getWriteCount());
+
+    // Survives a restart
+    Logger reopened;
+    log_query_t query;
+    auto reader = reopened.read(query);
+    drain(*reader, 64);
+    TEST_ASSERT_EQUAL_UINT32(10, reader->getCount());
+}
+
+void test_logger_rotation_drops_oldest_segment() {
+    Logger logger;
+    logger.clearAllLogs();
+    // ~20 bytes per line: about twice the ring
+    uint32_t lines = 2 * LOG_SEGMENT_COUNT * LOG_SEGMENT_SIZE / 20;
+    logMinutes(logger, LOG_START, lines);
+    TEST_ASSERT_EQUAL_UINT8(LOG_SEGMENT_COUNT, countSegments(logger));
+
+    size_t stored = 0;
+    for (uint8_t i = 0; i < LOG_SEGMENT_COUNT; i++) {
+        stored += fileSize(logger.getSegmentPath(i));
+    }
+    TEST_ASSERT_TRUE(stored <= LOG_SEGMENT_COUNT * LOG_SEGMENT_SIZE);
+
+    String logs = logger.getLogs();
+    TEST_ASSERT_TRUE(logs.indexOf(" EVENT-0\n") < 0);
+    String last = String(LOG_START + (lines - 1) * 60) + " EVENT-" + String(lines - 1) + "\n";
+    TEST_ASSERT_TRUE(logs.endsWith(last));
+
+    // Contiguous: the oldest kept line is the one after the dropped segment
+    uint32_t first = logs.substring(logs.indexOf("EVENT-") + 6, logs.indexOf('\n')).toInt();
+    log_query_t query;
+    auto reader = logger.read(query);
+    drain(*reader, 64);
+    TEST_ASSERT_EQUAL_UINT32(lines - first, reader->getCount());
+}
+
+void test_logger_query_skips_segments_by_header() {
+    Logger logger;
+    logger.clearAllLogs();
+    uint32_t lines = LOG_SEGMENT_SIZE / 20 * 3;
+    logMinutes(logger, LOG_START, lines);
+    logger.flush();
+
+    // Rewrite a record of the first segment without its header: a query past its range must not read it
+    uint8_t record[LOG_RECORD_SIZE_MAX];
+    size_t size = logRecordEncode(record, LOG_START + (lines - 1) * 60, LOG_RECORD_NONE, LOG_RECORD_NONE, "STALE", 5);
+    File file = SPIFFS.open(logger.getSegmentPath(0), "r+"); // first after clearAllLogs()
+    file.seek(sizeof(log_segment_header_t));
+    file.write(record, size);
+    file.close();
+
+    log_query_t query;
+    query.from = LOG_START + (lines - 2) * 60;
+    auto reader = logger.read(query);
+    String out = drain(*reader, 64);
+    TEST_ASSERT_TRUE(out.indexOf("STALE") < 0);
+    TEST_ASSERT_EQUAL_UINT32(2, reader->getCount());
+}
+
+void test_logger_clears_old_segments() {
+    Logger logger;
+    logger.clearAllLogs();
+    logger.setMaxLogTime(1);
+    uint32_t lines = LOG_SEGMENT_SIZE / 20 * 3;
+    logMinutes(logger, LOG_START, lines);
+    uint8_t segments = countSegments(logger);
+    TEST_ASSERT_TRUE(segments >= 3);
+
+    native::setTime(LOG_START + (lines - 1) * 60 + 12 * 3600);
+    logger.clearOldLogs();
+    uint8_t kept = countSegments(logger);
+    TEST_ASSERT_TRUE(kept < segments);
+    TEST_ASSERT_TRUE(kept >= 1);
+
+    native::setTime(LOG_START + (lines - 1) * 60 + 2 * 24 * 3600);
+    logger.clearOldLogs();
+    TEST_ASSERT_EQUAL_UINT8(1, countSegments(logger)); // the active one
+}
+
+void test_logger_imports_old_log_file() {
+    writeLog("/logs.txt", 50);
+    File file = SPIFFS.open("/logs.txt", "r");
+    String expected = file.readString();
+    file.close();
+
+    Logger logger;
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), logger.getLogs().c_str());
+    TEST_ASSERT_FALSE(SPIFFS.exists("/logs.txt"));
+}
+
+static const time_t TIME_NOT_SET = 1000;
+
+void test_queue_is_bounded_and_backdated() {
+    Logger logger;
+    native::setTime(TIME_NOT_SET);
+    native::setMillis(0);
+    for (uint32_t i = 0; i < LOG_QUEUE_SIZE + 3; i++) {
+        logger.log("BOOT", "SYSTEM", String(i).c_str());
+        native::advanceMillis(1000);
+    }
+    TEST_ASSERT_EQUAL_UINT8(LOG_QUEUE_SIZE, logger.getQueueCount());
+    TEST_ASSERT_EQUAL_UINT32(3, logger.getDroppedCount());
+
+    // Still waiting for the time
+    logger.loop();
+    TEST_ASSERT_EQUAL_UINT8(LOG_QUEUE_SIZE, logger.getQueueCount());
+
+    native::setTime(LOG_START);
+    logger.loop();
+    TEST_ASSERT_EQUAL_UINT8(0, logger.getQueueCount());
+
+    // The oldest ones were overwritten; the newest was logged 1 s before the clock was set
+    String expected;
+    for (uint32_t i = 3; i < LOG_QUEUE_SIZE + 3; i++) {
+        expected += String(LOG_START - (LOG_QUEUE_SIZE + 3 - i)) + " BOOT-SYSTEM-" + String(i) + "\n";
+    }
+    expected += String(LOG_START) + " LOG_DROPPED-QUEUE-3\n";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), logger.getLogs().c_str());
+}
+
+void test_queue_drop_newest_keeps_first_entries() {
+    Logger logger;
+    logger.setQueuePolicy(LOG_QUEUE_DROP_NEWEST);
+    native::setTime(TIME_NOT_SET);
+    String longMessage;
+    for (int i = 0; i < LOG_QUEUE_MESSAGE_MAX + 10; i++) longMessage += 'x';
+    logger.log(longMessage);
+    for (uint32_t i = 1; i < LOG_QUEUE_SIZE + 5; i++) {
+        logger.log("BOOT", "SYSTEM", String(i).c_str());
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, logger.getDroppedCount());
+
+    native::setTime(LOG_START);
+    logger.loop();
+    String logs = logger.getLogs();
+    String first = String(LOG_START) + " " + longMessage.substring(0, LOG_QUEUE_MESSAGE_MAX) + "\n";
+    TEST_ASSERT_TRUE(logs.startsWith(first));
+    String last = String(LOG_START) + " BOOT-SYSTEM-" + String(LOG_QUEUE_SIZE - 1) + "\n" + String(LOG_START) +
+                  " LOG_DROPPED-QUEUE-5\n";
+    TEST_ASSERT_TRUE(logs.endsWith(last));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reader_streams_whole_log);
+    RUN_TEST(test_reader_filters_time_range_and_limit);
+    RUN_TEST(test_reader_tails_in_reverse);
+    RUN_TEST(test_reader_stops_at_damaged_record);
+    RUN_TEST(test_records_are_smaller_than_text);
+    RUN_TEST(test_logger_reloads_dictionary);
+    RUN_TEST(test_full_dictionary_starts_new_segment);
+    RUN_TEST(test_reader_raw_returns_segments);
+    RUN_TEST(test_logger_read_uses_its_file);
+    RUN_TEST(test_logger_batches_writes);
+    RUN_TEST(test_logger_rotation_drops_oldest_segment);
+    RUN_TEST(test_logger_query_skips_segments_by_header);
+    RUN_TEST(test_logger_clears_old_segments);
+    RUN_TEST(test_logger_imports_old_log_file);
+    RUN_TEST(test_queue_is_bounded_and_backdated);
+    RUN_TEST(test_queue_drop_newest_keeps_first_entries);
+    return UNITY_END();
+}
@@ -0,0 +1,471 @@
+//
+// Scheduler unit tests: `pio test -e native -f test_scheduler`
+//
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "WateringSchedule.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static const time_t SUNDAY = 1720915200; // 2024-07-14 00:00:00 UTC
+
+static std::vector<uint8_t> fired;
+
+static time_t at(uint8_t dow, uint8_t hour, uint8_t minute, uint8_t second = 0) {
+    return SUNDAY + dow * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+static schedule_task_t<WateringTaskArgs> makeTask(uint8_t id, uint8_t hour, uint8_t minute) {
+    schedule_task_t<WateringTaskArgs> task{};
+    task.id = id;
+    task.time = {hour, minute};
+    task.repeat = {schedule_repeat_t::EVERYDAY};
+    task.args = ScheduleArgsPool<WateringTaskArgs>::create();
+    task.enabled = true;
+    return task;
+}
+
+static void runAt(Scheduler<WateringTaskArgs> &scheduler, time_t t) {
+    native::setTime(t);
+    scheduler.run();
+}
+
+void setUp() {
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    native::reset();
+    SPIFFS.format();
+    fired.clear();
+}
+
+void tearDown() {}
+
+void test_fires_once_per_minute() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    scheduler.addTask(makeTask(1, 6, 30));
+
+    runAt(scheduler, at(1, 6, 29, 57));
+    TEST_ASSERT_EQUAL(0, fired.size());
+    runAt(scheduler, at(1, 6, 30, 0));
+    runAt(scheduler, at(1, 6, 30, 3));
+    runAt(scheduler, at(1, 6, 30, 59));
+    TEST_ASSERT_EQUAL(1, fired.size());
+    TEST_ASSERT_EQUAL(1, fired[0]);
+
+    // Next day, same time
+    runAt(scheduler, at(1, 6, 31, 0));
+    runAt(scheduler, at(2, 6, 30, 1));
+    TEST_ASSERT_EQUAL(2, fired.size());
+}
+
+void test_respects_repeat_days_and_enabled() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    auto mondayOnly = makeTask(1, 7, 0);
+    mondayOnly.repeat = {schedule_repeat_t::MONDAY};
+    scheduler.addTask(std::move(mondayOnly));
+    auto disabled = makeTask(2, 7, 0);
+    disabled.enabled = false;
+    scheduler.addTask(std::move(disabled));
+
+    runAt(scheduler, at(0, 7, 0)); // Sunday
+    TEST_ASSERT_EQUAL(0, fired.size());
+    runAt(scheduler, at(1, 7, 0)); // Monday
+    TEST_ASSERT_EQUAL(1, fired.size());
+    TEST_ASSERT_EQUAL(1, fired[0]);
+    runAt(scheduler, at(2, 7, 0)); // Tuesday
+    TEST_ASSERT_EQUAL(1, fired.size());
+}
+
+void test_update_rebuilds_index() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    scheduler.addTask(makeTask(1, 8, 0));
+    runAt(scheduler, at(3, 7, 0)); // index built, next check at 08:00
+
+    scheduler.updateTask(1, makeTask(1, 7, 30));
+    runAt(scheduler, at(3, 7, 30));
+    TEST_ASSERT_EQUAL(1, fired.size());
+
+    scheduler.removeTask(1);
+    runAt(scheduler, at(4, 7, 30));
+    TEST_ASSERT_EQUAL(1, fired.size());
+}
+
+void test_update_keeps_last_run() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    scheduler.addTask(makeTask(1, 7, 0));
+    runAt(scheduler, at(3, 7, 0));
+    TEST_ASSERT_EQUAL(1, fired.size());
+
+    // Edited right after it ran, still inside the grace window
+    scheduler.updateTask(1, makeTask(1, 7, 0));
+    runAt(scheduler, at(3, 7, 1));
+    TEST_ASSERT_EQUAL(1, fired.size());
+    runAt(scheduler, at(4, 7, 0));
+    TEST_ASSERT_EQUAL(2, fired.size());
+}
+
+void test_journal_replays_id_change() {
+    {
+        Scheduler<WateringTaskArgs> scheduler;
+        scheduler.addTask(makeTask(1, 6, 0));
+        scheduler.updateTask(1, makeTask(4, 6, 15));
+    }
+    Scheduler<WateringTaskArgs> scheduler;
+    TEST_ASSERT_EQUAL_STRING("4|6|15|1111111|10-0-1|1|0\n", scheduler.getString().c_str());
+}
+
+static Scheduler<WateringTaskArgs> *reentrant = nullptr;
+
+void test_callback_may_change_the_schedule() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) {
+        fired.push_back(task.id);
+        // Moves the task vector while `task` is in use
+        for (uint8_t id = 10; id < 20; id++) {
+            reentrant->addTask(makeTask(id, 9, 0));
+        }
+        reentrant->removeTask(task.id);
+        TEST_ASSERT_EQUAL(1, task.id);
+        TEST_ASSERT_EQUAL(10, task.args->valveOpenLevel);
+    });
+    reentrant = &scheduler;
+    scheduler.addTask(makeTask(1, 7, 0));
+    runAt(scheduler, at(3, 7, 0));
+    reentrant = nullptr;
+    TEST_ASSERT_EQUAL(1, fired.size());
+    TEST_ASSERT_NULL(scheduler.getTaskById(1));
+    TEST_ASSERT_EQUAL(10, scheduler.getTaskCount());
+}
+
+void test_wraps_around_week() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    auto sundayMorning = makeTask(1, 5, 0);
+    sundayMorning.repeat = {schedule_repeat_t::SUNDAY};
+    scheduler.addTask(std::move(sundayMorning));
+
+    runAt(scheduler, at(6, 23, 0)); // Saturday night
+    for (uint8_t hour = 0; hour <= 5; hour++) {
+        runAt(scheduler, at(7, hour, 0)); // following Sunday
+    }
+    TEST_ASSERT_EQUAL(1, fired.size());
+}
+
+void test_repeat_text_format() {
+    auto repeat = schedule_repeat_t::fromString("1000001", 7); // Monday first
+    TEST_ASSERT_EQUAL(schedule_repeat_t::MONDAY | schedule_repeat_t::SUNDAY, repeat.mask);
+    TEST_ASSERT_TRUE(repeat.on(0));
+    TEST_ASSERT_FALSE(repeat.on(6));
+    TEST_ASSERT_EQUAL_STRING("1000001", repeat.toString().c_str());
+}
+
+void test_binary_file_round_trip() {
+    TEST_ASSERT_EQUAL(1, sizeof(schedule_repeat_t));
+    TEST_ASSERT_EQUAL(11 + SCHEDULE_RECORD_ARGS_SIZE, sizeof(schedule_record_t));
+    {
+        Scheduler<WateringTaskArgs> scheduler;
+        auto task = makeTask(42, 18, 5);
+        task.repeat = {schedule_repeat_t::SATURDAY};
+        task.args->duration = 7;
+        task.args->valveOpenLevel = 4;
+        scheduler.addTask(std::move(task));
+        scheduler.addTask(makeTask(43, 6, 0));
+        TEST_ASSERT_TRUE(scheduler.save());
+    }
+    TEST_ASSERT_TRUE(SPIFFS.exists("/schedules.bin"));
+
+    Scheduler<WateringTaskArgs> scheduler;
+    TEST_ASSERT_EQUAL(2, scheduler.getTaskCount());
+    TEST_ASSERT_EQUAL_STRING("42|18|5|0000010|4-0-7|1|0\n43|6|0|1111111|10-0-1|1|0\n", scheduler.getString().c_str());
+}
+
+void test_migrates_legacy_text_file() {
+    File legacy = SPIFFS.open("/schedules.txt", FILE_WRITE, true);
+    legacy.print("12|6|30|1010100|10-0-5|1|0\n");
+    legacy.print("garbage\n");
+    legacy.print("13|19|45|0000011|5-0-2|0|0\n");
+    legacy.close();
+
+    Scheduler<WateringTaskArgs> scheduler;
+    TEST_ASSERT_EQUAL(2, scheduler.getTaskCount());
+    TEST_ASSERT_FALSE(SPIFFS.exists("/schedules.txt"));
+    TEST_ASSERT_TRUE(SPIFFS.exists("/schedules.bin"));
+    TEST_ASSERT_EQUAL_STRING("12|6|30|1010100|10-0-5|1|0\n13|19|45|0000011|5-0-2|0|0\n", scheduler.getString().c_str());
+
+    Scheduler<WateringTaskArgs> reloaded;
+    TEST_ASSERT_EQUAL_STRING(scheduler.getString().c_str(), reloaded.getString().c_str());
+}
+
+void test_journal_replays_mutations() {
+    {
+        Scheduler<WateringTaskArgs> scheduler;
+        scheduler.addTask(makeTask(1, 6, 0));
+        scheduler.addTask(makeTask(2, 7, 0));
+        scheduler.addTask(makeTask(3, 8, 0));
+        scheduler.updateTask(2, makeTask(2, 7, 45));
+        scheduler.removeTask(1);
+    }
+    TEST_ASSERT_FALSE(SPIFFS.exists("/schedules.bin"));
+    TEST_ASSERT_EQUAL(5 * sizeof(schedule_journal_entry_t), SPIFFS.open("/schedules.jnl").size());
+
+    Scheduler<WateringTaskArgs> scheduler;
+    TEST_ASSERT_EQUAL_STRING("2|7|45|1111111|10-0-1|1|0\n3|8|0|1111111|10-0-1|1|0\n", scheduler.getString().c_str());
+
+    // Compaction folds the journal into the schedule file
+    TEST_ASSERT_TRUE(scheduler.save());
+    TEST_ASSERT_FALSE(SPIFFS.exists("/schedules.jnl"));
+    Scheduler<WateringTaskArgs> reloaded;
+    TEST_ASSERT_EQUAL_STRING(scheduler.getString().c_str(), reloaded.getString().c_str());
+}
+
+void test_journal_compacts_when_full() {
+    Scheduler<WateringTaskArgs> scheduler;
+    scheduler.addTask(makeTask(1, 6, 0));
+    for (uint8_t i = 0; i < SCHEDULER_JOURNAL_MAX_ENTRIES; i++) {
+        scheduler.updateTask(1, makeTask(1, 6, i));
+    }
+    TEST_ASSERT_FALSE(SPIFFS.exists("/schedules.jnl"));
+    TEST_ASSERT_EQUAL(sizeof(schedule_file_header_t) + sizeof(schedule_record_t), SPIFFS.open("/schedules.bin").size());
+
+    scheduler.updateTask(1, makeTask(1, 9, 15));
+    Scheduler<WateringTaskArgs> reloaded;
+    TEST_ASSERT_EQUAL_STRING("1|9|15|1111111|10-0-1|1|0\n", reloaded.getString().c_str());
+}
+
+void test_journal_ignores_torn_entry() {
+    {
+        Scheduler<WateringTaskArgs> scheduler;
+        scheduler.addTask(makeTask(1, 6, 0));
+        scheduler.addTask(makeTask(2, 7, 0));
+    }
+    // Simulate power loss in the middle of the second append
+    File journal = SPIFFS.open("/schedules.jnl", "r");
+    std::vector<uint8_t> data(journal.size());
+    journal.read(data.data(), data.size());
+    journal.close();
+    journal = SPIFFS.open("/schedules.jnl", "w");
+    journal.write(data.data(), sizeof(schedule_journal_entry_t) + 5);
+    journal.close();
+
+    Scheduler<WateringTaskArgs> scheduler;
+    TEST_ASSERT_EQUAL_STRING("1|6|0|1111111|10-0-1|1|0\n", scheduler.getString().c_str());
+}
+
+void test_executed_is_not_persisted() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    scheduler.addTask(makeTask(1, 6, 30));
+    scheduler.save();
+    size_t fileSize = SPIFFS.open("/schedules.bin").size();
+
+    runAt(scheduler, at(1, 6, 30, 0));
+    runAt(scheduler, at(1, 6, 31, 0));
+    TEST_ASSERT_EQUAL(1, fired.size());
+    TEST_ASSERT_FALSE(SPIFFS.exists("/schedules.jnl"));
+    TEST_ASSERT_EQUAL(fileSize, SPIFFS.open("/schedules.bin").size());
+
+    // A reload in the same minute must not fire the task again
+    runAt(scheduler, at(2, 6, 30, 0));
+    scheduler.load();
+    runAt(scheduler, at(2, 6, 30, 30));
+    TEST_ASSERT_EQUAL(2, fired.size());
+}
+
+void test_parses_database_payload() {
+    std::vector<schedule_task_t<WateringTaskArgs>> tasks;
+    const char *keyed = R"({"t12":"12|6|30|1010100|10-0-5|1|1","t7":"bad|task","t13":"13|19|45|0000011|5-2-2|0|0"})";
+    TEST_ASSERT_EQUAL(2, Scheduler<WateringTaskArgs>::parseTasks(keyed, tasks, 8));
+    TEST_ASSERT_EQUAL_STRING("12|6|30|1010100|10-0-5|1|0", Scheduler<WateringTaskArgs>::taskToString(tasks[0]).c_str());
+    TEST_ASSERT_EQUAL_STRING("13|19|45|0000011|5-2-2|0|0", Scheduler<WateringTaskArgs>::taskToString(tasks[1]).c_str());
+
+    const char *legacy = R"(["1|0|0|1111111|10-0-1|1|0","2|0|0|1111111|10-0-1|1|0","3|0|0|1111111|10-0-1|1|0"])";
+    TEST_ASSERT_EQUAL(1, Scheduler<WateringTaskArgs>::parseTasks(legacy, tasks, 3)); // capped
+    TEST_ASSERT_EQUAL(3, tasks.size());
+}
+
+void test_fires_at_second_resolution() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    auto task = makeTask(1, 6, 30);
+    task.time.second = 45;
+    scheduler.addTask(std::move(task));
+
+    runAt(scheduler, at(1, 6, 30, 44));
+    TEST_ASSERT_EQUAL(0, fired.size());
+    TEST_ASSERT_EQUAL(at(1, 6, 30, 45), scheduler.nextDueTime());
+    runAt(scheduler, at(1, 6, 30, 45));
+    TEST_ASSERT_EQUAL(1, fired.size());
+    // Next run is tomorrow, the wake-up is capped to the hourly re-check
+    TEST_ASSERT_TRUE(scheduler.nextDueTime() > at(1, 6, 30, 45));
+    TEST_ASSERT_TRUE(scheduler.nextDueTime() <= at(1, 7, 30, 45));
+}
+
+void test_interval_trigger_within_window() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    auto task = makeTask(1, 6, 0);
+    task.repeat = {schedule_repeat_t::MONDAY};
+    task.interval = 20 * 60;
+    task.until = {7, 0, 0};
+    scheduler.addTask(std::move(task));
+
+    for (time_t t = at(1, 5, 0); t <= at(1, 8, 0); t += 30) {
+        runAt(scheduler, t);
+    }
+    TEST_ASSERT_EQUAL(4, fired.size()); // 06:00, 06:20, 06:40, 07:00
+    // Window is over, next run is the following Monday
+    TEST_ASSERT_EQUAL(at(8, 6, 0), Scheduler<WateringTaskArgs>::nextRunTime(*scheduler.getTaskById(1), at(1, 7, 0, 1)));
+}
+
+void test_catches_up_within_grace_window() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    scheduler.graceSeconds = 90;
+    scheduler.addTask(makeTask(1, 6, 30));
+    scheduler.addTask(makeTask(2, 7, 30));
+
+    runAt(scheduler, at(1, 6, 0));
+    runAt(scheduler, at(1, 6, 31, 20)); // loop stalled 80 s past the run
+    TEST_ASSERT_EQUAL(1, fired.size());
+    runAt(scheduler, at(1, 7, 32, 0));  // stalled past the grace window, skipped
+    TEST_ASSERT_EQUAL(1, fired.size());
+    runAt(scheduler, at(2, 7, 30, 0));  // next day runs normally
+    TEST_ASSERT_EQUAL(2, fired.size());
+}
+
+void test_skips_runs_due_before_boot() {
+    // Restarted 20 s after a run it may already have done
+    native::setMillis(20000);
+    {
+        Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+        scheduler.addTask(makeTask(1, 6, 30));
+        runAt(scheduler, at(1, 6, 30, 40));
+        TEST_ASSERT_EQUAL(0, fired.size());
+    }
+
+    // Due while waiting for the clock after boot: still caught up
+    native::setMillis(60000);
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    runAt(scheduler, at(1, 6, 30, 40));
+    TEST_ASSERT_EQUAL(1, fired.size());
+}
+
+void test_coalesces_interval_runs_missed_while_stalled() {
+    Scheduler<WateringTaskArgs> scheduler([](const schedule_task_t<WateringTaskArgs> &task) { fired.push_back(task.id); });
+    scheduler.graceSeconds = 300;
+    auto task = makeTask(1, 6, 0);
+    task.interval = 60;
+    task.until = {6, 10, 0};
+    scheduler.addTask(std::move(task));
+
+    runAt(scheduler, at(1, 5, 59));
+    runAt(scheduler, at(1, 6, 4, 30)); // 06:00 - 06:04 all due
+    TEST_ASSERT_EQUAL(1, fired.size());
+    runAt(scheduler, at(1, 6, 5, 0));
+    TEST_ASSERT_EQUAL(2, fired.size());
+}
+
+void test_extended_text_format() {
+    auto task = Scheduler<WateringTaskArgs>::parseTask("9|6|0|1111100|10-0-2|1|0|30|1200|18|0");
+    TEST_ASSERT_EQUAL_UINT8(9, task.id);
+    TEST_ASSERT_EQUAL_UINT8(30, task.time.second);
+    TEST_ASSERT_EQUAL_UINT16(1200, task.interval);
+    TEST_ASSERT_EQUAL_UINT8(18, task.until.hour);
+    TEST_ASSERT_EQUAL_STRING("9|6|0|1111100|10-0-2|1|0|30|1200|18|0", Scheduler<WateringTaskArgs>::taskToString(task).c_str());
+    TEST_ASSERT_EQUAL_STRING("06:00:30", task.time.toString().c_str());
+    TEST_ASSERT_EQUAL_UINT8(0, Scheduler<WateringTaskArgs>::parseTask("9|6|0|1111100|10-0-2|1|0|30|1200").id);
+}
+
+void test_rejects_invalid_interval() {
+    // until before time
+    auto task = Scheduler<WateringTaskArgs>::parseTask("1|6|30|1111111|10-0-1|1|0|0|600|6|0");
+    TEST_ASSERT_EQUAL(0, task.id);
+    // more than the uint16_t seconds field holds
+    task = Scheduler<WateringTaskArgs>::parseTask("1|6|30|1111111|10-0-1|1|0|0|65536|8|0");
+    TEST_ASSERT_EQUAL(0, task.id);
+    task = Scheduler<WateringTaskArgs>::parseTask("1|6|30|1111111|10-0-1|1|0|0|65535|23|0");
+    TEST_ASSERT_EQUAL(1, task.id);
+    TEST_ASSERT_EQUAL_UINT16(65535, task.interval);
+    // a single run at `time` needs no window
+    task = Scheduler<WateringTaskArgs>::parseTask("1|6|30|1111111|10-0-1|1|0|0|0|0|0");
+    TEST_ASSERT_EQUAL(1, task.id);
+}
+
+void test_upgrades_version_1_file() {
+    schedule_file_header_t header{{'S', 'G', 'S'}, 1, sizeof(schedule_record_v1_t), 1};
+    schedule_record_v1_t record{5, 6, 30, schedule_repeat_t::EVERYDAY, 0x03, 3, {10, 0, 5}};
+    File file = SPIFFS.open("/schedules.bin", "w");
+    file.write((uint8_t *) &header, sizeof(header));
+    file.write((uint8_t *) &record, sizeof(record));
+    file.close();
+
+    Scheduler<WateringTaskArgs> scheduler;
+    TEST_ASSERT_EQUAL_STRING("5|6|30|1111111|10-0-5|1|0\n", scheduler.getString().c_str());
+    file = SPIFFS.open("/schedules.bin", "r");
+    file.read((uint8_t *) &header, sizeof(header));
+    file.close();
+    TEST_ASSERT_EQUAL(SCHEDULE_FILE_VERSION, header.version);
+}
+
+void test_reload_soak_keeps_memory_flat() {
+    const uint16_t poolFree = ScheduleArgsPool<WateringTaskArgs>::available();
+    String payload = "{";
+    for (int id = 1; id <= 32; id++) {
+        if (id > 1) payload += ",";
+        payload += "\"t" + String(id) + "\":\"" + String(id) + "|6|" + String(id) + "|1010101|10-0-5|1|0\"";
+    }
+    payload += "}";
+
+    Scheduler<WateringTaskArgs> scheduler;
+    for (uint8_t id = 1; id <= 32; id++) {
+        scheduler.addTask(makeTask(id, 6, id));
+    }
+    std::vector<schedule_task_t<WateringTaskArgs>> parsed;
+    parsed.reserve(32);
+    size_t heapAfterWarmUp = 0;
+    for (int cycle = 0; cycle < 2000; cycle++) {
+        parsed.clear();
+        Scheduler<WateringTaskArgs>::parseTasks(payload.c_str(), parsed, 32);
+        scheduler.load();
+        TEST_ASSERT_EQUAL(32, scheduler.getTaskCount());
+#ifdef __GLIBC__
+        if (cycle == 10)
+            heapAfterWarmUp = mallinfo2().uordblks;
+#endif
+    }
+    TEST_ASSERT_EQUAL(32, parsed.size());
+    TEST_ASSERT_EQUAL(poolFree - 64, ScheduleArgsPool<WateringTaskArgs>::available());
+#ifdef __GLIBC__
+    TEST_ASSERT_EQUAL(heapAfterWarmUp, mallinfo2().uordblks);
+#endif
+    parsed.clear();
+    TEST_ASSERT_EQUAL(poolFree - 32, ScheduleArgsPool<WateringTaskArgs>::available());
+    (void) heapAfterWarmUp;
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_once_per_minute);
+    RUN_TEST(test_respects_repeat_days_and_enabled);
+    RUN_TEST(test_update_rebuilds_index);
+    RUN_TEST(test_update_keeps_last_run);
+    RUN_TEST(test_callback_may_change_the_schedule);
+    RUN_TEST(test_wraps_around_week);
+    RUN_TEST(test_repeat_text_format);
+    RUN_TEST(test_binary_file_round_trip);
+    RUN_TEST(test_migrates_legacy_text_file);
+    RUN_TEST(test_journal_replays_mutations);
+    RUN_TEST(test_journal_replays_id_change);
+    RUN_TEST(test_journal_compacts_when_full);
+    RUN_TEST(test_journal_ignores_torn_entry);
+    RUN_TEST(test_executed_is_not_persisted);
+    RUN_TEST(test_parses_database_payload);
+    RUN_TEST(test_fires_at_second_resolution);
+    RUN_TEST(test_interval_trigger_within_window);
+    RUN_TEST(test_catches_up_within_grace_window);
+    RUN_TEST(test_skips_runs_due_before_boot);
+    RUN_TEST(test_coalesces_interval_runs_missed_while_stalled);
+    RUN_TEST(test_extended_text_format);
+    RUN_TEST(test_rejects_invalid_interval);
+    RUN_TEST(test_upgrades_version_1_file);
+    RUN_TEST(test_reload_soak_keeps_memory_flat);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+//
+// ADC trace for the VoltageReader tests: 150 bursts of 16 raw samples, 12 V battery behind a 10k/2k divider.
+// Synthetic, modelled on the ESP32 ADC: gaussian noise (sigma 25 counts) plus 3 % spikes of 250 - 600 counts.
+//  0 -  49  12.6 V
+// 50 -  69  sag to 10.2 V (pump start on a weak battery)
+// 70 -  99  10.55 V, just above minVolt and inside the hysteresis band
+// 100 - 149 back to 12.6 V
+//
+
+#ifndef SMART_GARDEN_ADC_TRACE_H
+#define SMART_GARDEN_ADC_TRACE_H
+
+#include <stdint.h>
+
+static const uint16_t ADC_TRACE_BURST = 16;
+
+static const uint16_t ADC_TRACE[] = {
+        2562, 2631, 2558, 2622, 2570, 2613, 2609, 2588, 2585, 2584, 2622, 2640, 2598, 2910, 2587, 2597,
+        2592, 2664, 3033, 2614, 2560, 2617, 2575, 2597, 2551, 2647, 2623, 2616, 2257, 2578, 2586, 2627,
+        2634, 2613, 2619, 2571, 2986, 2579, 3077, 2639, 2606, 2600, 2660, 2611, 2598, 2620, 2621, 2612,
+        2586, 2594, 2625, 2663, 2620, 2625, 2565, 2617, 2609, 2601, 2602, 2617, 2598, 2604, 2593, 2587,
+        2597, 2604, 2587, 2619, 2606, 2616, 2587, 2572, 2633, 2591, 2620, 2626, 2597, 2587, 2545, 2637,
+        2578, 2631, 2572, 2610, 2598, 2610, 2318, 2607, 2580, 2588, 2624, 2608, 2616, 2624, 2579, 2620,
+        2615, 2602, 2611, 2587, 2656, 2574, 2584, 2576, 2574, 2598, 2639, 2633, 2591, 2604, 2567, 2582,
+        2600, 2594, 2588, 2630, 2609, 2647, 2604, 2590, 2571, 2569, 2610, 2584, 2579, 2592, 2629, 2599,
+        2634, 2618, 2615, 2640, 2609, 2601, 2637, 2608, 2622, 2614, 2595, 2611, 2583, 2583, 2612, 2602,
+        2637, 2635, 2613, 2602, 2610, 2615, 2608, 2585, 2602, 2600, 2642, 2564, 2601, 2607, 2606, 2605,
+        2590, 2601, 2570, 2653, 2606, 2664, 2639, 2564, 2625, 2619, 2611, 2623, 2600, 2596, 2580, 2594,
+        2599, 2620, 2606, 2596, 2644, 2560, 2616, 2611, 2603, 2577, 3077, 2626, 2595, 2573, 2600, 2594,
+        2621, 2597, 2585, 2564, 2612, 2953, 2610, 2613, 2588, 2601, 2624, 2616, 2597, 2618, 2580, 2597,
+        2593, 2605, 2633, 2588, 2556, 2667, 2604, 2587, 2563, 2592, 2569, 2612, 2583, 2611, 2601, 2639,
+        2628, 2586, 2640, 2599, 2597, 2611, 2605, 2626, 2593, 2606, 2645, 2648, 2605, 2629, 2611, 2595,
+        2632, 2650, 2592, 2614, 2592, 2594, 2291, 2600, 2638, 2588, 2579, 2641, 2592, 2605, 2601, 2628,
+        2602, 2646, 2619, 2605, 2636, 2584, 2595, 2592, 2619, 2601, 2641, 2602, 2567, 2612, 2586, 2610,
+        2566, 2581, 2589, 2631, 2608, 2648, 2574, 2587, 2597, 2610, 2629, 2597, 2564, 2297, 2580, 2662,
+        2588, 2594, 2609, 2601, 2557, 2543, 2951, 2595, 2635, 2632, 2614, 2583, 2587, 2623, 2635, 2605,
+        2613, 2625, 2615, 2573, 2566, 2622, 2570, 2607, 2637, 2582, 2217, 2621, 2631, 2567, 2585, 2611,
+        2562, 3073, 2610, 2559, 2594, 2624, 2607, 2602, 2627, 2595, 2633, 2595, 2584, 2591, 2916, 2565,
+        2569, 2605, 2567, 2609, 2599, 2588, 2624, 2624, 2623, 2605, 2610, 2610, 2658, 2608, 2588, 2537,
+        2653, 2586, 2633, 2613, 2594, 2578, 2584, 2575, 2580, 2550, 2628, 2609, 2569, 2621, 2095, 2613,
+        2332, 2620, 2588, 2619, 2643, 2646, 2599, 2157, 2647, 2648, 2628, 2633, 2629, 2607, 2233, 2603,
+        2613, 2560, 2604, 2588, 2581, 2601, 2616, 2595, 2592, 2582, 2572, 2616, 2583, 2573, 2579, 2579,
+        2643, 2622, 2957, 2616, 2608, 2613, 2627, 2606, 2633, 2573, 2554, 2872, 2631, 2550, 2601, 2613,
+        2565, 2605, 2603, 2583, 2600, 2578, 2631, 2618, 2635, 2611, 2597, 2613, 2620, 2618, 2602, 2632,
+        2595, 2630, 2579, 2947, 2607, 2588, 2630, 2627, 2607, 2594, 2643, 2572, 2604, 2609, 2549, 2559,
+        2604, 2635, 2537, 2619, 2574, 2602, 2608, 2590, 2604, 2575, 2591, 2642, 2648, 2610, 2620, 2640,
+        2610, 2578, 2608, 2648, 2597, 2606, 2617, 2585, 2595, 3151, 2596, 2604, 2640, 2642, 2618, 2596,
+        2609, 2632, 2635, 2630, 2617, 2599, 2624, 2598, 2640, 2608, 2630, 2583, 2581, 2584, 2672, 2580,
+        2600, 2608, 2619, 2621, 2574, 2642, 2568, 2560, 2606, 2624, 2640, 2608, 2635, 2618, 2614, 2606,
+        2581, 2623, 2591, 2634, 2592, 2615, 2585, 2628, 2660, 2577, 2589, 2592, 2642, 2616, 2634, 2588,
+        2598, 2595, 2600, 2617, 2594, 2597, 2565, 2866, 2609, 2565, 3150, 2628, 2654, 2587, 2578, 2617,
+        2547, 2593, 2567, 2604, 2594, 2595, 2616, 2613, 2613, 2613, 2620, 2594, 2594, 2635, 2628, 2600,
+        2654, 2625, 2563, 2618, 2576, 2586, 2605, 2563, 2575, 2570, 2604, 2635, 2623, 2552, 2569, 2627,
+        2590, 2632, 2591, 2581, 2620, 2604, 2585, 2627, 2638, 2603, 2634, 2616, 2570, 2609, 2567, 2645,
+        2593, 2596, 2613, 2626, 2606, 2629, 2597, 2588, 2595, 2626, 2631, 2597, 2622, 2628, 2621, 2609,
+        2616, 2637, 2611, 2607, 2592, 2546, 2583, 2626, 2625, 2652, 2611, 2625, 2552, 2578, 2601, 2653,
+        2642, 2633, 2601, 2659, 2587, 2604, 3187, 2628, 2613, 2612, 2624, 2630, 2571, 2522, 2601, 2634,
+        2640, 2585, 2609, 2597, 2608, 2597, 2632, 2622, 2604, 2644, 2650, 2615, 2597, 2605, 2627, 2637,
+        2592, 2618, 2565, 2621, 2639, 2574, 2654, 2607, 2593, 2568, 2626, 2642, 2629, 2622, 2583, 2580,
+        2611, 2562, 2615, 2600, 2603, 2579, 2595, 2581, 2610, 2573, 2630, 2606, 2630, 2607, 2588, 2613,
+        2628, 3214, 2610, 2630, 2570, 2599, 2565, 2583, 2580, 2629, 2601, 2572, 2610, 2543, 2663, 2872,
+        2592, 2604, 2641, 3122, 2589, 2580, 2598, 2578, 2606, 2637, 2623, 2602, 2560, 2618, 2605, 2669,
+        2591, 2640, 2603, 2625, 2617, 2574, 2610, 2619, 2611, 2652, 2612, 2595, 2656, 2646, 2578, 2563,
+        2592, 2607, 2629, 2605, 2597, 2654, 2588, 2579, 2583, 2618, 2606, 2560, 2651, 2564, 2604, 2614,
+        2601, 2595, 2613, 2607, 2614, 2605, 2794, 2602, 2604, 2633, 2623, 2604, 2625, 2615, 2587, 2606,
+        2612, 2668, 2579, 2565, 2620, 2609, 2642, 2611, 2582, 2559, 2566, 2621, 2612, 2619, 2572, 2640,
+        2576, 2605, 2585, 2605, 2601, 2583, 2617, 2187, 2551, 2598, 2585, 2556, 2582, 2556, 2633, 2625,
+        2564, 2540, 2568, 2524, 2519, 2563, 2526, 2513, 2528, 2568, 2588, 2527, 3014, 2511, 2534, 2480,
+        2497, 2480, 2460, 2493, 2518, 2493, 2472, 2492, 2451, 2468, 2518, 2514, 2470, 2462, 2460, 2490,
+        2439, 2445, 2442, 2423, 2390, 2418, 2431, 2436, 2418, 2433, 2398, 2427, 2479, 2428, 2443, 2472,
+        2362, 2362, 2412, 2372, 2340, 2384, 2372, 2346, 2386, 2357, 2377, 2354, 2325, 2360, 2317, 2352,
+        2282, 2262, 2326, 2251, 2316, 2282, 2274, 2335, 2341, 2319, 2284, 2305, 2316, 2319, 2306, 2311,
+        2228, 2201, 2219, 2262, 2256, 2229, 2215, 2237, 2259, 2262, 2269, 2169, 2218, 2239, 2231, 2235,
+        2178, 2181, 2104, 2168, 2131, 2148, 2197, 2209, 2177, 2149, 2192, 2160, 2134, 2195, 2196, 2150,
+        2106, 2114, 2106, 2085, 2098, 2078, 2073, 2134, 1552, 2112, 2107, 2100, 2092, 2161, 2107, 2126,
+        2125, 2148, 2080, 2141, 2097, 2107, 2125, 2105, 2104, 2069, 2102, 2107, 2076, 2129, 2106, 2075,
+        2103, 2105, 2079, 2084, 2092, 2144, 2120, 2088, 2136, 2060, 2142, 2103, 2108, 2119, 2128, 2116,
+        2118, 2111, 2149, 2109, 2078, 2178, 2085, 2144, 2132, 2110, 2125, 2138, 2105, 2112, 2101, 2106,
+        2144, 2130, 2091, 2103, 2111, 2120, 2112, 2061, 2145, 2162, 2090, 2089, 2601, 2093, 2093, 2054,
+        2094, 2095, 2127, 2113, 2123, 2084, 2139, 2109, 2399, 2122, 2097, 2092, 2077, 2105, 2482, 2092,
+        2166, 2099, 2098, 2118, 2139, 2114, 1658, 2101, 2116, 2116, 2079, 2089, 2096, 2104, 2127, 2094,
+        2117, 2094, 2110, 2093, 2085, 2133, 2089, 2087, 1661, 2109, 2073, 2082, 2123, 2089, 2130, 2112,
+        2149, 2060, 2112, 2125, 2120, 2159, 2128, 2160, 2124, 2117, 2138, 2074, 2101, 2061, 2078, 2088,
+        2092, 2122, 2119, 2105, 2070, 2117, 2086, 2131, 2147, 2098, 2104, 2120, 2094, 2113, 2065, 2114,
+        2074, 2156, 2149, 2115, 2123, 2099, 2106, 2089, 2137, 2043, 2119, 2437, 2085, 2086, 2092, 2143,
+        2132, 2100, 2127, 2159, 2117, 2094, 2103, 2091, 2121, 2106, 2159, 2103, 2113, 2153, 2126, 2086,
+        2174, 2123, 2112, 2074, 2070, 2124, 2093, 2119, 2147, 2111, 2101, 2095, 2103, 2063, 2115, 2109,
+        2186, 2586, 2173, 2159, 2203, 2171, 2174, 2137, 2168, 2194, 2140, 2185, 2126, 2184, 2139, 2169,
+        2177, 2126, 2190, 2176, 1755, 2169, 2194, 2192, 2201, 2197, 2195, 2168, 2190, 2147, 2164, 2173,
+        2155, 2202, 2173, 2179, 2214, 2195, 2197, 2193, 2151, 2205, 2178, 2237, 2133, 2183, 2171, 2152,
+        2155, 2188, 2210, 2193, 2184, 2211, 2156, 2148, 2192, 2174, 2207, 2152, 2168, 2218, 2177, 2166,
+        2207, 2156, 2186, 2151, 2196, 2214, 2188, 2189, 2189, 2164, 2157, 2182, 2168, 2181, 2176, 2180,
+        2180, 2179, 2175, 2216, 1781, 2163, 2218, 2207, 2225, 2187, 2186, 2184, 2169, 2195, 2158, 2185,
+        2164, 2155, 2148, 2189, 2229, 2199, 2182, 2150, 2186, 2165, 2163, 2158, 2196, 2148, 2156, 2189,
+        2164, 2191, 2181, 2180, 2172, 2152, 2174, 2152, 2195, 2166, 2183, 2207, 2163, 2147, 2194, 2203,
+        2205, 2181, 2179, 2193, 2205, 2192, 2174, 2164, 2178, 2174, 2221, 1780, 2193, 2178, 2220, 2163,
+        2146, 2177, 2141, 2160, 2210, 2170, 2215, 2179, 2154, 2193, 2660, 2163, 2198, 2217, 2226, 2181,
+        2768, 2213, 2166, 2187, 2184, 2171, 2181, 2182, 2139, 2162, 2179, 2195, 2176, 2220, 2187, 2165,
+        2209, 2164, 2167, 2192, 1833, 2199, 2210, 2173, 2166, 2178, 2121, 2189, 2146, 2183, 2137, 2183,
+        2147, 2185, 2186, 2173, 2215, 2214, 2162, 2506, 2210, 2211, 2162, 2207, 2159, 2192, 2225, 2163,
+        2179, 2143, 2208, 2179, 2216, 2156, 2191, 2177, 2209, 2206, 2197, 2197, 2197, 2183, 2173, 2179,
+        2204, 2144, 2181, 2194, 2160, 2184, 2167, 2211, 2151, 2207, 2179, 2158, 2204, 2162, 2206, 2165,
+        2157, 2199, 2179, 2192, 2188, 2171, 2206, 2162, 2170, 2186, 2226, 2169, 2153, 2182, 2154, 2177,
+        2159, 2175, 2185, 2138, 2183, 2205, 2177, 2218, 2189, 2232, 2154, 2165, 2228, 2207, 2151, 2194,
+        2173, 2152, 2192, 2188, 2155, 2206, 2170, 2175, 2145, 2174, 2185, 2157, 2167, 2189, 2174, 2180,
+        2214, 2185, 2231, 2214, 2187, 2205, 2239, 2197, 2195, 2176, 2192, 2190, 2182, 2188, 2565, 2216,
+        2189, 2181, 2174, 2164, 2166, 2160, 2160, 2212, 2196, 2179, 2196, 2154, 2212, 2166, 2196, 2163,
+        2199, 2173, 2175, 2136, 2214, 2201, 2449, 2183, 2193, 2167, 2194, 2201, 2180, 2181, 2190, 2186,
+        2230, 2221, 2608, 2171, 1848, 2194, 2235, 2223, 2203, 2139, 2203, 2194, 2117, 2166, 2205, 2148,
+        2153, 2147, 2195, 2211, 2553, 2201, 2187, 2181, 2239, 2188, 2210, 2194, 2155, 2179, 2215, 2214,
+        2212, 2183, 2185, 2126, 2185, 2130, 2217, 2193, 2151, 2163, 2222, 2192, 2152, 2198, 2137, 2143,
+        2212, 2174, 2187, 2166, 2204, 2178, 2204, 2214, 2188, 2209, 2190, 2200, 2256, 2194, 2175, 2159,
+        2191, 2171, 2227, 2176, 1645, 2165, 2174, 2197, 2195, 2182, 2214, 2171, 2192, 2182, 2189, 2187,
+        2174, 2204, 2516, 2203, 2180, 2182, 2198, 2156, 2157, 2141, 2182, 2197, 2186, 2224, 2147, 2228,
+        2194, 2127, 1662, 2151, 2167, 2176, 2188, 2235, 2166, 1784, 1666, 2172, 2208, 2161, 2111, 2215,
+        2188, 2193, 2188, 2209, 2155, 1594, 2177, 1759, 2191, 2153, 2158, 2206, 2187, 2161, 2200, 2187,
+        2235, 2151, 2148, 2181, 2234, 2206, 2195, 2194, 2165, 2140, 2191, 2188, 2174, 2185, 2169, 2170,
+        2628, 2601, 2599, 2585, 2627, 2614, 2591, 2660, 2629, 2645, 2593, 2605, 2620, 2655, 2570, 2594,
+        2590, 2606, 2600, 2599, 2604, 2561, 2604, 2624, 2572, 2614, 2596, 2611, 2616, 2596, 2587, 2612,
+        2572, 2618, 2607, 2588, 2595, 2600, 2652, 2590, 2593, 2576, 2583, 2607, 2632, 2627, 2596, 2603,
+        2601, 2572, 2633, 2587, 2559, 2585, 2610, 2569, 2601, 2606, 2582, 2610, 2641, 2607, 2603, 2639,
+        2929, 2622, 2555, 2584, 2590, 2604, 2579, 2636, 2629, 2594, 2640, 2626, 2585, 2623, 2613, 2602,
+        2634, 2611, 2610, 2624, 2546, 2609, 2617, 2595, 2608, 2602, 2597, 2584, 2581, 2585, 2664, 2618,
+        2624, 2572, 2612, 2629, 2587, 2601, 2602, 2655, 2602, 2596, 2604, 2604, 2633, 2570, 2590, 2627,
+        2660, 2636, 2608, 2619, 2586, 2053, 2595, 2651, 2637, 2606, 2620, 2606, 2615, 2617, 2624, 2616,
+        2647, 2590, 3171, 2599, 2584, 2590, 2654, 2612, 2628, 2643, 2599, 2615, 2576, 2210, 2604, 2610,
+        2628, 2622, 2618, 2633, 2609, 2576, 2561, 2605, 2640, 2540, 2552, 2616, 2563, 2592, 2641, 2589,
+        2637, 2644, 2629, 2606, 2603, 2597, 2559, 2598, 2566, 2637, 2641, 2615, 2562, 2609, 2599, 2617,
+        2605, 2592, 2624, 2641, 2586, 2650, 2652, 2627, 2666, 2565, 2596, 2576, 2628, 2599, 2601, 2597,
+        2635, 2630, 2590, 2600, 2601, 2593, 2648, 2548, 2594, 2578, 2566, 2617, 2607, 2599, 2591, 2595,
+        2573, 2562, 2614, 2521, 2595, 2604, 2647, 2605, 2590, 2618, 2644, 2632, 2608, 2633, 2575, 2614,
+        2578, 2628, 2590, 2606, 2605, 2600, 2576, 2601, 2605, 2650, 2587, 2912, 2560, 2593, 2608, 2596,
+        2602, 2567, 2540, 2619, 2627, 2625, 2572, 2594, 2589, 2582, 2593, 2573, 2581, 2609, 2641, 2618,
+        2578, 2594, 2625, 2623, 2624, 2631, 2610, 2578, 2638, 2620, 2555, 2137, 2548, 2560, 2608, 2629,
+        2623, 2590, 2636, 2598, 2624, 2619, 2644, 2606, 2601, 2893, 2592, 2584, 2593, 2645, 2560, 2609,
+        2564, 2631, 2655, 2565, 2617, 2555, 2594, 2597, 2603, 2585, 2645, 2990, 2626, 2654, 2589, 2634,
+        2574, 2629, 2571, 2630, 2566, 2628, 2610, 2625, 2565, 2610, 2573, 2639, 2634, 2604, 2617, 2594,
+        2622, 2639, 2597, 2606, 2650, 2656, 2614, 2633, 2605, 2573, 2611, 2651, 2601, 2618, 2595, 2582,
+        2605, 2950, 2612, 2585, 2591, 2637, 2580, 2567, 2621, 2563, 2603, 2570, 2610, 2619, 2605, 2625,
+        2596, 2617, 2640, 2643, 2648, 2574, 2631, 2576, 2595, 2619, 2579, 2591, 2588, 2570, 2617, 2570,
+        2602, 2620, 2626, 2648, 2611, 2613, 2572, 2587, 2623, 2626, 2278, 2630, 2096, 2655, 2605, 2597,
+        2595, 2613, 2567, 2544, 2609, 3059, 2605, 2597, 2625, 2625, 2592, 2615, 2600, 2645, 2635, 2596,
+        2590, 2627, 2586, 2618, 2588, 2592, 2615, 2592, 2603, 2566, 2631, 2669, 2620, 2570, 2561, 2596,
+        2564, 2561, 3122, 2616, 2615, 2586, 2589, 2624, 2579, 2585, 2609, 2596, 2585, 2636, 2595, 2612,
+        2629, 2619, 2607, 2592, 2587, 2614, 2612, 2637, 2572, 3017, 2660, 2585, 2563, 2639, 2605, 2608,
+        2627, 2633, 2588, 2574, 2596, 2579, 2612, 2209, 2155, 2662, 2601, 2611, 2606, 2600, 2570, 2653,
+        2644, 2646, 2612, 2644, 2597, 2569, 2623, 2605, 2665, 2595, 2564, 2591, 2605, 3040, 2601, 2640,
+        2165, 2626, 2610, 2600, 2571, 2589, 2611, 2600, 2542, 2598, 2975, 2644, 2572, 2544, 2575, 2634,
+        2598, 2672, 2611, 2602, 2582, 2613, 2613, 2612, 2575, 2628, 2616, 2626, 2561, 2633, 2612, 2563,
+        2599, 2620, 2565, 2599, 3033, 2648, 2674, 2602, 2637, 2570, 2613, 2583, 2570, 2565, 2616, 2601,
+        2614, 2607, 2600, 2636, 2613, 2565, 2581, 2575, 2582, 2619, 2644, 2648, 2604, 2573, 2610, 2624,
+        2611, 2587, 2646, 2633, 2597, 3148, 2624, 2550, 2631, 2603, 2622, 2596, 2581, 2597, 2655, 2633,
+        2624, 2612, 2579, 2588, 2599, 2564, 2630, 2614, 2640, 2611, 2596, 2642, 2599, 2610, 2580, 2571,
+        2602, 2607, 2614, 2596, 2607, 2639, 2571, 2605, 2613, 2283, 2577, 2599, 2610, 2583, 2605, 2563,
+        2634, 2595, 2636, 2622, 2593, 2644, 2624, 2598, 2632, 2626, 2621, 2597, 2629, 2002, 2629, 2573,
+        2582, 2612, 2612, 2627, 3003, 2638, 2633, 2599, 2623, 2579, 2598, 2587, 2883, 2560, 2611, 2596,
+        2601, 2607, 3100, 2603, 2601, 2629, 2617, 2601, 2627, 2621, 2575, 2612, 2587, 2613, 2577, 2620,
+        2652, 2586, 2615, 2605, 2127, 2640, 2659, 2545, 2584, 2558, 2591, 2575, 2599, 2570, 2590, 2650,
+        2566, 2624, 2568, 2588, 2618, 2609, 2588, 2589, 2611, 2575, 2572, 2633, 2626, 2627, 2613, 2625,
+        2634, 2606, 2632, 2602, 2643, 2599, 2634, 2584, 2613, 2648, 2606, 2591, 2566, 2626, 2582, 2577,
+        2653, 2594, 2611, 2604, 2611, 2623, 2576, 2582, 2620, 2624, 2591, 2631, 2574, 2983, 2607, 2619,
+        2612, 2621, 2606, 2638, 2594, 2583, 2650, 2601, 2631, 2574, 2596, 2587, 2653, 2628, 2595, 3136,
+        2601, 2617, 2608, 2551, 2611, 2576, 2606, 2617, 2598, 2559, 2662, 2604, 2538, 2655, 2621, 2585,
+        2643, 2620, 2638, 2586, 2584, 2644, 2590, 2619, 2572, 2587, 2620, 2632, 2647, 2131, 2600, 2582,
+        2632, 2598, 2577, 2606, 2579, 2624, 2665, 2582, 2605, 2631, 2607, 2619, 2648, 2566, 2624, 2590,
+        2587, 2581, 2630, 2641, 2602, 2595, 2590, 2643, 2559, 2546, 2575, 2633, 2581, 2617, 2600, 2641,
+        2643, 2610, 2647, 2607, 2613, 2598, 2578, 2611, 2550, 2629, 2626, 2594, 2643, 2999, 2558, 2635,
+};
+
+#endif //SMART_GARDEN_ADC_TRACE_H
@@ -0,0 +1,226 @@
+//
+// VoltageReader tests on an ADC trace: `pio test -e native -f test_voltage`
+//
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "RollingStats.h"
+#include "VoltageReader.h"
+#include "adc_trace.h"
+
+static const uint8_t VOLTAGE_PIN = 32;
+static const size_t TRACE_LENGTH = sizeof(ADC_TRACE) / sizeof(ADC_TRACE[0]);
+static const size_t TRACE_BURSTS = TRACE_LENGTH / ADC_TRACE_BURST;
+
+static size_t traceIndex = 0;
+
+struct voltage_events_t {
+    uint32_t changed = 0;
+    uint32_t low = 0;
+    uint32_t high = 0;
+    uint32_t unsafe = 0;
+};
+
+static void attachEvents(VoltageReader &reader, voltage_events_t &events) {
+    reader.onChanged([&]() { events.changed++; });
+    reader.onLow([&]() { events.low++; });
+    reader.onHigh([&]() { events.high++; });
+    reader.onUnsafe([&]() { events.unsafe++; });
+}
+
+/**
+ * @brief Run loop() every 500 ms (the firmware period) over bursts [from, to) of the trace
+ */
+static void replay(VoltageReader &reader, size_t from, size_t to) {
+    traceIndex = from * ADC_TRACE_BURST;
+    for (size_t i = from; i < to; i++) {
+        reader.loop();
+        native::advanceMillis(500);
+    }
+}
+
+void setUp() {
+    native::reset();
+    native::setMillis(1000);
+    traceIndex = 0;
+    native::setAnalogSource([](uint8_t pin) -> uint16_t {
+        return ADC_TRACE[traceIndex++ % TRACE_LENGTH];
+    });
+}
+
+void tearDown() {}
+
+void test_filter_rejects_noise_and_spikes() {
+    VoltageReader reader(VOLTAGE_PIN, 10.0, 2, 0.3, 10.5, 13.5);
+    voltage_events_t events;
+    attachEvents(reader, events);
+
+    replay(reader, 0, 50);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 12.6f, reader.get());
+    // Only the first reading away from 0
+    TEST_ASSERT_EQUAL_UINT32(1, events.changed);
+    TEST_ASSERT_EQUAL_UINT32(0, events.low + events.high + events.unsafe);
+}
+
+void test_single_sample_reader_would_trigger_on_noise() {
+    // Reference: one raw sample per loop against the same threshold, as the reader used to do
+    uint32_t triggers = 0;
+    float last = 0;
+    for (size_t i = 0; i < 50; i++) {
+        float v = ADC_TRACE[i * ADC_TRACE_BURST] / 4095.0f * 3.3f * 6;
+        if (fabsf(v - last) > 0.3f) {
+            last = v;
+            triggers++;
+        }
+    }
+    TEST_ASSERT_TRUE(triggers > 5);
+}
+
+void test_low_alarm_uses_hysteresis() {
+    VoltageReader reader(VOLTAGE_PIN, 10.0, 2, 0.3, 10.5, 13.5);
+    voltage_events_t events;
+    attachEvents(reader, events);
+
+    replay(reader, 0, 70);
+    TEST_ASSERT_EQUAL(VOLTAGE_LOW, reader.getAlarm());
+    TEST_ASSERT_EQUAL_UINT32(1, events.low);
+    TEST_ASSERT_EQUAL_UINT32(1, events.unsafe);
+
+    // Hovering just above minVolt does not clear and re-raise the alarm
+    replay(reader, 70, 100);
+    TEST_ASSERT_EQUAL(VOLTAGE_LOW, reader.getAlarm());
+    TEST_ASSERT_EQUAL_UINT32(1, events.low);
+
+    replay(reader, 100, TRACE_BURSTS);
+    TEST_ASSERT_EQUAL(VOLTAGE_NORMAL, reader.getAlarm());
+    TEST_ASSERT_EQUAL_UINT32(1, events.low);
+    TEST_ASSERT_EQUAL_UINT32(0, events.high);
+}
+
+void test_changed_callback_is_rate_limited() {
+    VoltageReader reader(VOLTAGE_PIN, 10.0, 2, 0.05, 10.5, 13.5);
+    reader.minCallbackInterval = 5000;
+    voltage_events_t events;
+    attachEvents(reader, events);
+
+    uint32_t start = millis();
+    replay(reader, 0, TRACE_BURSTS);
+    uint32_t elapsed = millis() - start;
+    TEST_ASSERT_TRUE(events.changed >= 2);
+    TEST_ASSERT_TRUE(events.changed <= elapsed / reader.minCallbackInterval + 1);
+}
+
+void test_calibration_table() {
+    // Divider reads 3 % low at the top and 0.2 V low at the bottom
+    const voltage_cal_point_t points[] = {{10.0f, 10.2f}, {13.0f, 13.4f}};
+    VoltageReader reader(VOLTAGE_PIN, 10.0, 2);
+    TEST_ASSERT_TRUE(reader.setCalibration(points, 2));
+
+    native::setAnalogSource(nullptr);
+    native::setAnalogValue(VOLTAGE_PIN, (uint16_t) (11.5f / 6 / 3.3f * 4095 + 0.5f));
+    reader.loop();
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 11.8f, reader.get());
+
+    const voltage_cal_point_t unsorted[] = {{13.0f, 13.4f}, {10.0f, 10.2f}};
+    TEST_ASSERT_FALSE(reader.setCalibration(unsorted, 2));
+}
+
+void test_rolling_window_matches_full_scan() {
+    RollingWindow<24> window;
+    std::vector<stats_bucket_t> pushed;
+    srand(42);
+    for (int i = 0; i < 500; i++) {
+        stats_bucket_t bucket{};
+        // Every 7th slot has no reading
+        if (i % 7) {
+            for (int n = 0; n < 1 + rand() % 4; n++) {
+                bucket.add((float) (rand() % 1000) / 10.0f);
+            }
+        }
+        window.push(bucket);
+        pushed.push_back(bucket);
+
+        stats_bucket_t expected{};
+        size_t from = pushed.size() > 24 ? pushed.size() - 24 : 0;
+        for (size_t j = from; j < pushed.size(); j++) {
+            expected.merge(pushed[j]);
+        }
+        stats_bucket_t actual = window.get();
+        TEST_ASSERT_EQUAL_UINT32(expected.count, actual.count);
+        TEST_ASSERT_EQUAL_FLOAT(expected.min, actual.min);
+        TEST_ASSERT_EQUAL_FLOAT(expected.max, actual.max);
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, expected.avg(), actual.avg());
+    }
+}
+
+static uint16_t adcFor(float volt) {
+    return (uint16_t) (volt / 6 / 3.3f * 4095 + 0.5f);
+}
+
+void test_history_windows_catch_sag_under_load() {
+    native::setAnalogSource(nullptr);
+    VoltageReader reader(VOLTAGE_PIN, 10.0, 2, 0.3, 10.5, 13.5);
+    uint32_t seconds = 0;
+    reader.onSecond([&](const stats_bucket_t &bucket) {
+        seconds++;
+        TEST_ASSERT_EQUAL_UINT32(2, bucket.count);
+    });
+
+    // Two hours at 12.6 V with a 20 s pump sag to 11.0 V after 30 minutes
+    for (uint32_t i = 0; i < 2 * 3600 * 2; i++) {
+        bool sag = i >= 30 * 60 * 2 && i < (30 * 60 + 20) * 2;
+        native::setAnalogValue(VOLTAGE_PIN, adcFor(sag ? 11.0f : 12.6f));
+        reader.loop();
+        native::advanceMillis(500);
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, 2 * 3600, seconds);
+
+    stats_bucket_t minute = reader.getStats(VOLTAGE_WINDOW_1M);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 12.6f, minute.min);
+    TEST_ASSERT_UINT32_WITHIN(2, 120, minute.count);
+
+    // The sag is older than one hour
+    stats_bucket_t hour = reader.getStats(VOLTAGE_WINDOW_1H);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 12.6f, hour.min);
+
+    stats_bucket_t day = reader.getStats(VOLTAGE_WINDOW_24H);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 11.0f, day.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 12.6f, day.max);
+    TEST_ASSERT_EQUAL_UINT32(2 * 3600 * 2, day.count);
+    TEST_ASSERT_TRUE(day.avg() < 12.6f && day.avg() > 12.59f);
+}
+
+void test_sample_ring_keeps_latest_readings() {
+    native::setAnalogSource(nullptr);
+    VoltageReader reader(VOLTAGE_PIN, 10.0, 2);
+    for (uint32_t i = 0; i < VOLTAGE_READER_SAMPLE_RING + 10; i++) {
+        native::setAnalogValue(VOLTAGE_PIN, adcFor(10.0f + (float) i / 100));
+        reader.loop();
+        native::advanceMillis(500);
+    }
+    TEST_ASSERT_EQUAL_UINT16(VOLTAGE_READER_SAMPLE_RING, reader.getSampleCount());
+    voltage_sample_t oldest = reader.getSample(0);
+    voltage_sample_t newest = reader.getSample(VOLTAGE_READER_SAMPLE_RING - 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 10.1f, oldest.volt);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 10.0f + (VOLTAGE_READER_SAMPLE_RING + 9) / 100.0f, newest.volt);
+    TEST_ASSERT_EQUAL_UINT32((VOLTAGE_READER_SAMPLE_RING - 1) * 500, newest.time - oldest.time);
+
+    voltage_sample_t copy[VOLTAGE_READER_SAMPLE_RING];
+    TEST_ASSERT_EQUAL_UINT16(VOLTAGE_READER_SAMPLE_RING, reader.copySamples(copy));
+    TEST_ASSERT_EQUAL_UINT32(oldest.time, copy[0].time);
+    TEST_ASSERT_EQUAL_UINT32(newest.time, copy[VOLTAGE_READER_SAMPLE_RING - 1].time);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_filter_rejects_noise_and_spikes);
+    RUN_TEST(test_single_sample_reader_would_trigger_on_noise);
+    RUN_TEST(test_low_alarm_uses_hysteresis);
+    RUN_TEST(test_changed_callback_is_rate_limited);
+    RUN_TEST(test_calibration_table);
+    RUN_TEST(test_rolling_window_matches_full_scan);
+    RUN_TEST(test_history_windows_catch_sag_under_load);
+    RUN_TEST(test_sample_ring_keeps_latest_readings);
+    return UNITY_END();
+}
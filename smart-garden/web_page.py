@@ -0,0 +1,67 @@
+#
+# Minify and gzip src/main.html into src/MAIN_PAGE.h (PROGMEM byte array + ETag)
+#
+import gzip
+import hashlib
+import re
+
+FILENAME_HTML = 'src/main.html'
+FILENAME_PAGE_H = 'src/MAIN_PAGE.h'
+
+
+def minify(html):
+    html = re.sub(r'<!--.*?-->', '', html, flags=re.S)
+    out = ''
+    in_script = False
+    for line in html.split('\n'):
+        line = line.strip()
+        # Full-line script comments only: "//" inside a line may be a URL
+        if not line or (in_script and line.startswith('//')):
+            continue
+        if out:
+            if in_script:
+                # The script relies on newlines instead of semicolons
+                out += '\n'
+            elif not (out[-1] in '>{;}' or line[0] in '<}'):
+                out += ' '
+        out += line
+        in_script = out.rfind('<script') > out.rfind('</script>')
+    return out
+
+
+page = minify(open(FILENAME_HTML, encoding='utf-8').read()).encode('utf-8')
+# mtime=0 keeps the output identical between builds
+data = gzip.compress(page, compresslevel=9, mtime=0)
+etag = hashlib.sha1(page).hexdigest()[:16]
+
+rows = []
+for i in range(0, len(data), 16):
+    rows.append('        ' + ', '.join('0x{:02x}'.format(b) for b in data[i:i + 16]) + ',')
+
+hf = """// Generated from {} by web_page.py, do not edit
+#ifndef SMART_GARDEN_MAIN_PAGE_H
+#define SMART_GARDEN_MAIN_PAGE_H
+
+#include <Arduino.h>
+
+#define MAIN_PAGE_ETAG "\\"{}\\""
+#define MAIN_PAGE_SIZE {} // before gzip
+
+const size_t MAIN_PAGE_GZ_LENGTH = {};
+const uint8_t MAIN_PAGE_GZ[] PROGMEM = {{
+{}
+}};
+
+#endif //SMART_GARDEN_MAIN_PAGE_H
+""".format(FILENAME_HTML, etag, len(page), len(data), '\n'.join(rows))
+
+try:
+    with open(FILENAME_PAGE_H, encoding='utf-8') as f:
+        current = f.read()
+except OSError:
+    current = ''
+# Rewrite only on change, so the firmware is not rebuilt every time
+if current != hf:
+    with open(FILENAME_PAGE_H, 'w', encoding='utf-8') as f:
+        f.write(hf)
+print('Main page: {} bytes, {} gzipped, ETag {}'.format(len(page), len(data), etag))